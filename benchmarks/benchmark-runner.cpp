@@ -0,0 +1,98 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "benchmark-runner.h"
+
+namespace {
+    std::atomic<std::uint64_t> allocations{0};
+
+#if defined(__GLIBC__)
+    // Qt containers allocate with malloc, which is counted below, so operator new is counted by malloc as well.
+    constexpr bool kIsMallocCounted{true};
+#else
+    constexpr bool kIsMallocCounted{false};
+#endif
+
+    inline void countAllocation() noexcept {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* allocate(std::size_t size) {
+        if constexpr (!kIsMallocCounted) countAllocation();
+        if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+        throw std::bad_alloc{};
+    }
+}  // namespace
+
+#if defined(__GLIBC__)
+// glibc lets the binary replace malloc for itself and for the libraries it loads, Qt included.
+extern "C" {
+    void* __libc_malloc(std::size_t size) noexcept;
+    void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+    void* __libc_realloc(void* memory, std::size_t size) noexcept;
+    void __libc_free(void* memory) noexcept;
+
+    void* malloc(std::size_t size) noexcept {
+        countAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(std::size_t count, std::size_t size) noexcept {
+        countAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* memory, std::size_t size) noexcept {
+        if (size != 0) countAllocation();
+        return __libc_realloc(memory, size);
+    }
+
+    void free(void* memory) noexcept {
+        __libc_free(memory);
+    }
+}
+#endif
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace benchmark {
+
+    std::uint64_t allocationsCount() noexcept {
+        return allocations.load(std::memory_order_relaxed);
+    }
+
+    bool report(std::string_view name, const Result& result, bool isAllocationFree, double maxNsPerOperation) {
+        bool hasAllocated = isAllocationFree && result.allocationsPerOperation > 0.0;
+        bool isOverBudget = maxNsPerOperation > 0.0 && result.nsPerOperation > maxNsPerOperation;
+        std::printf("%-48.*s %12.1f ns/op %10.3f allocs/op%s%s\n", static_cast<int>(name.size()), name.data(),
+                    result.nsPerOperation, result.allocationsPerOperation,
+                    hasAllocated ? "  (expected no allocations)" : "", isOverBudget ? "  (over the time budget)" : "");
+        return !hasAllocated && !isOverBudget;
+    }
+
+}  // namespace benchmark
@@ -0,0 +1,65 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace benchmark {
+
+    struct Result {
+        double nsPerOperation{0.0};
+        double allocationsPerOperation{0.0};
+    };
+
+    // Heap allocations made by the benchmark binary so far. With glibc malloc, calloc and realloc are replaced,
+    // so every allocation is counted, the ones of Qt containers and of the scene included. Elsewhere only
+    // the replaced global operator new counts, which covers items, scenes and standard containers but misses
+    // Qt containers, as they allocate with malloc.
+    [[nodiscard]] std::uint64_t allocationsCount() noexcept;
+
+    // Prints the result, returns false when the operation was expected not to allocate but did,
+    // or took longer than `maxNsPerOperation` if it is positive.
+    bool report(std::string_view name, const Result& result, bool isAllocationFree, double maxNsPerOperation = 0.0);
+
+    // Keeps the compiler from dropping a computation whose result is otherwise unused.
+    template<typename T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Runs `operation(i)` with a growing number of iterations until a run takes long enough to be measured,
+    // the operation gets the index of the iteration to vary its input.
+    template<typename Operation>
+    Result run(Operation operation) {
+        using Clock = std::chrono::steady_clock;
+        constexpr auto kMinRunTime = std::chrono::milliseconds{200};
+
+        constexpr auto kMaxWarmUpTime = std::chrono::milliseconds{20};
+        constexpr std::uint64_t kMaxWarmUpIterations{64};
+
+        // The first calls fill caches and pools, steady state is what is measured.
+        auto warmUpStart = Clock::now();
+        for (std::uint64_t i = 0; i < kMaxWarmUpIterations && Clock::now() - warmUpStart < kMaxWarmUpTime; ++i) {
+            operation(i);
+        }
+
+        for (std::uint64_t iterationsCount = 1;; iterationsCount *= 2) {
+            std::uint64_t allocationsBefore = allocationsCount();
+            auto start = Clock::now();
+            for (std::uint64_t i = 0; i < iterationsCount; ++i) {
+                operation(i);
+            }
+            auto elapsed = Clock::now() - start;
+            std::uint64_t allocations = allocationsCount() - allocationsBefore;
+
+            if (elapsed >= kMinRunTime) {
+                auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+                return Result{static_cast<double>(elapsedNs) / static_cast<double>(iterationsCount),
+                              static_cast<double>(allocations) / static_cast<double>(iterationsCount)};
+            }
+        }
+    }
+
+}  // namespace benchmark
@@ -0,0 +1,198 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QApplication>
+#include <QGraphicsItem>
+#include <QGraphicsLineItem>
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QPolygonF>
+#include <QtMath>
+#include <cstdlib>
+#include <vector>
+#include "benchmark-runner.h"
+#include "../include/rectangles-detail.h"
+#include "../include/item-transformations-detail.h"
+#include "../include/item-copy-detail.h"
+#include "../include/flood-fill-detail.h"
+#include "../include/preview-geometry-arena.h"
+#include "../include/preview-item-pool.h"
+
+namespace {
+    using detail::CoordsType;
+
+    constexpr int kPolygonPointsCount{64};
+    constexpr std::uint64_t kCursorPositionsCount{1024};
+
+    // Mouse moves of a brush stroke, each of them shows a pooled preview line.
+    constexpr std::uint64_t kGestureMovesCount{256};
+
+    constexpr int kFillCanvasSize{4096};
+    constexpr int kFillObstaclesPerSide{16};
+    constexpr int kFillTolerance{8};
+    // The fill of a 4k x 4k canvas region must stay well under this.
+    constexpr double kMaxFillNs{100.0 * 1000.0 * 1000.0};
+
+    // Cursor positions of a drag around the start point, so the kernels see every direction.
+    QPointF cursorPosition(std::uint64_t i) {
+        qreal angle = 2.0 * M_PI * static_cast<qreal>(i % kCursorPositionsCount) / kCursorPositionsCount;
+        return {100.0 + 80.0 * qCos(angle), 100.0 + 50.0 * qSin(angle)};
+    }
+
+    QPolygonF makeRegularPolygon(int pointsCount, qreal radius) {
+        QPolygonF polygon;
+        for (int i = 0; i < pointsCount; ++i) {
+            qreal angle = 2.0 * M_PI * i / pointsCount;
+            polygon << QPointF{radius * qCos(angle), radius * qSin(angle)};
+        }
+        return polygon;
+    }
+
+    bool benchmarkGeometryKernels() {
+        const QPointF start{100.0, 100.0};
+        bool isPassed = true;
+
+        isPassed &= benchmark::report("detail::makeRectangle", benchmark::run([&start](std::uint64_t i) {
+            benchmark::doNotOptimize(detail::makeRectangle(start, cursorPosition(i)));
+        }), true);
+
+        isPassed &= benchmark::report("detail::makeSquare", benchmark::run([&start](std::uint64_t i) {
+            benchmark::doNotOptimize(detail::makeSquare(start, cursorPosition(i)));
+        }), true);
+
+        const QPointF initialCursorPos{180.0, 100.0};
+        isPassed &= benchmark::report("detail::calculateRotationAngle",
+                                      benchmark::run([&start, &initialCursorPos](std::uint64_t i) {
+            benchmark::doNotOptimize(detail::calculateRotationAngle(start, initialCursorPos, cursorPosition(i)));
+        }), true);
+
+        QGraphicsPolygonItem polygonItem{makeRegularPolygon(kPolygonPointsCount, 50.0)};
+        polygonItem.setPos(start);
+        polygonItem.setRotation(30.0);
+        isPassed &= benchmark::report("detail::getPolygonCenterRelativeTo<kItemCoords>",
+                                      benchmark::run([&polygonItem](std::uint64_t) {
+            benchmark::doNotOptimize(detail::getPolygonCenterRelativeTo<CoordsType::kItemCoords>(&polygonItem));
+        }), false);
+        isPassed &= benchmark::report("detail::getPolygonCenterRelativeTo<kSceneCoords>",
+                                      benchmark::run([&polygonItem](std::uint64_t) {
+            benchmark::doNotOptimize(detail::getPolygonCenterRelativeTo<CoordsType::kSceneCoords>(&polygonItem));
+        }), false);
+
+        QGraphicsRectItem rectItem{QRectF{0.0, 0.0, 120.0, 80.0}};
+        rectItem.setPos(start);
+        rectItem.setRotation(30.0);
+        isPassed &= benchmark::report("detail::copyGraphicsItem<QGraphicsRectItem>",
+                                      benchmark::run([&rectItem](std::uint64_t) {
+            delete detail::copyGraphicsItem(&rectItem);
+        }), false);
+
+        QGraphicsPolygonItem copiedPolygonItem{makeRegularPolygon(kPolygonPointsCount, 50.0)};
+        copiedPolygonItem.setPos(start);
+        isPassed &= benchmark::report("detail::copyGraphicsItem<QGraphicsPolygonItem>",
+                                      benchmark::run([&copiedPolygonItem](std::uint64_t) {
+            delete detail::copyGraphicsItem(&copiedPolygonItem);
+        }), false);
+
+        return isPassed;
+    }
+
+    // A brush stroke as BrushModeView draws it: a preview line per move from the pool, points into the arena,
+    // and all lines back to the pool on release. Once the pool and the arena have grown, a stroke must not allocate.
+    bool benchmarkPreviewGesture() {
+        QGraphicsScene scene;
+        scene.setItemIndexMethod(QGraphicsScene::NoIndex);
+        PreviewItemPool<QGraphicsLineItem> linePool;
+        PreviewGeometryArena strokePoints;
+        std::vector<QGraphicsLineItem*> temporaryLines;
+        const QPen pen{Qt::black, 10.0, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin};
+
+        return benchmark::report("brush preview stroke (pooled lines, geometry arena)",
+                                 benchmark::run([&](std::uint64_t i) {
+            strokePoints.reset();
+            strokePoints.append(cursorPosition(i));
+            for (std::uint64_t move = 1; move <= kGestureMovesCount; ++move) {
+                QPointF currentCursorPos = cursorPosition(i + move);
+                auto* line = linePool.acquire(&scene);
+                line->setLine(QLineF{strokePoints.back(), currentCursorPos});
+                line->setPen(pen);
+                temporaryLines.push_back(line);
+                strokePoints.append(currentCursorPos);
+            }
+            benchmark::doNotOptimize(strokePoints.size());
+            linePool.releaseAll(temporaryLines);
+        }), true);
+    }
+
+    // A 4k x 4k canvas framed by a rectangle with a grid of outlined circles inside, the open area between the
+    // circles reaches the whole canvas and a circle encloses a small area.
+    void populateFillScene(QGraphicsScene& scene) {
+        scene.setSceneRect(0, 0, kFillCanvasSize, kFillCanvasSize);
+        QPen pen{Qt::black, 2.0};
+        scene.addRect(QRectF{1, 1, kFillCanvasSize - 2, kFillCanvasSize - 2}, pen);
+        const qreal cellSize = static_cast<qreal>(kFillCanvasSize) / kFillObstaclesPerSide;
+        for (int row = 0; row < kFillObstaclesPerSide; ++row) {
+            for (int column = 0; column < kFillObstaclesPerSide; ++column) {
+                QRectF cell{column * cellSize, row * cellSize, cellSize, cellSize};
+                scene.addEllipse(cell.adjusted(cellSize / 4, cellSize / 4, -cellSize / 4, -cellSize / 4), pen);
+            }
+        }
+    }
+
+    QImage rasterizeScene(QGraphicsScene& scene, const QRect& window) {
+        QImage image{window.size(), QImage::Format_RGB32};
+        image.fill(Qt::white);
+        QPainter painter{&image};
+        scene.render(&painter, QRectF{image.rect()}, QRectF{window});
+        return image;
+    }
+
+    bool benchmarkFloodFill() {
+        QGraphicsScene scene;
+        populateFillScene(scene);
+        bool isPassed = true;
+        std::vector<std::uint8_t> mask;
+        auto rasterize = [&scene](const QRect& window) { return rasterizeScene(scene, window); };
+
+        const QSize canvasSize{kFillCanvasSize, kFillCanvasSize};
+        const QPoint openAreaSeed{8, 8};
+        const qreal cellSize = static_cast<qreal>(kFillCanvasSize) / kFillObstaclesPerSide;
+        const QPoint enclosedSeed = QPointF{cellSize * 7.5, cellSize * 7.5}.toPoint();
+
+        isPassed &= benchmark::report("fill 4096x4096 open area (raster, fill, trace)",
+                                      benchmark::run([&](std::uint64_t) {
+            auto fill = detail::fillReachableRegion(canvasSize, openAreaSeed, kFillTolerance, rasterize, mask);
+            benchmark::doNotOptimize(detail::traceFilledRegion(mask.data(), fill.window.size(), fill.filledBounds));
+        }), false, kMaxFillNs);
+
+        isPassed &= benchmark::report("fill enclosed circle in 4096x4096 canvas",
+                                      benchmark::run([&](std::uint64_t) {
+            auto fill = detail::fillReachableRegion(canvasSize, enclosedSeed, kFillTolerance, rasterize, mask);
+            benchmark::doNotOptimize(detail::traceFilledRegion(mask.data(), fill.window.size(), fill.filledBounds));
+        }), false, kMaxFillNs);
+
+        const QImage canvas = rasterizeScene(scene, QRect{QPoint{0, 0}, canvasSize});
+        mask.resize(static_cast<std::size_t>(kFillCanvasSize) * kFillCanvasSize);
+        isPassed &= benchmark::report("detail::buildFillMask 4096x4096", benchmark::run([&](std::uint64_t) {
+            detail::buildFillMask(canvas, canvas.pixel(openAreaSeed), kFillTolerance, mask.data());
+            benchmark::doNotOptimize(mask.front());
+        }), true);
+
+        isPassed &= benchmark::report("detail::buildFillMask + scanlineFloodFill 4096x4096",
+                                      benchmark::run([&](std::uint64_t) {
+            detail::buildFillMask(canvas, canvas.pixel(openAreaSeed), kFillTolerance, mask.data());
+            benchmark::doNotOptimize(detail::scanlineFloodFill(mask.data(), canvasSize, openAreaSeed));
+        }), false);
+
+        return isPassed;
+    }
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // Items and pixmaps need a GUI application, no window is shown.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication application{argc, argv};
+
+    bool isPassed = benchmarkGeometryKernels();
+    isPassed &= benchmarkPreviewGesture();
+    isPassed &= benchmarkFloodFill();
+    return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,20 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QPointer>
+
+namespace detail {
+
+    // Calls `function(receiver)` in the main thread unless `receiver` has been destroyed by then. Jobs started
+    // on QThreadPool::globalInstance() report their results through it, as they can outlive their starter.
+    template<typename Receiver, typename Function>
+    void invokeIfAlive(const QPointer<Receiver>& receiver, Function function) {
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [receiver, function]() {
+            if (!receiver.isNull()) function(receiver.data());
+        }, Qt::QueuedConnection);
+    }
+
+}  // namespace detail
@@ -0,0 +1,64 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "document-file.h"
+
+enum class BatchOperation {
+    kSimplify,
+    kFlatten
+};
+
+enum class ExportFormat {
+    kPng,
+    kSvg,
+    kPdf
+};
+
+struct BatchOptions {
+    QStringList inputFiles;
+    QString outputDirectory;
+    QList<BatchOperation> operations;
+    ExportFormat format{ExportFormat::kPng};
+    qreal scale{1.0};
+    qreal simplifyTolerance{0.5};
+    int jobsCount{0};
+};
+
+struct BatchFileResult {
+    QString inputFile;
+    QString outputFile;
+    QString error;
+    qint64 elapsedMs{0};
+};
+
+class BatchConverter {
+/*
+ Converts documents without the GUI: every input file is loaded, processed by the requested operations
+ and exported by a worker of a thread pool. Workers operate on their own DocumentSnapshot instead of
+ a scene, so files do not share any state and are processed concurrently.
+*/
+ public:
+    explicit BatchConverter(BatchOptions options);
+
+    // Blocks until all files are processed, results are in the order of input files.
+    [[nodiscard]] QList<BatchFileResult> run() const;
+
+ private:
+    [[nodiscard]] BatchFileResult convertFile(const QString& inputFile) const;
+    void applyOperations(DocumentSnapshot& document) const;
+    [[nodiscard]] bool exportDocument(const DocumentSnapshot& document, const QString& outputFile) const;
+    [[nodiscard]] QString makeOutputFilePath(const QString& inputFile) const;
+
+    BatchOptions options_;
+};
+
+namespace detail {
+    [[nodiscard]] bool isBatchModeRequested(int argc, char* argv[]);
+
+    // Parses the command line of the batch mode, converts the files and prints per-file timings, returns exit code.
+    int runBatchMode(const QStringList& arguments);
+}
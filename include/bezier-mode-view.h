@@ -0,0 +1,34 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include "drawing-graphics-view.h"
+
+class BezierPathItem;
+
+class BezierModeView final : public DrawingGraphicsView {
+/*
+ Draws smooth curves of cubic Bézier segments. A click adds an anchor point, dragging from it pulls out
+ the handle of the curve leaving the anchor, the opposite handle mirrors it. The segment to the cursor is
+ previewed as it moves, the right button finishes the curve.
+*/
+ public:
+    BezierModeView(ApplicationGraphicsScene* scene, QSize viewSize);
+
+ protected:
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+ private:
+    void addAnchor(const QPointF& position);
+    void finishCurve();
+
+    BezierPathItem* currentItem_;
+    QPointF anchor_;
+    // The handle leaving the previous anchor, which starts the last segment.
+    QPointF previousHandle_;
+    // The handle leaving the last anchor, which starts the next segment.
+    QPointF handle_;
+    bool isPlacingHandle_;
+};
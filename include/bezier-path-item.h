@@ -0,0 +1,60 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include <QPainterPath>
+#include <QPen>
+#include <QPolygonF>
+#include <vector>
+
+class BezierPathItem final : public QGraphicsItem {
+/*
+ A path of cubic Bézier segments painted with the pen. Control points are kept as the start point followed by
+ two control points and the end point of every segment, the end point of a segment starts the next one.
+ Segments are flattened into polylines for painting and hit-testing. A flattened segment is cached together
+ with the level of detail it was flattened for and is flattened again only when it is painted at another level,
+ i.e. after zooming by a factor of two, and only if it is visible. Editing a segment flattens just that segment.
+*/
+ public:
+    enum { Type = UserType + 5 };
+
+    explicit BezierPathItem(const QPolygonF& controlPoints, QGraphicsItem* parent = nullptr);
+
+    [[nodiscard]] int type() const override;
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
+    [[nodiscard]] bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    [[nodiscard]] QPen pen() const;
+    void setPen(const QPen& pen);
+
+    [[nodiscard]] QPolygonF controlPoints() const;
+    [[nodiscard]] QPainterPath path() const;
+    [[nodiscard]] qsizetype segmentsCount() const noexcept;
+
+    void appendSegment(const QPointF& firstControl, const QPointF& secondControl, const QPointF& end);
+    void setLastSegment(const QPointF& firstControl, const QPointF& secondControl, const QPointF& end);
+    void removeLastSegment();
+
+    // Control points of a path made of cubic segments, straight segments are converted to cubic ones.
+    [[nodiscard]] static QPolygonF controlPointsOf(const QPainterPath& path);
+
+ private:
+    struct FlattenedSegment {
+        QPolygonF points;
+        // Bounds of the control points, which contain the whole segment.
+        QRectF bounds;
+        int level;
+    };
+
+    const QPolygonF& flattenedSegment(qsizetype index, int level) const;
+    [[nodiscard]] int cachedLevel(qsizetype index) const noexcept;
+    void updateBoundingRect();
+
+    QPolygonF controlPoints_;
+    mutable std::vector<FlattenedSegment> segments_;
+    QRectF boundingRect_;
+    QPen pen_;
+};
@@ -2,11 +2,25 @@
 
 #pragma once
 
+#include <QGraphicsEllipseItem>
+#include <QGraphicsLineItem>
 #include "drawing-graphics-view.h"
+#include "preview-geometry-arena.h"
+#include "preview-item-pool.h"
+
+class RasterPaintLayer;
+
+enum class BrushBackend {
+    kVector,
+    kRaster
+};
 
 class BrushModeView final : public DrawingGraphicsView {
  public:
-    BrushModeView(QGraphicsScene* scene, QSize viewSize);
+    BrushModeView(ApplicationGraphicsScene* scene, QSize viewSize);
+
+    [[nodiscard]] BrushBackend getBackend() const noexcept;
+    void setBackend(BrushBackend backend);
 
  protected:
     void mousePressEvent(QMouseEvent* event) override;
@@ -14,8 +28,19 @@ class BrushModeView final : public DrawingGraphicsView {
     void mouseReleaseEvent(QMouseEvent* event) override;
 
  private:
+    void startVectorStroke();
+    void continueVectorStroke(const QPointF& currentCursorPos);
+    void finishVectorStroke();
+    RasterPaintLayer* rasterLayer();
+
+    PreviewItemPool<QGraphicsLineItem> linePool_;
+    PreviewItemPool<QGraphicsEllipseItem> ellipsePool_;
     QList<QGraphicsLineItem*> temporaryLines_;
+    PreviewGeometryArena strokePoints_;
+    QPen strokePen_;
     QGraphicsEllipseItem* startEllipseItem_;
     QPointF startCursorPos_;
     QPointF previousCursorPos_;
+    BrushBackend backend_;
+    bool isDrawing_;
 };
@@ -7,4 +7,8 @@
 namespace constants {
     constexpr QSizeF kZeroSizeF{0, 0};
     constexpr QPointF kZeroPointF{0, 0};
+
+    // Keys of QGraphicsItem::data() used by the application.
+    constexpr int kFlattenJobDataKey{0};
+    constexpr int kMirrorIdDataKey{1};
 }
@@ -0,0 +1,47 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include <QHash>
+#include <QPoint>
+#include <vector>
+#include "document-diff.h"
+
+class DiffOverlayItem final : public QGraphicsItem {
+/*
+ Highlights the differences of the drawing from a compared document above all layers: added items are outlined
+ in green, restyled ones in orange, moved ones in blue together with their previous place, and removed items are
+ painted faded with a red outline. Only the differences intersecting the exposed area are painted: they are
+ bucketed by grid cells like in ItemGrid, so a repaint visits the cells under the exposed area instead of
+ every difference.
+
+ The overlay is transparent for hit-testing and is not a part of any layer, so it is neither edited nor saved.
+*/
+ public:
+    enum { Type = UserType + 6 };
+
+    explicit DiffOverlayItem(DocumentDifference difference, QGraphicsItem* parent = nullptr);
+
+    [[nodiscard]] int type() const override;
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
+    [[nodiscard]] bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    [[nodiscard]] const DocumentDifference& difference() const noexcept;
+
+ private:
+    [[nodiscard]] QRect cellsOf(const QRectF& rect) const;
+    void link(qsizetype row, const QRectF& bounds);
+
+    DocumentDifference difference_;
+    QRectF boundingRect_;
+    // Rows of the differences whose current or previous bounds overlap a cell.
+    QHash<QPoint, QList<qsizetype>> cells_;
+    // The paint which has visited a difference last, so differences spanning several cells are painted once.
+    std::vector<quint64> paintStamps_;
+    quint64 paintStamp_;
+    // Rows visited by a paint, reused between paints.
+    std::vector<qsizetype> exposedRows_;
+};
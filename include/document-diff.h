@@ -0,0 +1,43 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QList>
+#include <QRectF>
+#include "document-file.h"
+
+enum class ItemChange {
+    kAdded,
+    kRemoved,
+    kMoved,
+    kRestyled
+};
+
+struct ItemDifference {
+    ItemChange change{ItemChange::kAdded};
+    // The item of the compared document, or the item of the base document when it is removed.
+    ItemSnapshot item;
+    QRectF sceneBounds;
+    // Bounds of the item in the base document, differ from `sceneBounds` only for moved items.
+    QRectF previousSceneBounds;
+};
+
+struct DocumentDifference {
+    QList<ItemDifference> items;
+    qsizetype unchangedCount{0};
+
+    [[nodiscard]] qsizetype count(ItemChange change) const;
+};
+
+namespace detail {
+    // Hashes of the parts of an item which are compared separately. Equal parts have equal hashes.
+    [[nodiscard]] size_t hashItemGeometry(const ItemSnapshot& item, size_t seed = 0);
+    [[nodiscard]] size_t hashItemStyle(const ItemSnapshot& item, size_t seed = 0);
+    [[nodiscard]] size_t hashItemPlacement(const ItemSnapshot& item, size_t seed = 0);
+
+    // Matches the items of `after` with the items of `before` regardless of their layers. Items equal in everything
+    // are matched first, then items with the same geometry and style, which are moved, preferring the nearest ones,
+    // then items with the same geometry and placement, which are restyled. The rest is added or removed.
+    // Every step looks the items up by hashes, so the time grows linearly with the size of the documents.
+    [[nodiscard]] DocumentDifference diffDocuments(const DocumentSnapshot& before, const DocumentSnapshot& after);
+}
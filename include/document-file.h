@@ -0,0 +1,38 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QList>
+#include <QRectF>
+#include <QString>
+#include <optional>
+#include "scene-snapshot.h"
+
+class QIODevice;
+class ApplicationGraphicsScene;
+
+struct LayerSnapshot {
+    QString name;
+    bool isVisible{true};
+    bool isLocked{false};
+    QList<ItemSnapshot> items;
+};
+
+struct DocumentSnapshot {
+/*
+ A drawing detached from the scene: the canvas and the layers from the bottom one to the topmost one.
+ Like ItemSnapshot, it can be saved, loaded and processed on any thread.
+*/
+    QRectF canvasRect;
+    QList<LayerSnapshot> layers;
+};
+
+namespace detail {
+    [[nodiscard]] DocumentSnapshot takeDocumentSnapshot(const ApplicationGraphicsScene* scene, const QRectF& canvasRect);
+
+    bool writeDocument(QIODevice* device, const DocumentSnapshot& document);
+    [[nodiscard]] std::optional<DocumentSnapshot> readDocument(QIODevice* device);
+
+    bool saveDocument(const QString& filePath, const DocumentSnapshot& document);
+    [[nodiscard]] std::optional<DocumentSnapshot> loadDocument(const QString& filePath);
+}
@@ -0,0 +1,78 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QRectF>
+#include <vector>
+#include "document-file.h"
+
+QT_BEGIN_NAMESPACE
+class QDeadlineTimer;
+class QGraphicsItem;
+class QGraphicsItemGroup;
+class QTimer;
+QT_END_NAMESPACE
+
+class ApplicationGraphicsScene;
+class LayerItem;
+
+class DocumentLoader final : public QObject {
+/*
+ Opens a document without freezing the window. The file is read and parsed on a worker thread, then layers
+ replace the layers of the scene at once and items are created in batches fitting in a frame, so the scene
+ can be panned, zoomed and switched between modes while the rest of the document streams in.
+
+ Items intersecting the visible area are created first and staged in a group above their layer, not selectable.
+ Afterwards all items are added to their layers in the document order, staged ones just change their parent,
+ so the stacking order is the same as in the document. Locked layers are locked when their items are added.
+*/
+    Q_OBJECT
+
+ public:
+    explicit DocumentLoader(ApplicationGraphicsScene* scene, QObject* parent = nullptr);
+    ~DocumentLoader() override;
+
+    void load(const QString& filePath, const QRectF& visibleRect);
+    // Adds all remaining items of the document in progress at once.
+    void finish();
+    void cancel();
+
+    [[nodiscard]] bool isLoading() const noexcept;
+
+ signals:
+    void progressChanged(qsizetype createdCount, qsizetype totalCount);
+    void finished();
+    void failed();
+
+ private slots:
+    void processNextBatch();
+    void forgetRemovedLayers();
+
+ private:
+    struct PendingLayer {
+        LayerItem* layer;
+        QGraphicsItemGroup* stagingGroup;
+        QList<ItemSnapshot> items;
+        std::vector<QGraphicsItem*> stagedItems;
+        qsizetype stagingIndex;
+        qsizetype insertionIndex;
+        bool isLocked;
+    };
+
+    void finishReading(const std::optional<DocumentSnapshot>& document, int loadId);
+    void startInsertion(const DocumentSnapshot& document);
+    [[nodiscard]] bool stageVisibleItems(const QDeadlineTimer& deadline);
+    [[nodiscard]] bool insertItems(const QDeadlineTimer& deadline);
+    void completeLoading();
+
+    ApplicationGraphicsScene* scene_;
+    QTimer* batchTimer_;
+    std::vector<PendingLayer> pendingLayers_;
+    QRectF visibleRect_;
+    qsizetype createdCount_;
+    qsizetype totalCount_;
+    int loadId_;
+    bool isLoading_;
+};
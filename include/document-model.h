@@ -0,0 +1,61 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <vector>
+#include "document-file.h"
+
+class QGraphicsItem;
+class ApplicationGraphicsScene;
+class LayerItem;
+
+class DocumentModel final : public QObject {
+/*
+ The drawing kept as plain snapshots, which follows the changes the modes make through ApplicationGraphicsScene.
+ Items of a layer are stored contiguously in their stacking order. The model hands out immutable DocumentSnapshot
+ values which share this storage, so saving, exporting or analysing the drawing on a worker thread needs neither
+ the scene nor a copy of it. The storage of a layer is copied only when the layer changes while a snapshot still
+ refers to it. Removed items and changes of the stacking order are applied in one pass when a snapshot is taken.
+ Must be used from the GUI thread, the snapshots can be read from any thread.
+*/
+    Q_OBJECT
+
+ public:
+    explicit DocumentModel(ApplicationGraphicsScene* scene, QObject* parent = nullptr);
+
+    [[nodiscard]] DocumentSnapshot snapshot(const QRectF& canvasRect);
+    [[nodiscard]] qsizetype itemsCount() const noexcept;
+
+ private slots:
+    void addItems(const QList<QGraphicsItem*>& items);
+    void moveItems(const QList<QGraphicsItem*>& items);
+    void updateItems(const QList<QGraphicsItem*>& items);
+    void removeItems(const QList<QGraphicsItem*>& items);
+    void reorderItems(const QList<QGraphicsItem*>& items);
+    void updateLayers();
+
+ private:
+    struct ModelLayer {
+        const LayerItem* layer;
+        LayerSnapshot snapshot;
+        // The scene item of every row, removed rows are kept as null items until the layer is compacted.
+        QList<const QGraphicsItem*> sources;
+        qsizetype removedCount;
+        bool isOrderChanged;
+    };
+
+    struct ItemLocation {
+        const LayerItem* layer;
+        qsizetype row;
+    };
+
+    [[nodiscard]] ModelLayer* findLayer(const LayerItem* layer);
+    [[nodiscard]] ItemSnapshot* findItem(const QGraphicsItem* item);
+    void compactLayer(ModelLayer& layer);
+
+    ApplicationGraphicsScene* scene_;
+    std::vector<ModelLayer> layers_;
+    QHash<const QGraphicsItem*, ItemLocation> locations_;
+};
@@ -7,7 +7,7 @@
 
 class DrawingGraphicsView : public ApplicationGraphicsView {
  public:
-    DrawingGraphicsView(QGraphicsScene* scene, QSize viewSize, int strokeWidth = 1);
+    DrawingGraphicsView(ApplicationGraphicsScene* scene, QSize viewSize, int strokeWidth = 1);
 
     ~DrawingGraphicsView() override;
 
@@ -20,6 +20,10 @@ class DrawingGraphicsView : public ApplicationGraphicsView {
     virtual void setStrokeWidth(int width);
 
  protected:
+    // Styles of the created shapes, interned in the style registry.
+    [[nodiscard]] QPen shapePen() const;
+    [[nodiscard]] QBrush fillBrush() const;
+
     QColor fillColor_;
     QColor strokeColor_;
     qreal strokeWidth_;
@@ -0,0 +1,19 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include "drawing-graphics-view.h"
+
+class FillModeView final : public DrawingGraphicsView {
+ public:
+    FillModeView(ApplicationGraphicsScene* scene, QSize viewSize);
+
+ protected:
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+ private:
+    // Renders the part `window` of the canvas, given in canvas pixels.
+    [[nodiscard]] QImage rasterizeCanvas(const QRect& window) const;
+    void fillRegion(const QPointF& clickPos);
+};
@@ -0,0 +1,44 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QImage>
+#include <QPainterPath>
+#include <QRect>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace detail {
+
+    enum FillCell : std::uint8_t {
+        kFillableCell = 0,
+        kBoundaryCell = 1,
+        kFilledCell = 2
+    };
+
+    // `image` must be in QImage::Format_RGB32 or QImage::Format_ARGB32, `mask` must hold width * height cells.
+    // A pixel is fillable when none of its channels differ from `seedColor` by more than `tolerance`.
+    void buildFillMask(const QImage& image, QRgb seedColor, int tolerance, std::uint8_t* mask) noexcept;
+
+    // Fills the 4-connected region of fillable cells around `seed`, returns the bounding rectangle of filled cells.
+    QRect scanlineFloodFill(std::uint8_t* mask, QSize size, QPoint seed);
+
+    // Traces the outlines (including holes) of filled cells inside `bounds` into a path in mask coordinates.
+    QPainterPath traceFilledRegion(const std::uint8_t* mask, QSize size, const QRect& bounds);
+
+    struct ReachableFill {
+        // The rasterized part of the canvas, `mask` holds its cells.
+        QRect window;
+        // Filled cells in window coordinates, empty when nothing is filled.
+        QRect filledBounds;
+    };
+
+    // Fills the region around `seed` rasterizing only the part of the canvas the fill reaches: a window around
+    // the seed is filled first, and while the fill touches a side of the window which is not a side of the canvas,
+    // the window is doubled and filled again. `rasterize` returns the window in QImage::Format_RGB32.
+    ReachableFill fillReachableRegion(QSize canvasSize, QPoint seed, int tolerance,
+                                      const std::function<QImage(const QRect&)>& rasterize,
+                                      std::vector<std::uint8_t>& mask);
+
+}  // namespace detail
@@ -0,0 +1,89 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsScene>
+#include "item-attribute-index.h"
+#include "item-grid.h"
+
+class LayerItem;
+class QTimer;
+
+enum class StackingMove {
+    kToFront,
+    kToBack,
+    kForward,
+    kBackward
+};
+
+class ApplicationGraphicsScene final : public QGraphicsScene {
+    Q_OBJECT
+
+ public:
+    explicit ApplicationGraphicsScene(QObject* parent = nullptr);
+    ~ApplicationGraphicsScene() override;
+
+    LayerItem* addLayer(const QString& name);
+    // Inserts a layer at `index` from the bottom one, the new layer becomes the active one.
+    LayerItem* insertLayer(qsizetype index, const QString& name);
+    void removeLayer(LayerItem* layer);
+    void setActiveLayer(LayerItem* layer);
+    void setLayerVisible(LayerItem* layer, bool isVisible);
+    void setLayerLocked(LayerItem* layer, bool isLocked);
+    void setLayerName(LayerItem* layer, const QString& name);
+
+    [[nodiscard]] const QList<LayerItem*>& getLayers() const noexcept;
+    [[nodiscard]] LayerItem* getActiveLayer() const noexcept;
+    [[nodiscard]] bool isActiveLayerEditable() const noexcept;
+
+    void addItemToActiveLayer(QGraphicsItem* item);
+    void addItemsToActiveLayer(const QList<QGraphicsItem*>& items);
+    void addItemsToLayer(LayerItem* layer, const QList<QGraphicsItem*>& items);
+    void addItemToLayerOf(QGraphicsItem* item, const QGraphicsItem* layerMember);
+    void moveItems(const QList<QGraphicsItem*>& items, const QPointF& delta);
+    void notifyItemsTransformed(const QList<QGraphicsItem*>& items);
+    // Changes the stacking order of the items within their layers, keeping their relative order.
+    void restackItems(const QList<QGraphicsItem*>& items, StackingMove move);
+    void deleteItems(const QList<QGraphicsItem*>& items);
+
+    [[nodiscard]] QGraphicsItem* editableItemAt(const QPointF& position) const;
+    [[nodiscard]] QList<QGraphicsItem*> editableItems(const QRectF& rect) const;
+    [[nodiscard]] static bool isItemEditable(const QGraphicsItem* item);
+    // Items of the layers over `rect`, in the stacking order from the bottom of the bottom layer.
+    [[nodiscard]] QList<QGraphicsItem*> layerItems(const QRectF& rect) const;
+
+    // Selects the editable items of the same type, pen and brush as any of `samples`, returns their count.
+    qsizetype selectSimilarItems(const QList<QGraphicsItem*>& samples);
+
+ signals:
+    void layersChanged();
+
+    // Changes of layer items made by the modes, which are observed e.g. by the scene mirroring.
+    void itemsAdded(const QList<QGraphicsItem*>& items);
+    void itemsMoved(const QList<QGraphicsItem*>& items, const QPointF& delta);
+    void itemsTransformed(const QList<QGraphicsItem*>& items);
+    void itemsRestacked(const QList<QGraphicsItem*>& items, StackingMove move);
+    void itemsAboutToBeDeleted(const QList<QGraphicsItem*>& items);
+    // Areas where layer items were added, changed, restacked, removed, shown or hidden. Unlike
+    // QGraphicsScene::changed(), it is not emitted for selection handles and other items of the modes.
+    void layerItemsRegionChanged(const QList<QRectF>& region);
+
+ private:
+    void insertItemToLayer(LayerItem* layer, QGraphicsItem* item);
+    void forgetLayerItem(QGraphicsItem* item, QList<QRectF>& region);
+    void updateLayerItemsRegion(const QList<QGraphicsItem*>& items);
+    static bool restackLayerItems(LayerItem* layer, const QList<QGraphicsItem*>& items, StackingMove move);
+    void updateLayersZValues();
+    void freeDeletedItems();
+
+ private:
+    QList<LayerItem*> layers_;
+    LayerItem* activeLayer_;
+    // Items already removed from the scene, which are freed in portions between the events.
+    QList<QGraphicsItem*> itemsToFree_;
+    QTimer* freeTimer_;
+    // Layer items by their attributes, updated as the items are inserted to and removed from the layers.
+    ItemAttributeIndex attributeIndex_;
+    // Bounds of the layer items, updated as the items are inserted, changed through the scene and removed.
+    ItemGrid layerItemsGrid_;
+};
@@ -4,21 +4,35 @@
 
 #include <QGraphicsView>
 
+class ApplicationGraphicsScene;
+class RenderQualityGovernor;
+
 class ApplicationGraphicsView : public QGraphicsView {
     Q_OBJECT
 
  public:
-    ApplicationGraphicsView(QGraphicsScene* scene, QSize viewSize);
+    ApplicationGraphicsView(ApplicationGraphicsScene* scene, QSize viewSize);
     ~ApplicationGraphicsView() override = default;
 
+    [[nodiscard]] ApplicationGraphicsScene* applicationScene() const noexcept;
+
  protected:
     bool event(QEvent* event) override;
+    bool viewportEvent(QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
  signals:
     void cursorHasLeavedView();
     void changeStateOfScene();
     void cursorPositionChanged(QPointF position);
+    void visibleAreaChanged();
+    void framePainted(const QRectF& visibleRect, const QTransform& viewTransform, bool isDraft);
+    void fullQualityRestored();
 
  protected:
+    ApplicationGraphicsScene* applicationScene_;
+    RenderQualityGovernor* qualityGovernor_;
     QSize viewSize_;
 };
@@ -0,0 +1,51 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include "style-registry.h"
+
+class QGraphicsItem;
+
+namespace detail {
+
+    // Attributes shared by similar items: the type of the item, its pen and its brush.
+    struct AttributesKey {
+        int type{0};
+        StyleKey pen;
+        StyleKey brush;
+        // False when the pen or the brush has no style key, such items are compared by their styles on lookup.
+        bool isExact{true};
+
+        bool operator==(const AttributesKey& other) const noexcept {
+            return type == other.type && pen == other.pen && brush == other.brush && isExact == other.isExact;
+        }
+    };
+
+    [[nodiscard]] size_t qHash(const AttributesKey& key, size_t seed = 0) noexcept;
+
+    [[nodiscard]] AttributesKey itemAttributesKey(const QGraphicsItem* item);
+
+}  // namespace detail
+
+class ItemAttributeIndex {
+/*
+ Groups the items of the scene by their type, pen and brush, so all items similar to a given one are found
+ without visiting the rest of the scene. The key of an item is computed when it is inserted and kept until it
+ is removed, an item whose style is changed must be inserted again.
+*/
+ public:
+    void insert(QGraphicsItem* item);
+    void remove(QGraphicsItem* item);
+    void clear();
+
+    // Items with the same attributes as any of `samples`, the samples included.
+    [[nodiscard]] QList<QGraphicsItem*> similarItems(const QList<QGraphicsItem*>& samples) const;
+    [[nodiscard]] qsizetype size() const noexcept;
+
+ private:
+    QHash<detail::AttributesKey, QSet<QGraphicsItem*>> buckets_;
+    QHash<const QGraphicsItem*, detail::AttributesKey> keys_;
+};
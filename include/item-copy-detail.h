@@ -0,0 +1,69 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include "item-transformations-detail.h"
+#include "stroke-item.h"
+#include "bezier-path-item.h"
+
+namespace detail {
+
+    constexpr qreal kZeroAngle{0};
+
+    template<typename ItemT, typename ItemU>
+    void copyGraphicProperties(const ItemT* originalItem, ItemU* destinationElement) {
+        destinationElement->setPen(originalItem->pen());
+        if constexpr (!std::is_same_v<ItemT, QGraphicsLineItem> && !std::is_same_v<ItemT, StrokeItem> &&
+                      !std::is_same_v<ItemT, BezierPathItem>) {
+            destinationElement->setBrush(originalItem->brush());
+        }
+    }
+
+    template<typename ItemType, typename AngleT>
+    inline void setUpItemsAngles(ItemType* originalItem, ItemType* destinationItem, AngleT angle) {
+        destinationItem->setTransformOriginPoint(getGraphicsItemSceneCenterPos(destinationItem));
+        destinationItem->setRotation(angle);
+        originalItem->setRotation(angle);
+        copyGraphicProperties(originalItem, destinationItem);
+    }
+
+    inline QLineF translateLineToSceneCoords(const QGraphicsLineItem* item) {
+        QLineF newLine{item->mapToScene(item->line().p1()),
+                       item->mapToScene(item->line().p2())};
+
+        return newLine;
+    }
+
+    template<typename ItemType>
+    auto copyGraphicsItem(ItemType* originalItem) {
+        auto rotationAngle = originalItem->rotation();
+        originalItem->setRotation(kZeroAngle);
+        ItemType* temporaryItem{nullptr};
+
+        if constexpr (std::is_same_v<ItemType, QGraphicsRectItem> || std::is_same_v<ItemType, QGraphicsEllipseItem>) {
+            temporaryItem = new ItemType{originalItem->sceneBoundingRect()};
+        } else if constexpr (std::is_same_v<ItemType, QGraphicsPolygonItem>) {
+            temporaryItem = new ItemType{originalItem->mapToScene(originalItem->polygon())};
+        } else if constexpr (std::is_same_v<ItemType, QGraphicsPathItem>) {
+            temporaryItem = new ItemType{originalItem->mapToScene(originalItem->path())};
+        } else if constexpr (std::is_same_v<ItemType, QGraphicsLineItem>) {
+            temporaryItem = new ItemType{translateLineToSceneCoords(originalItem)};
+        } else if constexpr (std::is_same_v<ItemType, StrokeItem>) {
+            temporaryItem = new ItemType{originalItem->mapToScene(originalItem->points())};
+        } else if constexpr (std::is_same_v<ItemType, BezierPathItem>) {
+            temporaryItem = new ItemType{originalItem->mapToScene(originalItem->controlPoints())};
+        }
+
+        if (temporaryItem != nullptr)
+            setUpItemsAngles(originalItem, temporaryItem, rotationAngle);
+
+        return temporaryItem;
+    }
+
+    QGraphicsPixmapItem* copyPixmapItem(const QGraphicsPixmapItem* originalItem);
+
+    // Copies the item in scene coordinates, the copy is selectable and movable and is not added to a scene.
+    QGraphicsItem* cloneGraphicsItem(QGraphicsItem* originalItem);
+
+}  // namespace detail
@@ -0,0 +1,75 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QRectF>
+
+class QGraphicsItem;
+
+class ItemGrid {
+/*
+ A uniform grid over the scene, which buckets items by the cells their scene bounding rectangles overlap.
+ Looking up the items over a rectangle visits only the cells it overlaps, so its cost does not depend on
+ how many items are elsewhere in the scene. The grid keeps the bounds the items had when they were last
+ inserted or updated, which also tells where a moved or transformed item was painted before.
+*/
+ public:
+    explicit ItemGrid(qreal cellSize = kDefaultCellSize);
+
+    // Inserts the item or updates its bounds, returns the bounds it had before, empty for a new item.
+    QRectF update(QGraphicsItem* item);
+    // Returns the bounds the removed item had, empty for an unknown item.
+    QRectF remove(QGraphicsItem* item);
+    void clear();
+
+    [[nodiscard]] bool contains(const QGraphicsItem* item) const;
+    [[nodiscard]] QRectF bounds(const QGraphicsItem* item) const;
+
+    // Calls `visit(item)` once for every item whose bounds intersect `rect`, in no particular order.
+    template<typename Visitor>
+    void forEachItem(const QRectF& rect, Visitor visit) const;
+
+ private:
+    // Side of a cell in scene coordinates, a view at the usual zoom covers a few dozens of cells.
+    static constexpr qreal kDefaultCellSize{256.0};
+
+    struct Entry {
+        QRectF bounds;
+        // The cells the item is bucketed into, empty when it is in none.
+        QRect cells;
+        // The lookup which has visited the item last, so items spanning several cells are visited once.
+        mutable quint64 lookup;
+    };
+
+    [[nodiscard]] QRect cellsOf(const QRectF& rect) const;
+    void link(QGraphicsItem* item, const QRect& cells);
+    void unlink(QGraphicsItem* item, const QRect& cells);
+
+    qreal cellSize_;
+    QHash<const QGraphicsItem*, Entry> entries_;
+    QHash<QPoint, QList<QGraphicsItem*>> cells_;
+    mutable quint64 lookup_;
+};
+
+template<typename Visitor>
+void ItemGrid::forEachItem(const QRectF& rect, Visitor visit) const {
+    QRect cells = cellsOf(rect);
+    if (cells.isEmpty()) return;
+    ++lookup_;
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            auto cell = cells_.constFind(QPoint{x, y});
+            if (cell == cells_.cend()) continue;
+            for (auto* item : cell.value()) {
+                const Entry& entry = *entries_.constFind(item);
+                if (entry.lookup == lookup_) continue;
+                entry.lookup = lookup_;
+                if (entry.bounds.intersects(rect)) visit(item);
+            }
+        }
+    }
+}
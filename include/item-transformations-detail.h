@@ -0,0 +1,37 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include <QPointF>
+
+namespace detail {
+
+    enum class CoordsType {
+        kSceneCoords,
+        kItemCoords
+    };
+
+    template<CoordsType type>
+    QPointF getPolygonCenterRelativeTo(const QGraphicsPolygonItem* polygonItem) {
+        auto points = polygonItem->polygon().toVector();
+        QPointF sum{};
+
+        for (const auto& point : points) {
+            if constexpr (type == CoordsType::kSceneCoords) {
+                sum += polygonItem->mapToScene(point);
+            } else if constexpr (type == CoordsType::kItemCoords) {
+                sum += point;
+            }
+        }
+
+        return sum / static_cast<qreal>(points.size());
+    }
+
+    QPointF getGraphicsItemSceneCenterPos(const QGraphicsItem* item);
+    QPointF getGraphicsItemOwnCenterPos(const QGraphicsItem* item);
+    qreal calculateRotationAngle(const QPointF& geometricCenterO,
+                                 const QPointF& initialCursorPosA,
+                                 const QPointF& currentCursorPosB) noexcept;
+
+}  // namespace detail
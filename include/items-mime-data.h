@@ -0,0 +1,36 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QMimeData>
+#include <optional>
+#include "scene-snapshot.h"
+
+class ItemsMimeData final : public QMimeData {
+/*
+ Clipboard payload of copied items. The items are kept as snapshots and encoded only when some format
+ is actually requested, so copying is cheap regardless of the number of items, and pasting into the same
+ process does not encode anything at all. Other applications get an SVG image of the items.
+*/
+    Q_OBJECT
+
+ public:
+    explicit ItemsMimeData(QList<ItemSnapshot> items);
+    ~ItemsMimeData() override = default;
+
+    [[nodiscard]] const QList<ItemSnapshot>& getItems() const noexcept;
+    [[nodiscard]] QStringList formats() const override;
+    [[nodiscard]] bool hasFormat(const QString& mimeType) const override;
+
+    // Items of a payload copied by this or another instance of the application.
+    [[nodiscard]] static std::optional<QList<ItemSnapshot>> decodeItems(const QMimeData* mimeData);
+
+ protected:
+    [[nodiscard]] QVariant retrieveData(const QString& mimeType, QMetaType type) const override;
+
+ private:
+    [[nodiscard]] QByteArray encodeItems() const;
+    [[nodiscard]] QByteArray renderSvg() const;
+
+    QList<ItemSnapshot> items_;
+};
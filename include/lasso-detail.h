@@ -0,0 +1,17 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QPolygonF>
+#include <cstddef>
+#include <cstdint>
+
+namespace detail {
+
+    // Even-odd containment of `count` points given as separate arrays of coordinates in an implicitly closed polygon.
+    // Sets `isInside[i]` to 1 for points inside the polygon and to 0 for the others. Edges are walked in the outer
+    // loop and points in the inner loop, which is free of branches and is vectorized by the compiler.
+    void testPointsInPolygon(const float* xs, const float* ys, std::size_t count,
+                             const QPolygonF& polygon, std::uint8_t* isInside) noexcept;
+
+}  // namespace detail
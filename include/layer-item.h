@@ -0,0 +1,64 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include <QPixmap>
+
+class RasterPaintLayer;
+
+class LayerItem final : public QGraphicsItem {
+/*
+ A named container of scene items. Items of a layer are its children, so hiding a layer hides
+ the whole subtree and the scene skips it at paint time and in hit-testing.
+
+ Z-values of the children are distinct fractional keys of their stacking order. Items put on top or at the bottom
+ take the next key past the ends, items put between two neighbours take keys between theirs, so a change of
+ the order does not renumber the other children. Only when the keys become too close to be told apart
+ the children are renumbered.
+
+ A cached layer renders its items once into a pixmap, hides them and paints the pixmap instead,
+ until the cache is dropped or invalidated. The cache is re-rendered only when the scale it is
+ painted at changes. Items of grandchildren level are not supposed to exist in a layer.
+*/
+ public:
+    enum { Type = UserType + 2 };
+
+    explicit LayerItem(const QString& name, QGraphicsItem* parent = nullptr);
+
+    [[nodiscard]] int type() const override;
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
+    [[nodiscard]] bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    [[nodiscard]] const QString& getName() const noexcept;
+    [[nodiscard]] bool isLocked() const noexcept;
+    [[nodiscard]] bool isCached() const noexcept;
+
+    void setName(const QString& name);
+    void setLocked(bool isLocked);
+    void setCached(bool isCached);
+    void invalidateCache();
+
+    [[nodiscard]] qreal takeFrontZValue() noexcept;
+    [[nodiscard]] qreal takeBackZValue() noexcept;
+    void renumberChildren();
+
+    RasterPaintLayer* rasterSurface(const QRectF& canvas);
+
+ private:
+    void renderCache(qreal scale);
+    void setChildrenVisible(bool isVisible);
+    [[nodiscard]] QRectF calculateContentRect() const;
+
+    QString name_;
+    QPixmap cache_;
+    QRectF cacheRect_;
+    qreal cacheScale_;
+    qreal frontZValue_;
+    qreal backZValue_;
+    RasterPaintLayer* rasterSurface_;
+    bool isLocked_;
+    bool isCached_;
+};
@@ -0,0 +1,44 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QWidget>
+
+QT_BEGIN_NAMESPACE
+class QListWidget;
+class QListWidgetItem;
+class QPushButton;
+QT_END_NAMESPACE
+
+class ApplicationGraphicsScene;
+class LayerItem;
+
+class LayersPanel final : public QWidget {
+    Q_OBJECT
+
+ public:
+    explicit LayersPanel(ApplicationGraphicsScene* scene, QWidget* parent = nullptr);
+    ~LayersPanel() override = default;
+
+ private:
+    void setUpLayout();
+    void setUpConnections();
+    [[nodiscard]] LayerItem* layerAt(int row) const;
+
+ private slots:
+    void updateLayersList();
+    void addLayer();
+    void removeLayer();
+    void setActiveLayerLocked(bool isLocked);
+    void applyLayerItemChanges(QListWidgetItem* listItem);
+    void activateLayer(int row);
+
+ private:
+    ApplicationGraphicsScene* scene_;
+    QListWidget* layersList_;
+    QPushButton* addButton_;
+    QPushButton* removeButton_;
+    QPushButton* lockButton_;
+    int createdLayersCount_;
+    bool isUpdating_;
+};
@@ -2,11 +2,13 @@
 
 #pragma once
 
+#include <QGraphicsLineItem>
 #include "drawing-graphics-view.h"
+#include "preview-item-pool.h"
 
 class LineModeView final : public DrawingGraphicsView {
  public:
-    LineModeView(QGraphicsScene* scene, QSize viewSize);
+    LineModeView(ApplicationGraphicsScene* scene, QSize viewSize);
 
  protected:
     void mousePressEvent(QMouseEvent* event) override;
@@ -14,6 +16,7 @@ class LineModeView final : public DrawingGraphicsView {
     void mouseReleaseEvent(QMouseEvent* event) override;
 
  private:
+    PreviewItemPool<QGraphicsLineItem> previewPool_;
     QGraphicsLineItem* currentItem_;
     QPointF startCursorPos_;
 };
\ No newline at end of file
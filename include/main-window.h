@@ -4,15 +4,28 @@
 
 #include <QMainWindow>
 #include <QStackedWidget>
+#include <functional>
+#include <optional>
 
 QT_BEGIN_NAMESPACE
-class QGraphicsScene;
 class QGraphicsView;
 class QPushButton;
 class QSpinBox;
 class QLabel;
+class QProgressBar;
 class ModificationModeView;
+class ApplicationGraphicsView;
 class DrawingGraphicsView;
+class BrushModeView;
+class ApplicationGraphicsScene;
+class SceneMirrorPublisher;
+class SceneMirrorFollower;
+class DocumentLoader;
+class DocumentModel;
+class SceneNavigator;
+class DiffOverlayItem;
+class RenderCachePolicy;
+struct DocumentDifference;
 QT_END_NAMESPACE
 
 class MainWindow final : public QMainWindow {
@@ -22,15 +35,20 @@ class MainWindow final : public QMainWindow {
     explicit MainWindow(QSize viewSize, QWidget* parent = nullptr);
     ~MainWindow() override;
 
+ protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
  private:
     QPushButton* addToolBarButton(std::string_view iconPath);
     void addModeButtonsAndConnections(std::string_view iconPath, int btnIndex);
     void setUpToolBarColorButtons(QAction*& action);
     void setUpToolBarSpinBox(QSpinBox* spinBox, QAction*& action);
+    void setUpToolBarRasterBrushButton();
     void changeActionsVisibility(int btnIndex);
     void setUpToolBarActionsConnections();
     void setUpDrawingPropertiesButtons();
-    void setUpConnectionsForStatusBar();
+    void connectViewToStatusBar(ApplicationGraphicsView* view);
+    ApplicationGraphicsView* modeView(int modeIndex);
     void hideAllPropertiesActions();
     void setUpStackedWidgetLayout();
     void setUpApplicationStyles();
@@ -39,6 +57,11 @@ class MainWindow final : public QMainWindow {
     void setUpStatusBar();
     void setUpScreen();
     void setUpScene();
+    void setUpLayersPanel();
+    void setUpFileMenu();
+    void setUpMirroringMenu();
+    void setUpNavigator(ApplicationGraphicsView* view);
+    void finishComparison(const QString& fileName, const std::optional<DocumentDifference>& difference);
 
     template<typename GraphicsViewType, typename Signal>
     void connectViewsSignals(GraphicsViewType view, Signal signal);
@@ -46,6 +69,9 @@ class MainWindow final : public QMainWindow {
     template<typename GraphicsViewType>
     void setUpGraphicView(std::string_view iconPath);
 
+    template<typename GraphicsViewType>
+    GraphicsViewType* createGraphicView(int modeIndex);
+
     template<int PropertiesAmount, typename ModeView>
     void setUpModePropertiesToolButtons(ModeView view);
 
@@ -56,29 +82,64 @@ class MainWindow final : public QMainWindow {
     void changeSceneState();
     void setStrokeColor();
     void setFillColor();
+    void setRasterBrush(bool isEnabled);
+    void showFlatteningReport(qsizetype itemsCount, qint64 reclaimedBytes);
+    void showSimilarSelectionReport(qsizetype itemsCount);
+    void openDocument();
+    void showLoadingProgress(qsizetype createdCount, qsizetype totalCount);
+    void finishDocumentLoading();
+    void reportDocumentLoadingError();
+    void saveDocument();
+    void finishDocumentSaving(bool isSaved);
+    void exportPdf(bool isSplitIntoPages);
+    void showExportProgress(qsizetype paintedCount, qsizetype totalCount);
+    void finishPdfExport(bool isExported);
+    void compareWithDocument();
+    void clearComparison();
+    void importBackground();
+    void finishBackgroundImport(const QString& imagePath, const QString& cachePath);
+    void setBroadcasting(bool isEnabled);
+    void setFollowing(bool isEnabled);
 
  private:
+    QList<std::function<ApplicationGraphicsView*(int)>> modeViewFactories_;
+    QList<ApplicationGraphicsView*> modeViews_;
     QList<DrawingGraphicsView*> drawingViewsList_;
     QList<QPushButton*> modeButtonsList_;
     QList<QAction*> modePropertiesActions_;
 
-    QGraphicsScene* graphicsScene_;
+    ApplicationGraphicsScene* graphicsScene_;
     QStackedWidget* stackedWidget_;
+    SceneNavigator* navigator_;
     QToolBar* toolBar_;
     QStatusBar* statusBar_;
 
     ModificationModeView* modificationModeView_;
+    BrushModeView* brushModeView_;
+
+    DocumentModel* documentModel_;
+    RenderCachePolicy* renderCachePolicy_;
+    DocumentLoader* documentLoader_;
+    SceneMirrorPublisher* mirrorPublisher_;
+    SceneMirrorFollower* mirrorFollower_;
+    QAction* broadcastAction_;
+    QAction* followAction_;
 
     QSpinBox* strokeWidthSpinBox_;
     QAction* fillColorAction_{};
     QAction* strokeColorAction_{};
     QAction* strokeWidthAction_{};
+    QAction* rasterBrushAction_{};
 
     QLabel* labelCursorPosX_;
     QLabel* labelCursorPosY_;
+    QProgressBar* loadingProgressBar_;
+    QProgressBar* exportProgressBar_;
+    DiffOverlayItem* diffOverlay_;
 
     QSize windowSize_;
     QSize graphicsViewsSize_;
+    int currentModeIndex_;
     bool isModified_;
 };
 
@@ -87,14 +148,30 @@ void MainWindow::connectViewsSignals(GraphicsViewType view, Signal signal) {
     connect(view, signal, this, &MainWindow::changeSceneState);
 }
 
+// Views are created on the first activation of their mode, only the button is added up front.
 template<typename GraphicsViewType>
 void MainWindow::setUpGraphicView(std::string_view iconPath) {
+    auto modeIndex = static_cast<int>(modeViewFactories_.size());
+    modeViewFactories_.push_back([this](int index) { return createGraphicView<GraphicsViewType>(index); });
+    modeViews_.push_back(nullptr);
+    if constexpr (!std::is_same_v<GraphicsViewType, ModificationModeView>) drawingViewsList_.push_back(nullptr);
+    addModeButtonsAndConnections(iconPath, modeIndex);
+}
+
+template<typename GraphicsViewType>
+GraphicsViewType* MainWindow::createGraphicView(int modeIndex) {
     auto* view = new GraphicsViewType{graphicsScene_, graphicsViewsSize_};
-    auto viewIndex = stackedWidget_->addWidget(view);
-    addModeButtonsAndConnections(iconPath, viewIndex);
+    stackedWidget_->addWidget(view);
     connectViewsSignals(view, &GraphicsViewType::changeStateOfScene);
-    if constexpr (!std::is_same_v<GraphicsViewType, ModificationModeView>) drawingViewsList_.push_back(view);
+    connectViewToStatusBar(view);
+    if constexpr (!std::is_same_v<GraphicsViewType, ModificationModeView>) drawingViewsList_[modeIndex - 1] = view;
     else modificationModeView_ = view;
+    if constexpr (std::is_same_v<GraphicsViewType, ModificationModeView>) {
+        connect(view, &GraphicsViewType::selectionFlattened, this, &MainWindow::showFlatteningReport);
+        connect(view, &GraphicsViewType::similarItemsSelected, this, &MainWindow::showSimilarSelectionReport);
+    }
+    if constexpr (std::is_same_v<GraphicsViewType, BrushModeView>) brushModeView_ = view;
+    return view;
 }
 
 void showPropertiesButtons(QAction* action, const QColor& color);
@@ -102,7 +179,12 @@ void showPropertiesButtons(QSpinBox* spinBox, QAction* action, int width);
 
 template<int PropertiesAmount, typename ModeView>
 void MainWindow::setUpModePropertiesToolButtons(ModeView view) {
-    if constexpr (PropertiesAmount == 3) {
+    if constexpr (PropertiesAmount == 1) {
+        showPropertiesButtons(fillColorAction_, view->getFillColor());
+        strokeColorAction_->setVisible(false);
+        strokeWidthAction_->setVisible(false);
+        return;
+    } else if constexpr (PropertiesAmount == 3) {
         showPropertiesButtons(fillColorAction_, view->getFillColor());
     } else if constexpr (PropertiesAmount == 2) {
         fillColorAction_->setVisible(false);
@@ -0,0 +1,112 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <optional>
+#include <variant>
+#include "scene-snapshot.h"
+
+enum class StackingMove;
+
+struct MirrorLayer {
+    quint64 id{0};
+    QString name;
+    bool isVisible{true};
+    bool isLocked{false};
+};
+
+struct MirrorItem {
+    quint64 id{0};
+    quint64 layerId{0};
+    ItemSnapshot snapshot;
+};
+
+struct MirrorItemTransform {
+    quint64 id{0};
+    QPointF position;
+    QPointF transformOrigin;
+    qreal rotation{0.0};
+    qreal scale{1.0};
+};
+
+// Layers are listed from the bottom one to the topmost one, items in their stacking order.
+struct ResetSceneOperation {
+    QList<MirrorLayer> layers;
+    QList<MirrorItem> items;
+};
+
+struct UpdateLayersOperation {
+    QList<MirrorLayer> layers;
+};
+
+struct CreateItemsOperation {
+    QList<MirrorItem> items;
+};
+
+struct MoveItemsOperation {
+    QList<quint64> ids;
+    QPointF delta;
+};
+
+struct TransformItemsOperation {
+    QList<MirrorItemTransform> transforms;
+};
+
+struct DeleteItemsOperation {
+    QList<quint64> ids;
+};
+
+// Followers replay the move on their items, which are in the same stacking order as those of the publisher.
+struct RestackItemsOperation {
+    QList<quint64> ids;
+    StackingMove move{};
+};
+
+using MirrorOperation = std::variant<ResetSceneOperation,
+                                     UpdateLayersOperation,
+                                     CreateItemsOperation,
+                                     MoveItemsOperation,
+                                     TransformItemsOperation,
+                                     DeleteItemsOperation,
+                                     RestackItemsOperation>;
+
+class MirrorEncoder {
+/*
+ Encodes batches of operations into length-prefixed messages. Ids are sent sorted as varint gaps,
+ and a move of the same items as the previous move does not repeat the ids at all, so continuous
+ dragging of a large group costs a few bytes per message. A move of no items stays empty on the other side.
+ One encoder serves exactly one connection.
+*/
+ public:
+    [[nodiscard]] QByteArray encode(const QList<MirrorOperation>& operations);
+
+ private:
+    QList<quint64> lastMovedIds_;
+};
+
+class MirrorDecoder {
+/*
+ The counterpart of MirrorEncoder, it accumulates received bytes and decodes complete messages.
+*/
+ public:
+    void append(const QByteArray& data);
+
+    // Operations of the next complete message, std::nullopt if it has not been received completely.
+    // A malformed message makes the decoder invalid, the connection should be dropped then.
+    [[nodiscard]] std::optional<QList<MirrorOperation>> takeMessage();
+    [[nodiscard]] bool isValid() const noexcept;
+
+ private:
+    QByteArray buffer_;
+    QList<quint64> lastMovedIds_;
+    bool isValid_{true};
+};
+
+namespace detail {
+    // Merges consecutive moves of the same items by summing deltas, transforms and layer updates by keeping
+    // the latest state. Ids of moves must be sorted. Returns false if `operation` can not be merged into `last`.
+    bool mergeMirrorOperation(MirrorOperation& last, const MirrorOperation& operation);
+}
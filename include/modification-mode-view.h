@@ -2,13 +2,22 @@
 
 #pragma once
 
+#include <QPolygonF>
 #include "graphics-view.h"
 
 class RotationInfo;
+class LassoInfo;
+enum class StackingMove;
 
 class ModificationModeView final : public ApplicationGraphicsView {
+    Q_OBJECT
+
  public:
-    ModificationModeView(QGraphicsScene* scene, QSize viewSize);
+    ModificationModeView(ApplicationGraphicsScene* scene, QSize viewSize);
+
+ signals:
+    void selectionFlattened(qsizetype itemsCount, qint64 reclaimedBytes);
+    void similarItemsSelected(qsizetype itemsCount);
 
  protected:
     void mousePressEvent(QMouseEvent* event) override;
@@ -18,11 +27,20 @@ class ModificationModeView final : public ApplicationGraphicsView {
 
  private:
     void setSelectionAreaProperties();
+    [[nodiscard]] QList<QGraphicsItem*> selectedItemsInStackingOrder() const;
+    void copySelectedItems();
+    void pasteItems();
+    void flattenSelectedItems();
+    void finishFlattening(const QList<QGraphicsItem*>& items, int jobId, const QImage& image,
+                          const QRectF& sceneRect, qreal scale, qint64 originalBytes);
     void updateItemsSelection(QMouseEvent* event, const QRectF& rect);
     void moveSelectedItems(const QPointF& mousePos);
+    void restackSelectedItems(StackingMove move);
     void rotateSelectedItems(QMouseEvent* event);
     void rotateItem(QMouseEvent *event, QGraphicsItem* item, qreal startAngle);
     void updateSelectionArea(QMouseEvent* event, const QPointF& mouseCurrentPos);
+    void startLasso(const QPointF& currentCursorPos);
+    void updateLasso(const QPointF& mouseCurrentPos);
     void handleMiddleButtonClick(QGraphicsItem* itemUnderCursor, const QPointF& currentCursorPos);
     void handleRightButtonClick(QMouseEvent* event, QGraphicsItem* itemUnderCursor);
     void handleLeftButtonClick(QMouseEvent* event,
@@ -31,9 +49,14 @@ class ModificationModeView final : public ApplicationGraphicsView {
 
  private:
     QGraphicsRectItem* selectionArea_;
+    QGraphicsPolygonItem* lassoArea_;
     std::unique_ptr<RotationInfo> rotationInfo_;
+    std::unique_ptr<LassoInfo> lassoInfo_;
+    QPolygonF lassoPoints_;
     QPointF selectionStartPos_;
     QPointF lastClickPos_;
     QPointF initialCursorPosA_;
+    int flattenJobsCount_;
     bool isMoving_;
+    bool isLassoSelection_;
 };
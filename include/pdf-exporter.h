@@ -0,0 +1,45 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QPageLayout>
+#include <QPageSize>
+#include <QString>
+#include <functional>
+#include "document-file.h"
+
+class QIODevice;
+
+struct PdfExportOptions {
+    QPageSize pageSize{QPageSize::A4};
+    QPageLayout::Orientation orientation{QPageLayout::Portrait};
+    // A split canvas is printed at its natural size across as many pages as needed, otherwise it is fitted into one.
+    bool isSplitIntoPages{false};
+    // Scene units per inch of the split canvas.
+    int resolution{96};
+};
+
+class PdfExporter {
+/*
+ Writes a DocumentSnapshot as vector PDF. Layers are painted from the bottom one to the topmost one and the items
+ of a layer in their stacking order, every page is written to the output device as soon as it is finished,
+ so only the content of the current page is held in memory. Pages take only the items which intersect them.
+ Works with a snapshot instead of the scene, so it can run on any thread.
+*/
+ public:
+    // Receives the number of items painted so far and the number of items to paint on all pages.
+    using ProgressCallback = std::function<void(qsizetype paintedCount, qsizetype totalCount)>;
+
+    explicit PdfExporter(PdfExportOptions options);
+
+    bool exportDocument(const DocumentSnapshot& document, QIODevice* device,
+                        const ProgressCallback& progress = {}) const;
+    bool exportDocument(const DocumentSnapshot& document, const QString& filePath,
+                        const ProgressCallback& progress = {}) const;
+
+    // Canvas parts printed on the pages, in the order of pages.
+    [[nodiscard]] QList<QRectF> pageRects(const QRectF& canvasRect) const;
+
+ private:
+    PdfExportOptions options_;
+};
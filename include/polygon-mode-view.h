@@ -2,11 +2,14 @@
 
 #pragma once
 
+#include <QGraphicsLineItem>
 #include "drawing-graphics-view.h"
+#include "preview-geometry-arena.h"
+#include "preview-item-pool.h"
 
 class PolygonModeView final : public DrawingGraphicsView {
  public:
-    PolygonModeView(QGraphicsScene* scene, QSize viewSize);
+    PolygonModeView(ApplicationGraphicsScene* scene, QSize viewSize);
 
  protected:
     void mousePressEvent(QMouseEvent* event) override;
@@ -16,7 +19,8 @@ class PolygonModeView final : public DrawingGraphicsView {
     void createPolygon();
     void deleteTemporaryLines();
 
-    QList<QPointF> points_;
+    PreviewItemPool<QGraphicsLineItem> linePool_;
+    PreviewGeometryArena points_;
     QList<QGraphicsLineItem*> lineItems_;
     QPointF lastClickPos_;
 };
@@ -0,0 +1,42 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QPointF>
+#include <QPolygonF>
+#include <vector>
+
+class PreviewGeometryArena {
+/*
+ Points of the shape being drawn, e.g. samples of a brush stroke or clicks of a polygon.
+ reset() drops the points but keeps the storage, which grows to the longest gesture and is reused by the next one,
+ so collecting geometry of a gesture does not allocate in steady state. Only the committed shape copies the points.
+*/
+ public:
+    void reset() noexcept {
+        points_.clear();
+    }
+
+    void append(const QPointF& point) {
+        points_.push_back(point);
+    }
+
+    [[nodiscard]] bool isEmpty() const noexcept {
+        return points_.empty();
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return points_.size();
+    }
+
+    [[nodiscard]] const QPointF& back() const noexcept {
+        return points_.back();
+    }
+
+    [[nodiscard]] QPolygonF toPolygon() const {
+        return QPolygonF{QList<QPointF>{points_.cbegin(), points_.cend()}};
+    }
+
+ private:
+    std::vector<QPointF> points_;
+};
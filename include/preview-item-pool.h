@@ -0,0 +1,60 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsScene>
+#include <vector>
+#include "graphics-items-detail.h"
+
+template<typename ItemType>
+class PreviewItemPool {
+/*
+ Temporary items showing a shape while it is being drawn. Released items are hidden but stay in the scene
+ and are handed out again by the next acquire() call, so interactive drawing neither allocates nor frees
+ scene items once the pool has grown to the size a drawing gesture needs.
+
+ Items stay owned by the scene. An acquired item which is not released (e.g. a committed shape)
+ simply leaves the pool.
+*/
+ public:
+    explicit PreviewItemPool(std::size_t maxIdleItems = kDefaultMaxIdleItems)
+        : maxIdleItems_(maxIdleItems) {}
+
+    ItemType* acquire(QGraphicsScene* scene) {
+        if (idleItems_.empty()) {
+            auto* item = new ItemType{};
+            scene->addItem(item);
+            return item;
+        }
+
+        ItemType* item = idleItems_.back();
+        idleItems_.pop_back();
+        item->show();
+        return item;
+    }
+
+    void release(ItemType* item) {
+        if (idleItems_.size() >= maxIdleItems_) {
+            detail::deleteItem(item->scene(), item);
+            return;
+        }
+
+        if (idleItems_.capacity() == 0) idleItems_.reserve(maxIdleItems_);
+        item->hide();
+        idleItems_.push_back(item);
+    }
+
+    template<typename Container>
+    void releaseAll(Container& items) {
+        for (auto* item : items) {
+            release(item);
+        }
+        items.clear();
+    }
+
+ private:
+    static constexpr std::size_t kDefaultMaxIdleItems{1024};
+
+    std::vector<ItemType*> idleItems_;
+    std::size_t maxIdleItems_;
+};
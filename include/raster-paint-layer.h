@@ -0,0 +1,42 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include <QHash>
+#include <QImage>
+
+class RasterPaintLayer final : public QGraphicsItem {
+/*
+ A raster surface covering the whole canvas, split into fixed-size tiles.
+ Tiles are allocated only when something is painted over them, and only the area touched by
+ a stamp is repainted, so memory depends on the painted area and each stamp costs the same
+ regardless of how many strokes were painted before.
+
+ The layer is transparent for hit-testing: it is never selected, moved or rotated as a shape.
+*/
+ public:
+    enum { Type = UserType + 1 };
+
+    explicit RasterPaintLayer(const QRectF& canvas, QGraphicsItem* parent = nullptr);
+
+    [[nodiscard]] int type() const override;
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
+    [[nodiscard]] bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    void stampDot(const QPointF& center, qreal diameter, const QColor& color);
+    void stampSegment(const QLineF& segment, const QPen& pen);
+
+    [[nodiscard]] qsizetype tileCount() const noexcept;
+    [[nodiscard]] qsizetype memoryUsage() const noexcept;
+
+ private:
+    template<typename PaintFunction>
+    void paintIntoTiles(const QRectF& dirtyRect, PaintFunction paintFunction);
+    QImage& tileAt(int column, int row);
+
+    QRectF canvas_;
+    QHash<quint64, QImage> tiles_;
+};
@@ -4,6 +4,8 @@
 
 #include <QMouseEvent>
 #include "drawing-graphics-view.h"
+#include "graphics-scene.h"
+#include "preview-item-pool.h"
 #include "graphics-items-detail.h"
 #include "rectangles-detail.h"
 #include "constants.h"
@@ -11,7 +13,7 @@
 template<typename ShapeType>
 class RectangleLikeShapeModeView final : public DrawingGraphicsView {
  public:
-    RectangleLikeShapeModeView(QGraphicsScene* scene, QSize viewSize);
+    RectangleLikeShapeModeView(ApplicationGraphicsScene* scene, QSize viewSize);
 
  protected:
     void mousePressEvent(QMouseEvent* event) override;
@@ -19,34 +21,27 @@ class RectangleLikeShapeModeView final : public DrawingGraphicsView {
     void mouseReleaseEvent(QMouseEvent* event) override;
 
  private:
+    PreviewItemPool<ShapeType> previewPool_;
     ShapeType* currentItem_;
     QPointF startCursorPos_;
 };
 
 template<typename ShapeType>
 RectangleLikeShapeModeView<ShapeType>::
-    RectangleLikeShapeModeView(QGraphicsScene* scene, QSize viewSize)
+    RectangleLikeShapeModeView(ApplicationGraphicsScene* scene, QSize viewSize)
             : DrawingGraphicsView(scene, viewSize),
               currentItem_(nullptr),
               startCursorPos_(constants::kZeroPointF) {}
 
 template<typename ShapeType>
 void RectangleLikeShapeModeView<ShapeType>::mousePressEvent(QMouseEvent* event) {
-    if (event->button() == Qt::LeftButton) {
+    if (event->button() == Qt::LeftButton && applicationScene()->isActiveLayerEditable()) {
         startCursorPos_ = mapToScene(event->pos());
 
-        QRectF rectangle{startCursorPos_, constants::kZeroSizeF};
-        QPen pen{strokeColor_, strokeWidth_, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin};
-        QBrush brush{fillColor_};
-
-        if constexpr (std::is_same_v<ShapeType, QGraphicsRectItem>) {
-            currentItem_ = scene()->addRect(rectangle, pen, brush);
-        } else if constexpr (std::is_same_v<ShapeType, QGraphicsEllipseItem>) {
-            currentItem_ = scene()->addEllipse(rectangle, pen, brush);
-        }
-
-        if (currentItem_ != nullptr)
-            detail::makeItemSelectableAndMovable(currentItem_);
+        currentItem_ = previewPool_.acquire(scene());
+        currentItem_->setRect(QRectF{startCursorPos_, constants::kZeroSizeF});
+        currentItem_->setPen(shapePen());
+        currentItem_->setBrush(fillBrush());
     }
 }
 
@@ -68,7 +63,10 @@ template<typename ShapeType>
 void RectangleLikeShapeModeView<ShapeType>::mouseReleaseEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton && currentItem_ != nullptr) {
         if (detail::shouldDeleteZeroSizeItem(currentItem_, startCursorPos_)) {
-            detail::deleteItem(scene(), currentItem_);
+            previewPool_.release(currentItem_);
+        } else {
+            detail::makeItemSelectableAndMovable(currentItem_);
+            applicationScene()->addItemToActiveLayer(currentItem_);
         }
         currentItem_ = nullptr;
     }
@@ -0,0 +1,88 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QObject>
+#include <QSet>
+#include <QTransform>
+#include <list>
+#include "item-grid.h"
+
+Q_DECLARE_LOGGING_CATEGORY(lcRenderCache)
+
+class QGraphicsItem;
+class ApplicationGraphicsScene;
+
+class RenderCachePolicy final : public QObject {
+/*
+ Chooses the cache mode of the scene items. Items with complex geometry (polygons, paths, brush strokes and Bézier
+ curves with many vertices) are painted into a device coordinate cache the first time they are on screen, unless
+ the cache would be too large for their size on screen, so a repaint of anything else blits their pixmaps instead
+ of rasterizing them again. The caches are kept under a memory budget (QT_PAINTER_RENDER_CACHE_BUDGET_MB,
+ in megabytes), the caches of the items painted least recently are dropped first. The candidates are kept
+ in an ItemGrid, so a painted frame visits only the items in the cells of the visible rect.
+
+ Caches are created and refreshed by frames painted at full quality only. A cache Qt repaints during a draft
+ frame keeps the draft quality, so such caches are dropped and painted anew once the full quality is restored.
+
+ Qt does not tell whether a cached item was painted from its cache, so a frame counts a hit for a cached item
+ painted at the same view scale and not transformed since, and a miss otherwise. Hits, misses, evictions and
+ the memory used are reported to the "qt_painter.render_cache" logging category every few seconds.
+*/
+    Q_OBJECT
+
+ public:
+    explicit RenderCachePolicy(ApplicationGraphicsScene* scene, QObject* parent = nullptr);
+
+    // Must be called after a view painted `visibleRect` of the scene with `viewTransform`.
+    void notePaintedFrame(const QRectF& visibleRect, const QTransform& viewTransform, bool isDraft);
+    // Must be called when a view switches from draft to full quality rendering, before it is repainted.
+    void refreshDraftCaches();
+
+    [[nodiscard]] qint64 budgetBytes() const noexcept;
+    [[nodiscard]] qint64 usedBytes() const noexcept;
+    [[nodiscard]] qsizetype cachedItemsCount() const noexcept;
+
+ private slots:
+    void addItems(const QList<QGraphicsItem*>& items);
+    void moveItems(const QList<QGraphicsItem*>& items);
+    void invalidateItems(const QList<QGraphicsItem*>& items);
+    void removeItems(const QList<QGraphicsItem*>& items);
+
+ private:
+    struct CandidateItem {
+        qsizetype complexity;
+        qint64 cacheBytes;
+        QTransform cacheTransform;
+        bool isCached;
+        bool isCacheValid;
+        quint64 paintedFrame;
+        std::list<QGraphicsItem*>::iterator recentPosition;
+    };
+
+    void noteVisibleItem(QGraphicsItem* item, CandidateItem& candidate, const QTransform& viewTransform,
+                         bool isDraft);
+
+    void cacheItem(QGraphicsItem* item, CandidateItem& candidate, const QTransform& viewTransform, qint64 bytes);
+    void uncacheItem(QGraphicsItem* item, CandidateItem& candidate);
+    void evictLeastRecentlyPainted();
+    void reportStatistics();
+
+    ApplicationGraphicsScene* scene_;
+    QHash<QGraphicsItem*, CandidateItem> candidates_;
+    ItemGrid candidatesGrid_;
+    // Cached items whose caches were painted by a draft frame.
+    QSet<QGraphicsItem*> draftCaches_;
+    // Cached items, the most recently painted one first.
+    std::list<QGraphicsItem*> recentlyPainted_;
+    qint64 budgetBytes_;
+    qint64 usedBytes_;
+    quint64 frame_;
+    qint64 hitsCount_;
+    qint64 missesCount_;
+    qint64 evictionsCount_;
+    QElapsedTimer reportTimer_;
+};
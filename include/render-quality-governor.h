@@ -0,0 +1,41 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QObject>
+
+QT_BEGIN_NAMESPACE
+class QGraphicsView;
+class QTimer;
+QT_END_NAMESPACE
+
+class RenderQualityGovernor final : public QObject {
+/*
+ Switches a view to draft rendering while the user drags, rotates, selects with a rubber band or zooms.
+ Draft frames are painted without antialiasing and smooth pixmap transformation, items may paint
+ simplified geometry then. Once there was no interaction for the settle interval, the view is repainted
+ at full quality. Slow frames alone do not switch to draft: most of them are partial updates, e.g. while
+ a large document is loaded, and changing the render hints would repaint the whole viewport instead.
+*/
+    Q_OBJECT
+
+ public:
+    explicit RenderQualityGovernor(QGraphicsView* view);
+
+    void noteInteraction();
+
+    [[nodiscard]] bool isDraft() const noexcept;
+
+ signals:
+    void fullQualityRestored();
+
+ private slots:
+    void restoreFullQuality();
+
+ private:
+    void setDraft(bool isDraft);
+
+    QGraphicsView* view_;
+    QTimer* settleTimer_;
+    bool isDraft_;
+};
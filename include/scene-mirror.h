@@ -0,0 +1,101 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <vector>
+#include "mirror-protocol.h"
+
+QT_BEGIN_NAMESPACE
+class QGraphicsItem;
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+QT_END_NAMESPACE
+
+class ApplicationGraphicsScene;
+class LayerItem;
+
+class SceneMirrorPublisher final : public QObject {
+/*
+ Broadcasts changes of the scene to followers connected to a local server. A new follower receives
+ the whole scene first and then only operations. Operations are collected and sent as one message
+ per flush interval, merging consecutive moves of the same items and repeated transforms beforehand.
+ Items and layers are identified by ids kept in QGraphicsItem::data().
+*/
+    Q_OBJECT
+
+ public:
+    explicit SceneMirrorPublisher(ApplicationGraphicsScene* scene, QObject* parent = nullptr);
+    ~SceneMirrorPublisher() override;
+
+    bool listen(const QString& serverName);
+
+ private slots:
+    void acceptConnections();
+    void publishAddedItems(const QList<QGraphicsItem*>& items);
+    void publishMovedItems(const QList<QGraphicsItem*>& items, const QPointF& delta);
+    void publishTransformedItems(const QList<QGraphicsItem*>& items);
+    void publishDeletedItems(const QList<QGraphicsItem*>& items);
+    void publishRestackedItems(const QList<QGraphicsItem*>& items, StackingMove move);
+    void publishLayers();
+    void flush();
+
+ private:
+    struct Connection {
+        QLocalSocket* socket;
+        MirrorEncoder encoder;
+    };
+
+    void enqueue(MirrorOperation operation);
+    [[nodiscard]] bool hasConnections() const noexcept;
+    [[nodiscard]] quint64 itemId(QGraphicsItem* item);
+    [[nodiscard]] MirrorItem takeMirrorItem(QGraphicsItem* item);
+    [[nodiscard]] QList<MirrorLayer> takeLayers();
+    [[nodiscard]] ResetSceneOperation takeScene();
+
+    ApplicationGraphicsScene* scene_;
+    QLocalServer* server_;
+    QTimer* flushTimer_;
+    std::vector<Connection> connections_;
+    QList<MirrorOperation> pendingOperations_;
+    quint64 lastId_;
+};
+
+class SceneMirrorFollower final : public QObject {
+/*
+ Connects to a publisher and applies received operations to the scene incrementally.
+*/
+    Q_OBJECT
+
+ public:
+    explicit SceneMirrorFollower(ApplicationGraphicsScene* scene, QObject* parent = nullptr);
+
+    void connectToPublisher(const QString& serverName);
+
+ signals:
+    void disconnected();
+
+ private slots:
+    void readMessages();
+    void forgetItems(const QList<QGraphicsItem*>& items);
+    void forgetRemovedLayers();
+
+ private:
+    void apply(const MirrorOperation& operation);
+    void resetScene(const ResetSceneOperation& reset);
+    void updateLayers(const QList<MirrorLayer>& layers);
+    void createItems(const QList<MirrorItem>& items);
+    void moveItems(const MoveItemsOperation& move);
+    void transformItems(const QList<MirrorItemTransform>& transforms);
+    void deleteItems(const QList<quint64>& ids);
+    void restackItems(const RestackItemsOperation& restack);
+    [[nodiscard]] QList<QGraphicsItem*> findItems(const QList<quint64>& ids) const;
+
+    ApplicationGraphicsScene* scene_;
+    QLocalSocket* socket_;
+    MirrorDecoder decoder_;
+    QHash<quint64, QGraphicsItem*> items_;
+    QHash<quint64, LayerItem*> layers_;
+};
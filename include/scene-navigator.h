@@ -0,0 +1,64 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QImage>
+#include <QPointer>
+#include <QRegion>
+#include <QWidget>
+#include "scene-snapshot.h"
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+class ApplicationGraphicsScene;
+class ApplicationGraphicsView;
+
+class SceneNavigator final : public QWidget {
+/*
+ A thumbnail of the whole canvas with the area visible in the active view outlined.
+ Regions where the scene reports changed layer items are collected and only they are re-rendered: shapes
+ of visible layers over them are looked up in the item grid of the scene, taken as snapshots and painted into
+ patches on a worker thread, which are then put into the thumbnail. One rendering is in progress at a time,
+ regions changed meanwhile wait for the next one.
+ Clicking and dragging over the thumbnail centers the active view on the point under the cursor.
+*/
+    Q_OBJECT
+
+ public:
+    SceneNavigator(ApplicationGraphicsScene* scene, const QRectF& canvas, QWidget* parent = nullptr);
+    ~SceneNavigator() override = default;
+
+    void setView(ApplicationGraphicsView* view);
+
+    [[nodiscard]] QSize sizeHint() const override;
+
+ protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+ private slots:
+    void markDirty(const QList<QRectF>& region);
+    void renderDirtyRegion();
+
+ private:
+    struct Patch {
+        QRect pixelRect;
+        QImage image;
+    };
+
+    void applyPatches(const QList<Patch>& patches);
+    [[nodiscard]] QList<ItemSnapshot> takeVisibleItems(const QRectF& sceneRect) const;
+    void centerViewOn(const QPointF& widgetPosition);
+
+    ApplicationGraphicsScene* scene_;
+    QPointer<ApplicationGraphicsView> view_;
+    QRectF canvas_;
+    qreal scale_;
+    QImage thumbnail_;
+    QRegion dirtyRegion_;
+    QTimer* renderTimer_;
+    bool isRendering_;
+};
@@ -0,0 +1,65 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QBrush>
+#include <QImage>
+#include <QLineF>
+#include <QList>
+#include <QPainterPath>
+#include <QPen>
+#include <QPolygonF>
+#include <QRectF>
+#include <QTransform>
+#include <variant>
+
+class QDataStream;
+class QGraphicsItem;
+class QPainter;
+
+// Geometry of rectangles and ellipses, lines, polygons, paths and pixmaps in item coordinates.
+using ItemGeometry = std::variant<QRectF, QLineF, QPolygonF, QPainterPath, QImage>;
+
+struct ItemSnapshot {
+/*
+ A plain copy of a scene item which does not refer to the item itself.
+ Every member is implicitly shared or trivially copyable, so snapshots are cheap to take on the GUI thread
+ and safe to read from worker threads while the scene keeps changing.
+*/
+    int type{0};
+    ItemGeometry geometry;
+    QPen pen;
+    QBrush brush;
+    QPointF position;
+    QPointF transformOrigin;
+    qreal rotation{0.0};
+    qreal scale{1.0};
+
+    [[nodiscard]] QTransform sceneTransform() const;
+    [[nodiscard]] QRectF boundingRect() const;
+    [[nodiscard]] QRectF sceneBoundingRect() const;
+};
+
+QDataStream& operator<<(QDataStream& stream, const ItemSnapshot& item);
+QDataStream& operator>>(QDataStream& stream, ItemSnapshot& item);
+
+namespace detail {
+    // Parts of the streamed item, which let the style be written separately, e.g. once per document in a style table.
+    void writeItemGeometry(QDataStream& stream, const ItemSnapshot& item);
+    bool readItemGeometry(QDataStream& stream, ItemSnapshot& item);
+    void writeItemPlacement(QDataStream& stream, const ItemSnapshot& item);
+    void readItemPlacement(QDataStream& stream, ItemSnapshot& item);
+
+    [[nodiscard]] bool isSnapshotSupported(const QGraphicsItem* item);
+    [[nodiscard]] ItemSnapshot takeItemSnapshot(const QGraphicsItem* item);
+    [[nodiscard]] QList<ItemSnapshot> takeItemsSnapshot(const QList<QGraphicsItem*>& items);
+
+    // Creates a selectable and movable item without a scene, must be called from the GUI thread.
+    [[nodiscard]] QGraphicsItem* createItemFromSnapshot(const ItemSnapshot& item);
+
+    void paintItemSnapshot(QPainter& painter, const ItemSnapshot& item);
+    [[nodiscard]] QImage renderItemsSnapshot(const QList<ItemSnapshot>& items, const QRectF& sceneRect, qreal scale);
+
+    // A rough estimation of memory held by a scene item built from the snapshot, including the item itself.
+    [[nodiscard]] qint64 estimateMemoryUsage(const ItemSnapshot& item) noexcept;
+}
@@ -0,0 +1,19 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QPainterPath>
+#include <QPolygonF>
+
+struct ItemSnapshot;
+
+namespace detail {
+    // Douglas-Peucker simplification, the first and the last points are always kept.
+    [[nodiscard]] QPolygonF simplifyPolyline(const QPolygonF& polyline, qreal tolerance);
+
+    // Simplifies paths made of straight segments only, paths with curves are returned unchanged.
+    // With `joinSubpaths` a subpath starting where the previous one ends is merged into it, as brush strokes are.
+    [[nodiscard]] QPainterPath simplifyPath(const QPainterPath& path, qreal tolerance, bool joinSubpaths);
+
+    void simplifyItemSnapshot(ItemSnapshot& item, qreal tolerance);
+}
@@ -0,0 +1,37 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <string_view>
+
+Q_DECLARE_LOGGING_CATEGORY(lcStartup)
+
+class StartupTimer {
+/*
+ Measures the cold start of the application: the time from the process start to the first paint of the canvas.
+ The time the user spends in the welcome dialog is excluded, so the total can be held against a fixed budget.
+ Phases and the total are reported to the "qt_painter.startup" logging category, exceeding the budget
+ (QT_PAINTER_STARTUP_BUDGET_MS, in milliseconds) is reported as a warning.
+*/
+ public:
+    static StartupTimer& instance();
+
+    void start();
+    void suspend();
+    void resume();
+    void markPhase(std::string_view phase);
+    void finish();
+
+    [[nodiscard]] qint64 elapsedMs() const noexcept;
+    [[nodiscard]] bool isFinished() const noexcept;
+
+ private:
+    StartupTimer();
+
+    QElapsedTimer timer_;
+    qint64 suspendedMs_;
+    qint64 suspendStartMs_;
+    bool isFinished_;
+};
@@ -0,0 +1,48 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QByteArray>
+#include <QGraphicsItem>
+#include <QPen>
+#include <QPolygonF>
+
+class StrokeItem final : public QGraphicsItem {
+/*
+ A freehand stroke of the brush, painted as a polyline with the pen.
+ Points are kept in fixed point (1/16 of a pixel) as variable-length differences between neighbouring points.
+ Mouse samples are a few pixels apart, so a coordinate usually takes 1 or 2 bytes and a point 2 to 4 bytes,
+ instead of 16 bytes of QPointF or 48 bytes of the move and line elements of a QPainterPath segment.
+ Points are decoded on the fly for painting and hit-testing.
+*/
+ public:
+    enum { Type = UserType + 3 };
+
+    explicit StrokeItem(const QPolygonF& points, QGraphicsItem* parent = nullptr);
+
+    [[nodiscard]] int type() const override;
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
+    [[nodiscard]] bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    [[nodiscard]] QPen pen() const;
+    void setPen(const QPen& pen);
+
+    [[nodiscard]] QPolygonF points() const;
+    [[nodiscard]] qsizetype pointsCount() const noexcept;
+    [[nodiscard]] qsizetype encodedSize() const noexcept;
+
+    // Rough size of encoded points of a stroke, for memory estimations without encoding.
+    [[nodiscard]] static qsizetype estimateEncodedSize(qsizetype pointsCount) noexcept;
+
+ private:
+    void decodePoints(QPolygonF& points) const;
+    void updateBoundingRect();
+
+    QByteArray encodedPoints_;
+    qsizetype pointsCount_;
+    QRectF pointsRect_;
+    QRectF boundingRect_;
+    QPen pen_;
+};
@@ -0,0 +1,57 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QBrush>
+#include <QHash>
+#include <QPen>
+#include <optional>
+
+namespace detail {
+
+    // Identifies a solid color pen or brush by all of its properties which affect painting.
+    // Gradients, textures and custom dash patterns have no key.
+    struct StyleKey {
+        quint64 color{0};
+        qreal width{0.0};
+        qreal miterLimit{0.0};
+        qreal dashOffset{0.0};
+        int style{0};
+        int capStyle{0};
+        int joinStyle{0};
+        bool isCosmetic{false};
+
+        bool operator==(const StyleKey& other) const noexcept {
+            return color == other.color && width == other.width && miterLimit == other.miterLimit &&
+                   dashOffset == other.dashOffset && style == other.style && capStyle == other.capStyle &&
+                   joinStyle == other.joinStyle && isCosmetic == other.isCosmetic;
+        }
+    };
+
+    [[nodiscard]] size_t qHash(const StyleKey& key, size_t seed = 0) noexcept;
+
+    [[nodiscard]] std::optional<StyleKey> penStyleKey(const QPen& pen);
+    [[nodiscard]] std::optional<StyleKey> brushStyleKey(const QBrush& brush);
+
+}  // namespace detail
+
+class StyleRegistry {
+/*
+ Interns pens and brushes of the scene items. Equal styles are returned as the same implicitly shared QPen or QBrush,
+ so the items of a drawing, which usually uses a handful of styles, reference a few style objects instead of
+ keeping a copy each. Styles without a key are returned as they are. Must be used from the GUI thread.
+*/
+ public:
+    static StyleRegistry& instance();
+
+    [[nodiscard]] QPen pen(const QPen& pen);
+    [[nodiscard]] QBrush brush(const QBrush& brush);
+
+    [[nodiscard]] qsizetype size() const noexcept;
+
+ private:
+    StyleRegistry() = default;
+
+    QHash<detail::StyleKey, QPen> pens_;
+    QHash<detail::StyleKey, QBrush> brushes_;
+};
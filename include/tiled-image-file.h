@@ -0,0 +1,45 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QFile>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <vector>
+
+class TiledImageFile {
+/*
+ A large image decoded once into a cache file of fixed-size tiles at several resolution levels, each level
+ half the size of the previous one, until the whole image fits into a tile. Tiles are stored uncompressed at
+ fixed offsets and the file is memory-mapped, so a tile is a QImage over the mapped memory: the system pages
+ in only the tiles which are painted and drops them under memory pressure, the image itself is never loaded.
+*/
+ public:
+    TiledImageFile() = default;
+    TiledImageFile(const TiledImageFile&) = delete;
+    TiledImageFile& operator=(const TiledImageFile&) = delete;
+    ~TiledImageFile();
+
+    // Decodes the image into the cache file unless a valid one is already there. Can be called from any thread.
+    static bool build(const QString& imagePath, const QString& cachePath);
+    // A file in the cache directory of the application, which changes when the image file changes.
+    [[nodiscard]] static QString cachePathFor(const QString& imagePath);
+
+    bool open(const QString& cachePath);
+
+    [[nodiscard]] QSize size() const noexcept;
+    [[nodiscard]] int levelsCount() const noexcept;
+    [[nodiscard]] QSize tilesCount(int level) const noexcept;
+    // Tiles of the edges are padded with transparent pixels to the full tile size.
+    [[nodiscard]] QImage tile(int level, int column, int row) const;
+
+    static constexpr int kTileSize{256};
+
+ private:
+    QFile file_;
+    const uchar* data_{nullptr};
+    QSize size_;
+    std::vector<QSize> tilesCounts_;
+    std::vector<qint64> levelOffsets_;
+};
@@ -0,0 +1,36 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#pragma once
+
+#include <QGraphicsItem>
+#include <memory>
+#include "tiled-image-file.h"
+
+class TiledImageItem final : public QGraphicsItem {
+/*
+ A large background image painted from a memory-mapped TiledImageFile, one pixel per item unit.
+ fitInto() scales the item down so the whole image fits the canvas. Only the tiles intersecting the exposed area
+ are painted, at the coarsest resolution level which is still at least as detailed as the item scale combined
+ with the view scale, so a fitted image touches a few tiles of a small level.
+
+ The image is transparent for hit-testing, like the raster surface of a layer.
+*/
+ public:
+    enum { Type = UserType + 4 };
+
+    explicit TiledImageItem(std::unique_ptr<TiledImageFile> file, QGraphicsItem* parent = nullptr);
+
+    [[nodiscard]] int type() const override;
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
+    [[nodiscard]] bool contains(const QPointF& point) const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    // Scales the image down, never up, to fit `canvasRect` and places it at the top left corner of the canvas.
+    void fitInto(const QRectF& canvasRect);
+    // The resolution level painted with the transformation from the item to the device.
+    [[nodiscard]] int levelFor(const QTransform& worldTransform) const;
+
+ private:
+    std::unique_ptr<TiledImageFile> file_;
+};
@@ -3,15 +3,29 @@
 #include <QApplication>
 #include "./include/main-window.h"
 #include "./include/welcome-dialog.h"
+#include "./include/startup-timer.h"
+#include "./include/batch-converter.h"
 
 int main(int argc, char *argv[]) {
+    if (detail::isBatchModeRequested(argc, argv)) {
+        // The batch mode runs on servers without a display.
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+        QGuiApplication application(argc, argv);
+        return detail::runBatchMode(QGuiApplication::arguments());
+    }
+
+    StartupTimer::instance().start();
     QApplication a(argc, argv);
-    WelcomeDialog dialog;
+    StartupTimer::instance().markPhase("application created");
 
+    WelcomeDialog dialog;
+    StartupTimer::instance().suspend();
     if (dialog.exec() != QDialog::Accepted) return 0;
+    StartupTimer::instance().resume();
     QSize viewSize{dialog.getViewSize()};
 
     MainWindow w{viewSize};
+    StartupTimer::instance().markPhase("main window created");
     w.show();
 
     return QApplication::exec();
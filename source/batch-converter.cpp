@@ -0,0 +1,229 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QGraphicsPixmapItem>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+#include "../include/batch-converter.h"
+#include "../include/pdf-exporter.h"
+#include "../include/simplification-detail.h"
+
+namespace {
+    using std::operator ""sv;
+
+    constexpr auto kBatchOptionName{"batch"sv};
+    constexpr auto kBatchArgument{"--batch"sv};
+    constexpr auto kPngFormatName{"png"sv};
+    constexpr auto kSvgFormatName{"svg"sv};
+    constexpr auto kPdfFormatName{"pdf"sv};
+    constexpr auto kSimplifyOperationName{"simplify"sv};
+    constexpr auto kFlattenOperationName{"flatten"sv};
+    constexpr auto kLoadingError{"can not read the document"sv};
+    constexpr auto kExportError{"can not write the output file"sv};
+
+    constexpr Qt::GlobalColor kExportBackgroundColor{Qt::white};
+
+    QString toString(std::string_view view) {
+        return QString::fromLatin1(view.data(), static_cast<qsizetype>(view.size()));
+    }
+
+    void paintDocument(QPainter& painter, const DocumentSnapshot& document) {
+        painter.fillRect(document.canvasRect, kExportBackgroundColor);
+        for (const auto& layer : document.layers) {
+            if (!layer.isVisible) continue;
+            for (const auto& item : layer.items) {
+                detail::paintItemSnapshot(painter, item);
+            }
+        }
+    }
+
+    void flattenLayer(LayerSnapshot& layer, const QRectF& canvasRect, qreal scale) {
+        if (layer.items.size() <= 1) return;
+
+        ItemSnapshot flattened;
+        flattened.type = QGraphicsPixmapItem::Type;
+        flattened.geometry = detail::renderItemsSnapshot(layer.items, canvasRect, scale);
+        flattened.pen = QPen{Qt::NoPen};
+        flattened.position = canvasRect.topLeft();
+        flattened.scale = 1.0 / scale;
+        layer.items = {flattened};
+    }
+}  // namespace
+
+BatchConverter::BatchConverter(BatchOptions options)
+    : options_(std::move(options)) {}
+
+QList<BatchFileResult> BatchConverter::run() const {
+    std::vector<BatchFileResult> results(static_cast<std::size_t>(options_.inputFiles.size()));
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(options_.jobsCount > 0 ? options_.jobsCount : QThread::idealThreadCount());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const QString& inputFile = options_.inputFiles[static_cast<qsizetype>(i)];
+        threadPool.start([this, &results, &inputFile, i]() { results[i] = convertFile(inputFile); });
+    }
+    threadPool.waitForDone();
+
+    return QList<BatchFileResult>(results.begin(), results.end());
+}
+
+BatchFileResult BatchConverter::convertFile(const QString& inputFile) const {
+    QElapsedTimer timer;
+    timer.start();
+    BatchFileResult result{inputFile, makeOutputFilePath(inputFile), {}, 0};
+
+    if (auto document = detail::loadDocument(inputFile)) {
+        applyOperations(*document);
+        if (!exportDocument(*document, result.outputFile)) result.error = toString(kExportError);
+    } else {
+        result.error = toString(kLoadingError);
+    }
+
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+void BatchConverter::applyOperations(DocumentSnapshot& document) const {
+    for (auto operation : options_.operations) {
+        for (auto& layer : document.layers) {
+            if (operation == BatchOperation::kFlatten) {
+                flattenLayer(layer, document.canvasRect, options_.scale);
+                continue;
+            }
+            for (auto& item : layer.items) {
+                detail::simplifyItemSnapshot(item, options_.simplifyTolerance);
+            }
+        }
+    }
+}
+
+bool BatchConverter::exportDocument(const DocumentSnapshot& document, const QString& outputFile) const {
+    const QRectF& canvasRect = document.canvasRect;
+
+    if (options_.format == ExportFormat::kSvg) {
+        QSvgGenerator generator;
+        generator.setFileName(outputFile);
+        generator.setSize(canvasRect.size().toSize());
+        generator.setViewBox(canvasRect);
+        generator.setTitle(QFileInfo{outputFile}.completeBaseName());
+
+        QPainter painter;
+        if (!painter.begin(&generator)) return false;
+        painter.setRenderHint(QPainter::Antialiasing);
+        paintDocument(painter, document);
+        return painter.end();
+    }
+
+    if (options_.format == ExportFormat::kPdf) {
+        return PdfExporter{PdfExportOptions{}}.exportDocument(document, outputFile);
+    }
+
+    QImage image{(canvasRect.size() * options_.scale).toSize(), QImage::Format_ARGB32_Premultiplied};
+    if (image.isNull()) return false;
+
+    QPainter painter{&image};
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(options_.scale, options_.scale);
+    painter.translate(-canvasRect.topLeft());
+    paintDocument(painter, document);
+    painter.end();
+    return image.save(outputFile);
+}
+
+QString BatchConverter::makeOutputFilePath(const QString& inputFile) const {
+    auto extension = kPngFormatName;
+    if (options_.format == ExportFormat::kSvg) extension = kSvgFormatName;
+    else if (options_.format == ExportFormat::kPdf) extension = kPdfFormatName;
+    QString fileName = QFileInfo{inputFile}.completeBaseName() + '.' + toString(extension);
+    return QDir{options_.outputDirectory}.filePath(fileName);
+}
+
+namespace detail {
+
+    bool isBatchModeRequested(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+            if (argv[i] == kBatchArgument) return true;
+        }
+        return false;
+    }
+
+    int runBatchMode(const QStringList& arguments) {
+        QTextStream output{stdout};
+        QTextStream errors{stderr};
+
+        QCommandLineParser parser;
+        parser.setApplicationDescription("Converts drawings to PNG, SVG or PDF files without showing the window.");
+        parser.addHelpOption();
+        parser.addPositionalArgument("files", "Documents to convert.", "files...");
+        QCommandLineOption batchOption{toString(kBatchOptionName), "Run the batch conversion."};
+        QCommandLineOption outputOption{{"o", "output-dir"}, "Directory for converted files.", "directory", "."};
+        QCommandLineOption formatOption{{"f", "format"}, "Output format: png, svg or pdf.", "format", toString(kPngFormatName)};
+        QCommandLineOption operationOption{"operation", "Operation applied before export: simplify or flatten. "
+                                                        "Can be repeated, operations run in the given order.", "name"};
+        QCommandLineOption toleranceOption{"tolerance", "Maximal deviation of simplified shapes.", "pixels", "0.5"};
+        QCommandLineOption scaleOption{"scale", "Pixels per scene unit of PNG files and flattened layers.", "factor", "1"};
+        QCommandLineOption jobsOption{{"j", "jobs"}, "Number of files converted concurrently.", "count", "0"};
+        parser.addOptions({batchOption, outputOption, formatOption, operationOption, toleranceOption, scaleOption, jobsOption});
+        parser.process(arguments);
+
+        BatchOptions options;
+        options.inputFiles = parser.positionalArguments();
+        options.outputDirectory = parser.value(outputOption);
+        options.simplifyTolerance = parser.value(toleranceOption).toDouble();
+        options.scale = parser.value(scaleOption).toDouble();
+        options.jobsCount = parser.value(jobsOption).toInt();
+
+        QString format = parser.value(formatOption).toLower();
+        if (format == toString(kSvgFormatName)) {
+            options.format = ExportFormat::kSvg;
+        } else if (format == toString(kPdfFormatName)) {
+            options.format = ExportFormat::kPdf;
+        } else if (format != toString(kPngFormatName)) {
+            errors << "Unknown format: " << format << Qt::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (const auto& operation : parser.values(operationOption)) {
+            if (operation == toString(kSimplifyOperationName)) {
+                options.operations.push_back(BatchOperation::kSimplify);
+            } else if (operation == toString(kFlattenOperationName)) {
+                options.operations.push_back(BatchOperation::kFlatten);
+            } else {
+                errors << "Unknown operation: " << operation << Qt::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (options.inputFiles.isEmpty() || options.scale <= 0.0 || !QDir{}.mkpath(options.outputDirectory)) {
+            parser.showHelp(EXIT_FAILURE);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        auto results = BatchConverter{options}.run();
+
+        qsizetype convertedCount = 0;
+        for (const auto& result : results) {
+            if (result.error.isEmpty()) {
+                output << result.inputFile << " -> " << result.outputFile << ": " << result.elapsedMs << " ms" << Qt::endl;
+                ++convertedCount;
+            } else {
+                errors << result.inputFile << ": " << result.error << Qt::endl;
+            }
+        }
+        output << "Converted " << convertedCount << " of " << results.size() << " files in " << timer.elapsed() << " ms"
+               << Qt::endl;
+
+        return convertedCount == results.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+}  // namespace detail
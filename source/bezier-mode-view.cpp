@@ -0,0 +1,75 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QMouseEvent>
+#include "../include/bezier-mode-view.h"
+#include "../include/bezier-path-item.h"
+#include "../include/graphics-scene.h"
+#include "../include/graphics-items-detail.h"
+
+BezierModeView::BezierModeView(ApplicationGraphicsScene* scene, QSize viewSize)
+    : DrawingGraphicsView(scene, viewSize),
+      currentItem_(nullptr),
+      isPlacingHandle_(false) {}
+
+void BezierModeView::mousePressEvent(QMouseEvent* event) {
+    if (!applicationScene()->isActiveLayerEditable()) return;
+
+    if (event->button() == Qt::LeftButton) {
+        addAnchor(mapToScene(event->pos()));
+    } else if (event->button() == Qt::RightButton && currentItem_ != nullptr) {
+        finishCurve();
+        emit changeStateOfScene();
+    }
+}
+
+void BezierModeView::mouseMoveEvent(QMouseEvent* event) {
+    QPointF currentCursorPos = mapToScene(event->pos());
+    emit cursorPositionChanged(currentCursorPos);
+    if (currentItem_ == nullptr) return;
+
+    // Only the last segment changes, so only it is flattened again however long the curve is.
+    if (isPlacingHandle_) {
+        handle_ = currentCursorPos;
+        QPointF mirroredHandle = 2.0 * anchor_ - currentCursorPos;
+        currentItem_->setLastSegment(previousHandle_, mirroredHandle, anchor_);
+    } else {
+        currentItem_->setLastSegment(handle_, currentCursorPos, currentCursorPos);
+    }
+}
+
+void BezierModeView::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton || !isPlacingHandle_) return;
+    isPlacingHandle_ = false;
+
+    // The previewed segment follows the cursor until the next anchor is added.
+    QPointF currentCursorPos = mapToScene(event->pos());
+    currentItem_->appendSegment(handle_, currentCursorPos, currentCursorPos);
+}
+
+void BezierModeView::addAnchor(const QPointF& position) {
+    if (currentItem_ == nullptr) {
+        currentItem_ = new BezierPathItem{QPolygonF{{position}}};
+        currentItem_->setPen(shapePen());
+        scene()->addItem(currentItem_);
+    } else {
+        previousHandle_ = handle_;
+        currentItem_->setLastSegment(previousHandle_, position, position);
+    }
+    anchor_ = position;
+    handle_ = position;
+    isPlacingHandle_ = true;
+}
+
+void BezierModeView::finishCurve() {
+    // The previewed segment is not a part of the curve.
+    if (!isPlacingHandle_) currentItem_->removeLastSegment();
+    isPlacingHandle_ = false;
+
+    if (currentItem_->segmentsCount() == 0) {
+        detail::deleteItem(scene(), currentItem_);
+    } else {
+        detail::makeItemSelectableAndMovable(currentItem_);
+        applicationScene()->addItemToActiveLayer(currentItem_);
+    }
+    currentItem_ = nullptr;
+}
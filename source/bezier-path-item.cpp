@@ -0,0 +1,257 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainter>
+#include <QPainterPathStroker>
+#include <QStyle>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../include/bezier-path-item.h"
+
+namespace {
+    // Largest distance between a segment and its polyline in device pixels.
+    constexpr qreal kFlatteningTolerance{0.25};
+    constexpr int kNotFlattened{std::numeric_limits<int>::min()};
+    // Levels of detail are powers of two, the finest and the coarsest ones cover zooming by 256 times both ways.
+    constexpr int kMaxLevel{8};
+    constexpr int kMaxSubdivisionDepth{16};
+    constexpr qsizetype kPointsPerSegment{3};
+
+    qreal distanceToSegment(const QPointF& point, const QPointF& start, const QPointF& end) noexcept {
+        QPointF direction = end - start;
+        qreal lengthSquared = QPointF::dotProduct(direction, direction);
+        qreal t = lengthSquared > 0.0 ? QPointF::dotProduct(point - start, direction) / lengthSquared : 0.0;
+        QPointF closest = start + direction * std::clamp(t, 0.0, 1.0);
+        return std::hypot(point.x() - closest.x(), point.y() - closest.y());
+    }
+
+    // Appends the points of the segment after its start, splitting it in halves until both control points
+    // are within the tolerance from the chord.
+    void flattenCubic(const QPointF& start, const QPointF& firstControl, const QPointF& secondControl,
+                      const QPointF& end, qreal tolerance, int depth, QPolygonF& points) {
+        bool isFlat = distanceToSegment(firstControl, start, end) <= tolerance &&
+                      distanceToSegment(secondControl, start, end) <= tolerance;
+        if (isFlat || depth >= kMaxSubdivisionDepth) {
+            points.push_back(end);
+            return;
+        }
+
+        QPointF startHalf = (start + firstControl) / 2.0;
+        QPointF controlsHalf = (firstControl + secondControl) / 2.0;
+        QPointF endHalf = (secondControl + end) / 2.0;
+        QPointF firstMiddle = (startHalf + controlsHalf) / 2.0;
+        QPointF secondMiddle = (controlsHalf + endHalf) / 2.0;
+        QPointF middle = (firstMiddle + secondMiddle) / 2.0;
+        flattenCubic(start, startHalf, firstMiddle, middle, tolerance, depth + 1, points);
+        flattenCubic(middle, secondMiddle, endHalf, end, tolerance, depth + 1, points);
+    }
+
+    int levelOfDetail(qreal scale) noexcept {
+        if (scale <= 0.0) return 0;
+        return std::clamp(static_cast<int>(std::lround(std::log2(scale))), -kMaxLevel, kMaxLevel);
+    }
+
+    QRectF controlBounds(const QPolygonF& controlPoints, qsizetype segment) {
+        qsizetype first = segment * kPointsPerSegment;
+        qreal left = controlPoints[first].x();
+        qreal right = left;
+        qreal top = controlPoints[first].y();
+        qreal bottom = top;
+        for (qsizetype i = first + 1; i <= first + kPointsPerSegment; ++i) {
+            left = std::min(left, controlPoints[i].x());
+            right = std::max(right, controlPoints[i].x());
+            top = std::min(top, controlPoints[i].y());
+            bottom = std::max(bottom, controlPoints[i].y());
+        }
+        return QRectF{QPointF{left, top}, QPointF{right, bottom}};
+    }
+}  // namespace
+
+BezierPathItem::BezierPathItem(const QPolygonF& controlPoints, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      controlPoints_(controlPoints)
+{
+    // Trailing points which do not make a whole segment are dropped.
+    qsizetype segmentsCount = controlPoints_.isEmpty() ? 0 : (controlPoints_.size() - 1) / kPointsPerSegment;
+    if (!controlPoints_.isEmpty()) controlPoints_.resize(segmentsCount * kPointsPerSegment + 1);
+
+    segments_.reserve(segmentsCount);
+    for (qsizetype i = 0; i < segmentsCount; ++i) {
+        segments_.push_back(FlattenedSegment{{}, controlBounds(controlPoints_, i), kNotFlattened});
+    }
+    updateBoundingRect();
+    // Without the flag the exposed rect is the whole bounding rect, and every segment would be painted.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+}
+
+int BezierPathItem::type() const {
+    return Type;
+}
+
+QRectF BezierPathItem::boundingRect() const {
+    return boundingRect_;
+}
+
+QPainterPath BezierPathItem::shape() const {
+    QPainterPath path;
+    if (controlPoints_.isEmpty()) return path;
+    path.moveTo(controlPoints_.front());
+    for (qsizetype i = 0; i < segmentsCount(); ++i) {
+        const QPolygonF& points = flattenedSegment(i, cachedLevel(i));
+        for (const auto& point : points) {
+            path.lineTo(point);
+        }
+    }
+    QPainterPathStroker stroker{pen_};
+    return stroker.createStroke(path);
+}
+
+bool BezierPathItem::contains(const QPointF& point) const {
+    if (!boundingRect_.contains(point) || controlPoints_.isEmpty()) return false;
+
+    qreal radius = std::max(pen_.widthF(), 1.0) / 2.0;
+    for (qsizetype i = 0; i < segmentsCount(); ++i) {
+        if (!segments_[i].bounds.adjusted(-radius, -radius, radius, radius).contains(point)) continue;
+        QPointF previous = controlPoints_[i * kPointsPerSegment];
+        for (const auto& current : flattenedSegment(i, cachedLevel(i))) {
+            if (distanceToSegment(point, previous, current) <= radius) return true;
+            previous = current;
+        }
+    }
+    return false;
+}
+
+void BezierPathItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    painter->setPen(pen_);
+    painter->setBrush(Qt::NoBrush);
+    if (controlPoints_.size() == 1) painter->drawPoint(controlPoints_.front());
+
+    int level = levelOfDetail(QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()));
+    qreal margin = std::max(pen_.widthF(), 1.0) / 2.0;
+    QRectF exposedRect = option != nullptr ? option->exposedRect : boundingRect_;
+
+    // Runs of adjacent visible segments are painted as one polyline, so the pen joins them smoothly.
+    // The buffer keeps its capacity for the following paints.
+    thread_local QPolygonF polyline;
+    polyline.clear();
+    for (qsizetype i = 0; i < segmentsCount(); ++i) {
+        if (!segments_[i].bounds.adjusted(-margin, -margin, margin, margin).intersects(exposedRect)) {
+            if (polyline.size() > 1) painter->drawPolyline(polyline);
+            polyline.clear();
+            continue;
+        }
+        if (polyline.isEmpty()) polyline.push_back(controlPoints_[i * kPointsPerSegment]);
+        polyline.append(flattenedSegment(i, level));
+    }
+    if (polyline.size() > 1) painter->drawPolyline(polyline);
+
+    if (option != nullptr && (option->state & QStyle::State_Selected)) {
+        painter->setPen(QPen{option->palette.windowText(), 0, Qt::DashLine});
+        painter->drawRect(boundingRect_);
+    }
+}
+
+QPen BezierPathItem::pen() const {
+    return pen_;
+}
+
+void BezierPathItem::setPen(const QPen& pen) {
+    if (pen_ == pen) return;
+    prepareGeometryChange();
+    pen_ = pen;
+    updateBoundingRect();
+    update();
+}
+
+QPolygonF BezierPathItem::controlPoints() const {
+    return controlPoints_;
+}
+
+QPainterPath BezierPathItem::path() const {
+    QPainterPath path;
+    if (controlPoints_.isEmpty()) return path;
+    path.moveTo(controlPoints_.front());
+    for (qsizetype i = 1; i + 2 < controlPoints_.size(); i += kPointsPerSegment) {
+        path.cubicTo(controlPoints_[i], controlPoints_[i + 1], controlPoints_[i + 2]);
+    }
+    return path;
+}
+
+qsizetype BezierPathItem::segmentsCount() const noexcept {
+    return static_cast<qsizetype>(segments_.size());
+}
+
+void BezierPathItem::appendSegment(const QPointF& firstControl, const QPointF& secondControl, const QPointF& end) {
+    if (controlPoints_.isEmpty()) return;
+    prepareGeometryChange();
+    controlPoints_ << firstControl << secondControl << end;
+    segments_.push_back(FlattenedSegment{{}, controlBounds(controlPoints_, segmentsCount()), kNotFlattened});
+    updateBoundingRect();
+}
+
+void BezierPathItem::setLastSegment(const QPointF& firstControl, const QPointF& secondControl, const QPointF& end) {
+    if (segments_.empty()) return;
+    prepareGeometryChange();
+    qsizetype first = controlPoints_.size() - kPointsPerSegment;
+    controlPoints_[first] = firstControl;
+    controlPoints_[first + 1] = secondControl;
+    controlPoints_[first + 2] = end;
+    segments_.back() = FlattenedSegment{{}, controlBounds(controlPoints_, segmentsCount() - 1), kNotFlattened};
+    updateBoundingRect();
+}
+
+void BezierPathItem::removeLastSegment() {
+    if (segments_.empty()) return;
+    prepareGeometryChange();
+    controlPoints_.resize(controlPoints_.size() - kPointsPerSegment);
+    segments_.pop_back();
+    updateBoundingRect();
+}
+
+QPolygonF BezierPathItem::controlPointsOf(const QPainterPath& path) {
+    QPolygonF controlPoints;
+    if (path.isEmpty()) return controlPoints;
+    controlPoints.reserve(path.elementCount());
+    controlPoints << path.elementAt(0);
+    for (int i = 1; i < path.elementCount(); ++i) {
+        const auto& element = path.elementAt(i);
+        if (element.isCurveTo() && i + 2 < path.elementCount()) {
+            controlPoints << element << path.elementAt(i + 1) << path.elementAt(i + 2);
+            i += 2;
+        } else if (element.isLineTo() || element.isMoveTo()) {
+            QPointF start = controlPoints.back();
+            controlPoints << start << element << element;
+        }
+    }
+    return controlPoints;
+}
+
+const QPolygonF& BezierPathItem::flattenedSegment(qsizetype index, int level) const {
+    auto& segment = segments_[index];
+    if (segment.level == level) return segment.points;
+
+    const QPointF* controls = controlPoints_.constData() + index * kPointsPerSegment;
+    segment.points.clear();
+    flattenCubic(controls[0], controls[1], controls[2], controls[3], std::ldexp(kFlatteningTolerance, -level), 0,
+                 segment.points);
+    segment.level = level;
+    return segment.points;
+}
+
+int BezierPathItem::cachedLevel(qsizetype index) const noexcept {
+    // Hit-testing uses any cached flattening, it is as precise as the segment looks on the screen.
+    int level = segments_[index].level;
+    return level != kNotFlattened ? level : 0;
+}
+
+void BezierPathItem::updateBoundingRect() {
+    QRectF controlRect;
+    if (!controlPoints_.isEmpty()) controlRect = QRectF{controlPoints_.front(), QSizeF{0, 0}};
+    for (const auto& segment : segments_) {
+        controlRect |= segment.bounds;
+    }
+    // Round caps and joins stick out of the curve by half of the pen width.
+    qreal margin = pen_.style() == Qt::NoPen ? 0.0 : std::max(pen_.widthF(), 1.0) / 2.0;
+    boundingRect_ = controlRect.adjusted(-margin, -margin, margin, margin);
+}
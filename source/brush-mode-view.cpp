@@ -1,76 +1,125 @@
 // @copyright Copyright (c) 2023 by Konstantin Belousov
 
 #include <QMouseEvent>
-#include <QPainterPath>
 #include "../include/brush-mode-view.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+#include "../include/raster-paint-layer.h"
+#include "../include/stroke-item.h"
 #include "../include/graphics-items-detail.h"
+#include "../include/style-registry.h"
 #include "../include/constants.h"
 
 namespace {
     constexpr qreal kDefaultBrushWidth{10.0};
 }
 
-BrushModeView::BrushModeView(QGraphicsScene* scene, QSize viewSize)
+BrushModeView::BrushModeView(ApplicationGraphicsScene* scene, QSize viewSize)
         : DrawingGraphicsView(scene, viewSize, kDefaultBrushWidth),
           startEllipseItem_(nullptr),
           startCursorPos_(constants::kZeroPointF),
-          previousCursorPos_(constants::kZeroPointF) {}
+          previousCursorPos_(constants::kZeroPointF),
+          backend_(BrushBackend::kVector),
+          isDrawing_(false) {}
+
+BrushBackend BrushModeView::getBackend() const noexcept {
+    return backend_;
+}
+
+void BrushModeView::setBackend(BrushBackend backend) {
+    if (isDrawing_) return;
+    backend_ = backend;
+}
 
 void BrushModeView::mousePressEvent(QMouseEvent* event) {
-    if (event->button() == Qt::LeftButton) {
+    if (event->button() == Qt::LeftButton && applicationScene()->isActiveLayerEditable()) {
         startCursorPos_ = mapToScene(event->pos());
-        startEllipseItem_ = scene()->addEllipse(startCursorPos_.x() - strokeWidth_ / 2.0,
-                                                startCursorPos_.y() - strokeWidth_ / 2.0,
-                                                strokeWidth_,
-                                                strokeWidth_,
-                                                QPen{Qt::NoPen},
-                                                QBrush{strokeColor_});
-
-        if (startEllipseItem_ != nullptr) {
-            detail::makeItemSelectableAndMovable(startEllipseItem_);
+        previousCursorPos_ = startCursorPos_;
+        isDrawing_ = true;
+        strokePen_ = StyleRegistry::instance().pen(QPen{strokeColor_,
+                                                        strokeWidth_,
+                                                        Qt::SolidLine,
+                                                        Qt::RoundCap,
+                                                        Qt::RoundJoin});
+
+        if (backend_ == BrushBackend::kRaster) {
+            rasterLayer()->stampDot(startCursorPos_, strokeWidth_, strokeColor_);
             emit changeStateOfScene();
+        } else {
+            startVectorStroke();
         }
-
-        previousCursorPos_ = startCursorPos_;
     }
 }
 
 void BrushModeView::mouseMoveEvent(QMouseEvent* event) {
     QPointF currentCursorPos = mapToScene(event->pos());
     emit cursorPositionChanged(currentCursorPos);
-    if (startEllipseItem_ != nullptr && event->buttons() & Qt::LeftButton) {
-        auto* currentTemporaryLine = scene()->addLine(previousCursorPos_.x(),
-                                                      previousCursorPos_.y(),
-                                                      currentCursorPos.x(),
-                                                      currentCursorPos.y(),
-                                                      QPen{strokeColor_, strokeWidth_, Qt::SolidLine, Qt::RoundCap});
-
-        if (currentTemporaryLine != nullptr) {
-            temporaryLines_.push_back(currentTemporaryLine);
+    if (isDrawing_ && event->buttons() & Qt::LeftButton) {
+        if (backend_ == BrushBackend::kRaster) {
+            rasterLayer()->stampSegment(QLineF{previousCursorPos_, currentCursorPos}, strokePen_);
             previousCursorPos_ = currentCursorPos;
+        } else {
+            continueVectorStroke(currentCursorPos);
         }
         emit changeStateOfScene();
     }
 }
 
 void BrushModeView::mouseReleaseEvent(QMouseEvent* event) {
-    if (startEllipseItem_ != nullptr && event->button() == Qt::LeftButton) {
-        if (!temporaryLines_.empty()) {
-            QPainterPath path;
-            path.moveTo(startCursorPos_);
-
-            for (auto* line : temporaryLines_) {
-                path.moveTo(line->line().p1());
-                path.lineTo(line->line().p2());
-                detail::deleteItem(scene(), line);
-            }
-            temporaryLines_.clear();
-
-            auto* scenePath = scene()->addPath(path, QPen{strokeColor_, strokeWidth_, Qt::SolidLine, Qt::RoundCap});
-            if (scenePath != nullptr) detail::makeItemSelectableAndMovable(scenePath);
-
-            detail::deleteItem(scene(), startEllipseItem_);
-            startEllipseItem_ = nullptr;
-        }
+    if (isDrawing_ && event->button() == Qt::LeftButton) {
+        if (backend_ == BrushBackend::kVector) finishVectorStroke();
+        isDrawing_ = false;
     }
 }
+
+void BrushModeView::startVectorStroke() {
+    startEllipseItem_ = ellipsePool_.acquire(scene());
+    startEllipseItem_->setRect(startCursorPos_.x() - strokeWidth_ / 2.0,
+                               startCursorPos_.y() - strokeWidth_ / 2.0,
+                               strokeWidth_,
+                               strokeWidth_);
+    startEllipseItem_->setPen(StyleRegistry::instance().pen(QPen{Qt::NoPen}));
+    startEllipseItem_->setBrush(StyleRegistry::instance().brush(QBrush{strokeColor_}));
+    strokePoints_.reset();
+    strokePoints_.append(startCursorPos_);
+    emit changeStateOfScene();
+}
+
+void BrushModeView::continueVectorStroke(const QPointF& currentCursorPos) {
+    if (startEllipseItem_ == nullptr) return;
+    auto* currentTemporaryLine = linePool_.acquire(scene());
+    currentTemporaryLine->setLine(QLineF{strokePoints_.back(), currentCursorPos});
+    // The pen is shared with the stroke, so no pen data is allocated per segment.
+    currentTemporaryLine->setPen(strokePen_);
+
+    temporaryLines_.push_back(currentTemporaryLine);
+    strokePoints_.append(currentCursorPos);
+}
+
+void BrushModeView::finishVectorStroke() {
+    if (startEllipseItem_ == nullptr) return;
+
+    if (strokePoints_.size() < 2) {
+        // A click without movement leaves a dot, which is kept as is.
+        detail::makeItemSelectableAndMovable(startEllipseItem_);
+        applicationScene()->addItemToActiveLayer(startEllipseItem_);
+        startEllipseItem_ = nullptr;
+        return;
+    }
+
+    // The arena keeps its storage for the next stroke.
+    auto* strokeItem = new StrokeItem{strokePoints_.toPolygon()};
+    strokePoints_.reset();
+    linePool_.releaseAll(temporaryLines_);
+
+    strokeItem->setPen(strokePen_);
+    detail::makeItemSelectableAndMovable(strokeItem);
+    applicationScene()->addItemToActiveLayer(strokeItem);
+
+    ellipsePool_.release(startEllipseItem_);
+    startEllipseItem_ = nullptr;
+}
+
+RasterPaintLayer* BrushModeView::rasterLayer() {
+    return applicationScene()->getActiveLayer()->rasterSurface(sceneRect());
+}
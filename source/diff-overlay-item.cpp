@@ -0,0 +1,145 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+#include "../include/diff-overlay-item.h"
+
+namespace {
+    const QColor kAddedColor{0, 170, 0};
+    const QColor kRemovedColor{220, 0, 0};
+    const QColor kMovedColor{0, 90, 230};
+    const QColor kRestyledColor{240, 140, 0};
+
+    constexpr qreal kOutlineWidth{2.0};
+    constexpr qreal kRemovedItemOpacity{0.35};
+    // Room for the outlines, which are drawn with cosmetic pens around the bounds of items.
+    constexpr qreal kBoundsMargin{4.0};
+    // Above all layers, whose z values are negative.
+    constexpr qreal kOverlayZValue{0.0};
+    // Side of a cell of the differences grid in scene coordinates, as in ItemGrid.
+    constexpr qreal kCellSize{256.0};
+
+    QColor changeColor(ItemChange change) {
+        switch (change) {
+            case ItemChange::kAdded: return kAddedColor;
+            case ItemChange::kRemoved: return kRemovedColor;
+            case ItemChange::kMoved: return kMovedColor;
+            case ItemChange::kRestyled: return kRestyledColor;
+        }
+        return kAddedColor;
+    }
+
+    QPen outlinePen(ItemChange change, Qt::PenStyle style = Qt::SolidLine) {
+        QPen pen{changeColor(change), kOutlineWidth, style};
+        pen.setCosmetic(true);
+        return pen;
+    }
+}  // namespace
+
+DiffOverlayItem::DiffOverlayItem(DocumentDifference difference, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      difference_(std::move(difference)),
+      paintStamps_(static_cast<std::size_t>(difference_.items.size()), 0),
+      paintStamp_(0)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setFlag(QGraphicsItem::ItemIsSelectable, false);
+    setFlag(QGraphicsItem::ItemIsMovable, false);
+    setZValue(kOverlayZValue);
+
+    for (qsizetype row = 0; row < difference_.items.size(); ++row) {
+        const ItemDifference& item = difference_.items[row];
+        boundingRect_ |= item.sceneBounds | item.previousSceneBounds;
+        link(row, item.sceneBounds);
+        if (item.change == ItemChange::kMoved) link(row, item.previousSceneBounds);
+    }
+    boundingRect_.adjust(-kBoundsMargin, -kBoundsMargin, kBoundsMargin, kBoundsMargin);
+}
+
+int DiffOverlayItem::type() const {
+    return Type;
+}
+
+QRectF DiffOverlayItem::boundingRect() const {
+    return boundingRect_;
+}
+
+QPainterPath DiffOverlayItem::shape() const {
+    return {};
+}
+
+bool DiffOverlayItem::contains(const QPointF&) const {
+    return false;
+}
+
+void DiffOverlayItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    const QRectF& exposedRect = option->exposedRect;
+    QRect cells = cellsOf(exposedRect);
+    if (cells.isEmpty()) return;
+
+    ++paintStamp_;
+    exposedRows_.clear();
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            auto cell = cells_.constFind(QPoint{x, y});
+            if (cell == cells_.cend()) continue;
+            for (qsizetype row : cell.value()) {
+                quint64& stamp = paintStamps_[static_cast<std::size_t>(row)];
+                if (stamp == paintStamp_) continue;
+                stamp = paintStamp_;
+                exposedRows_.push_back(row);
+            }
+        }
+    }
+    // Differences are painted in their order, as removed items are painted below the outlines of later ones.
+    std::sort(exposedRows_.begin(), exposedRows_.end());
+
+    painter->setBrush(Qt::NoBrush);
+    for (qsizetype row : exposedRows_) {
+        const ItemDifference& item = difference_.items[row];
+        bool isMoved = item.change == ItemChange::kMoved;
+        if (!item.sceneBounds.intersects(exposedRect) &&
+            !(isMoved && item.previousSceneBounds.intersects(exposedRect))) continue;
+
+        if (item.change == ItemChange::kRemoved) {
+            painter->save();
+            painter->setOpacity(kRemovedItemOpacity);
+            detail::paintItemSnapshot(*painter, item.item);
+            painter->restore();
+        }
+        if (isMoved) {
+            painter->setPen(outlinePen(item.change, Qt::DashLine));
+            painter->drawRect(item.previousSceneBounds);
+            painter->drawLine(item.previousSceneBounds.center(), item.sceneBounds.center());
+        }
+        painter->setPen(outlinePen(item.change));
+        painter->drawRect(item.sceneBounds);
+    }
+}
+
+const DocumentDifference& DiffOverlayItem::difference() const noexcept {
+    return difference_;
+}
+
+QRect DiffOverlayItem::cellsOf(const QRectF& rect) const {
+    if (rect.isEmpty()) return {};
+    return QRect{QPoint{static_cast<int>(std::floor(rect.left() / kCellSize)),
+                        static_cast<int>(std::floor(rect.top() / kCellSize))},
+                 QPoint{static_cast<int>(std::floor(rect.right() / kCellSize)),
+                        static_cast<int>(std::floor(rect.bottom() / kCellSize))}};
+}
+
+void DiffOverlayItem::link(qsizetype row, const QRectF& bounds) {
+    // The outlines are drawn around the bounds.
+    QRect cells = cellsOf(bounds.adjusted(-kBoundsMargin, -kBoundsMargin, kBoundsMargin, kBoundsMargin));
+    if (cells.isEmpty()) return;
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            QList<qsizetype>& cell = cells_[QPoint{x, y}];
+            // The previous bounds of a moved item may share cells with the current ones.
+            if (cell.isEmpty() || cell.back() != row) cell.push_back(row);
+        }
+    }
+}
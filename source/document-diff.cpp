@@ -0,0 +1,254 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QHash>
+#include <QLineF>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <variant>
+#include <vector>
+#include "../include/document-diff.h"
+
+namespace {
+    template<typename... Visitors>
+    struct Overloaded : Visitors... {
+        using Visitors::operator()...;
+    };
+
+    template<typename... Visitors>
+    Overloaded(Visitors...) -> Overloaded<Visitors...>;
+
+    // Moved items are looked for in the cell of their new position and the neighbouring cells first.
+    constexpr qreal kProximityCellSize{256.0};
+    // Bounds the search among many equal items piled up in the same cells.
+    constexpr int kMaxProximityCandidates{32};
+
+    struct DiffEntry {
+        const ItemSnapshot* item;
+        size_t geometryHash;
+        size_t styleHash;
+        size_t placementHash;
+        QRectF sceneBounds;
+        bool isMatched;
+    };
+
+    // Rows of entries of the base document by a combination of their hashes.
+    using EntriesIndex = QMultiHash<size_t, qsizetype>;
+
+    std::vector<DiffEntry> collectEntries(const DocumentSnapshot& document) {
+        std::vector<DiffEntry> entries;
+        for (const auto& layer : document.layers) {
+            for (const auto& item : layer.items) {
+                entries.push_back({&item, detail::hashItemGeometry(item), detail::hashItemStyle(item),
+                                   detail::hashItemPlacement(item), item.sceneBoundingRect(), false});
+            }
+        }
+        return entries;
+    }
+
+    bool isSameGeometry(const ItemSnapshot& first, const ItemSnapshot& second) {
+        return first.type == second.type && first.geometry == second.geometry;
+    }
+
+    bool isSameStyle(const ItemSnapshot& first, const ItemSnapshot& second) {
+        return first.pen == second.pen && first.brush == second.brush;
+    }
+
+    bool isSamePlacement(const ItemSnapshot& first, const ItemSnapshot& second) {
+        return first.position == second.position && first.transformOrigin == second.transformOrigin &&
+               first.rotation == second.rotation && first.scale == second.scale;
+    }
+
+    size_t exactKey(const DiffEntry& entry) {
+        return qHashMulti(0, entry.geometryHash, entry.styleHash, entry.placementHash);
+    }
+
+    size_t movedKey(const DiffEntry& entry) {
+        return qHashMulti(0, entry.geometryHash, entry.styleHash);
+    }
+
+    size_t restyledKey(const DiffEntry& entry) {
+        return qHashMulti(0, entry.geometryHash, entry.placementHash);
+    }
+
+    QPoint proximityCell(const DiffEntry& entry) {
+        QPointF center = entry.sceneBounds.center();
+        return {static_cast<int>(std::floor(center.x() / kProximityCellSize)),
+                static_cast<int>(std::floor(center.y() / kProximityCellSize))};
+    }
+
+    size_t proximityKey(const DiffEntry& entry, QPoint cell) {
+        return qHashMulti(0, entry.geometryHash, entry.styleHash, cell.x(), cell.y());
+    }
+
+    // Takes the first unmatched entry under `key` accepted by `isMatch`, matched entries met on the way are dropped,
+    // so every entry is skipped at most once whatever the number of lookups.
+    template<typename Predicate>
+    qsizetype takeEntry(EntriesIndex& index, size_t key, std::vector<DiffEntry>& entries, Predicate isMatch) {
+        auto it = index.find(key);
+        while (it != index.end() && it.key() == key) {
+            const DiffEntry& entry = entries[static_cast<std::size_t>(it.value())];
+            if (entry.isMatched) {
+                it = index.erase(it);
+            } else if (isMatch(entry)) {
+                qsizetype row = it.value();
+                index.erase(it);
+                return row;
+            } else {
+                ++it;
+            }
+        }
+        return -1;
+    }
+
+    // The nearest unmatched entry with the same geometry and style in the cell of `entry` or in the neighbouring ones.
+    qsizetype takeNearestEntry(EntriesIndex& index, const DiffEntry& entry, std::vector<DiffEntry>& entries) {
+        const QPointF center = entry.sceneBounds.center();
+        const QPoint cell = proximityCell(entry);
+        qsizetype nearestRow = -1;
+        qreal nearestDistance = std::numeric_limits<qreal>::max();
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                size_t key = proximityKey(entry, cell + QPoint{dx, dy});
+                int candidatesCount = 0;
+                auto it = index.find(key);
+                while (it != index.end() && it.key() == key && candidatesCount < kMaxProximityCandidates) {
+                    const DiffEntry& candidate = entries[static_cast<std::size_t>(it.value())];
+                    if (candidate.isMatched) {
+                        it = index.erase(it);
+                        continue;
+                    }
+                    ++candidatesCount;
+                    if (isSameGeometry(*candidate.item, *entry.item) && isSameStyle(*candidate.item, *entry.item)) {
+                        qreal distance = QLineF{center, candidate.sceneBounds.center()}.length();
+                        if (distance < nearestDistance) {
+                            nearestDistance = distance;
+                            nearestRow = it.value();
+                        }
+                    }
+                    ++it;
+                }
+            }
+        }
+        return nearestRow;
+    }
+
+    ItemDifference makeDifference(ItemChange change, const DiffEntry& entry, const QRectF& previousSceneBounds) {
+        return ItemDifference{change, *entry.item, entry.sceneBounds, previousSceneBounds};
+    }
+}  // namespace
+
+qsizetype DocumentDifference::count(ItemChange change) const {
+    return std::count_if(items.cbegin(), items.cend(), [change](const auto& item) { return item.change == change; });
+}
+
+namespace detail {
+
+    size_t hashItemGeometry(const ItemSnapshot& item, size_t seed) {
+        seed = qHashMulti(seed, item.type, item.geometry.index());
+        return std::visit(Overloaded{
+                [seed](const QRectF& rectangle) {
+                    return qHashMulti(seed, rectangle.x(), rectangle.y(), rectangle.width(), rectangle.height());
+                },
+                [seed](const QLineF& line) { return qHashMulti(seed, line.x1(), line.y1(), line.x2(), line.y2()); },
+                [seed](const QPolygonF& polygon) {
+                    return qHashBits(polygon.constData(), static_cast<size_t>(polygon.size()) * sizeof(QPointF), seed);
+                },
+                [seed](const QPainterPath& path) {
+                    size_t hash = seed;
+                    for (int i = 0; i < path.elementCount(); ++i) {
+                        QPainterPath::Element element = path.elementAt(i);
+                        hash = qHashMulti(hash, element.x, element.y, static_cast<int>(element.type));
+                    }
+                    return hash;
+                },
+                [seed](const QImage& image) {
+                    size_t hash = qHashMulti(seed, image.width(), image.height(), static_cast<int>(image.format()));
+                    return qHashBits(image.constBits(), static_cast<size_t>(image.sizeInBytes()), hash);
+                }
+            }, item.geometry);
+    }
+
+    size_t hashItemStyle(const ItemSnapshot& item, size_t seed) {
+        const QPen& pen = item.pen;
+        return qHashMulti(seed, static_cast<quint64>(pen.color().rgba64()), pen.widthF(), static_cast<int>(pen.style()),
+                          static_cast<int>(pen.capStyle()), static_cast<int>(pen.joinStyle()),
+                          static_cast<quint64>(item.brush.color().rgba64()), static_cast<int>(item.brush.style()));
+    }
+
+    size_t hashItemPlacement(const ItemSnapshot& item, size_t seed) {
+        return qHashMulti(seed, item.position.x(), item.position.y(), item.transformOrigin.x(),
+                          item.transformOrigin.y(), item.rotation, item.scale);
+    }
+
+    DocumentDifference diffDocuments(const DocumentSnapshot& before, const DocumentSnapshot& after) {
+        std::vector<DiffEntry> beforeEntries = collectEntries(before);
+        std::vector<DiffEntry> afterEntries = collectEntries(after);
+
+        EntriesIndex exactIndex;
+        EntriesIndex proximityIndex;
+        EntriesIndex movedIndex;
+        EntriesIndex restyledIndex;
+        for (std::size_t row = 0; row < beforeEntries.size(); ++row) {
+            const DiffEntry& entry = beforeEntries[row];
+            exactIndex.insert(exactKey(entry), static_cast<qsizetype>(row));
+            proximityIndex.insert(proximityKey(entry, proximityCell(entry)), static_cast<qsizetype>(row));
+            movedIndex.insert(movedKey(entry), static_cast<qsizetype>(row));
+            restyledIndex.insert(restyledKey(entry), static_cast<qsizetype>(row));
+        }
+
+        DocumentDifference difference;
+        auto matchEntries = [&beforeEntries](DiffEntry& entry, qsizetype row) -> DiffEntry* {
+            if (row < 0) return nullptr;
+            DiffEntry& matched = beforeEntries[static_cast<std::size_t>(row)];
+            matched.isMatched = true;
+            entry.isMatched = true;
+            return &matched;
+        };
+
+        for (auto& entry : afterEntries) {
+            qsizetype row = takeEntry(exactIndex, exactKey(entry), beforeEntries, [&entry](const DiffEntry& candidate) {
+                return isSameGeometry(*candidate.item, *entry.item) && isSameStyle(*candidate.item, *entry.item) &&
+                       isSamePlacement(*candidate.item, *entry.item);
+            });
+            if (matchEntries(entry, row) != nullptr) ++difference.unchangedCount;
+        }
+
+        for (auto& entry : afterEntries) {
+            if (entry.isMatched) continue;
+            qsizetype row = takeNearestEntry(proximityIndex, entry, beforeEntries);
+            // An item moved farther than the neighbouring cells is matched with any equal one.
+            if (row < 0) {
+                row = takeEntry(movedIndex, movedKey(entry), beforeEntries, [&entry](const DiffEntry& candidate) {
+                    return isSameGeometry(*candidate.item, *entry.item) && isSameStyle(*candidate.item, *entry.item);
+                });
+            }
+            if (const DiffEntry* matched = matchEntries(entry, row)) {
+                difference.items.push_back(makeDifference(ItemChange::kMoved, entry, matched->sceneBounds));
+            }
+        }
+
+        for (auto& entry : afterEntries) {
+            if (entry.isMatched) continue;
+            qsizetype row = takeEntry(restyledIndex, restyledKey(entry), beforeEntries,
+                                      [&entry](const DiffEntry& candidate) {
+                return isSameGeometry(*candidate.item, *entry.item) && isSamePlacement(*candidate.item, *entry.item);
+            });
+            if (const DiffEntry* matched = matchEntries(entry, row)) {
+                difference.items.push_back(makeDifference(ItemChange::kRestyled, entry, matched->sceneBounds));
+            }
+        }
+
+        for (const auto& entry : beforeEntries) {
+            if (entry.isMatched) continue;
+            difference.items.push_back(makeDifference(ItemChange::kRemoved, entry, entry.sceneBounds));
+        }
+        for (const auto& entry : afterEntries) {
+            if (entry.isMatched) continue;
+            difference.items.push_back(makeDifference(ItemChange::kAdded, entry, entry.sceneBounds));
+        }
+        return difference;
+    }
+
+}  // namespace detail
@@ -0,0 +1,169 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include "../include/document-file.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+#include "../include/style-registry.h"
+
+namespace {
+    constexpr quint32 kDocumentMagic{0x51504e54};
+    // The first version stores the pen and the brush with every item, the second one stores a table of styles.
+    constexpr quint16 kInlineStylesVersion{1};
+    constexpr quint16 kDocumentVersion{2};
+    constexpr QDataStream::Version kStreamVersion{QDataStream::Qt_6_5};
+
+    std::optional<detail::StyleKey> styleKey(const QPen& pen) {
+        return detail::penStyleKey(pen);
+    }
+
+    std::optional<detail::StyleKey> styleKey(const QBrush& brush) {
+        return detail::brushStyleKey(brush);
+    }
+
+    template<typename Style>
+    class StyleTable {
+    /*
+     Distinct styles of a document in the order of their first use, the items refer to them by index.
+    */
+     public:
+        quint32 indexOf(const Style& style) {
+            auto key = styleKey(style);
+            if (key) {
+                if (auto it = indices_.constFind(*key); it != indices_.cend()) return *it;
+                indices_.insert(*key, static_cast<quint32>(styles_.size()));
+            }
+            styles_.push_back(style);
+            return static_cast<quint32>(styles_.size() - 1);
+        }
+
+        [[nodiscard]] const QList<Style>& getStyles() const noexcept {
+            return styles_;
+        }
+
+     private:
+        QList<Style> styles_;
+        QHash<detail::StyleKey, quint32> indices_;
+    };
+
+    void writeLayers(QDataStream& stream, const QList<LayerSnapshot>& layers) {
+        StyleTable<QPen> pens;
+        StyleTable<QBrush> brushes;
+        QList<quint32> styleIndices;
+        for (const auto& layer : layers) {
+            for (const auto& item : layer.items) {
+                styleIndices.push_back(pens.indexOf(item.pen));
+                styleIndices.push_back(brushes.indexOf(item.brush));
+            }
+        }
+
+        stream << pens.getStyles() << brushes.getStyles() << static_cast<quint32>(layers.size());
+        auto styleIndex = styleIndices.cbegin();
+        for (const auto& layer : layers) {
+            stream << layer.name << layer.isVisible << layer.isLocked << static_cast<quint32>(layer.items.size());
+            for (const auto& item : layer.items) {
+                detail::writeItemGeometry(stream, item);
+                stream << *styleIndex++;
+                stream << *styleIndex++;
+                detail::writeItemPlacement(stream, item);
+            }
+        }
+    }
+
+    void readLayers(QDataStream& stream, QList<LayerSnapshot>& layers) {
+        QList<QPen> pens;
+        QList<QBrush> brushes;
+        quint32 layersCount = 0;
+        stream >> pens >> brushes >> layersCount;
+
+        for (quint32 i = 0; i < layersCount && stream.status() == QDataStream::Ok; ++i) {
+            LayerSnapshot layer;
+            quint32 itemsCount = 0;
+            stream >> layer.name >> layer.isVisible >> layer.isLocked >> itemsCount;
+
+            for (quint32 j = 0; j < itemsCount && stream.status() == QDataStream::Ok; ++j) {
+                ItemSnapshot item;
+                quint32 penIndex = 0;
+                quint32 brushIndex = 0;
+                if (!detail::readItemGeometry(stream, item)) return;
+                stream >> penIndex >> brushIndex;
+                if (static_cast<qsizetype>(penIndex) >= pens.size() ||
+                    static_cast<qsizetype>(brushIndex) >= brushes.size()) {
+                    stream.setStatus(QDataStream::ReadCorruptData);
+                    return;
+                }
+                // Items of the loaded document share the styles of the table.
+                item.pen = pens[penIndex];
+                item.brush = brushes[brushIndex];
+                detail::readItemPlacement(stream, item);
+                layer.items.push_back(std::move(item));
+            }
+            layers.push_back(std::move(layer));
+        }
+    }
+}  // namespace
+
+// Layers of the documents with inline styles.
+QDataStream& operator>>(QDataStream& stream, LayerSnapshot& layer) {
+    return stream >> layer.name >> layer.isVisible >> layer.isLocked >> layer.items;
+}
+
+namespace detail {
+
+    DocumentSnapshot takeDocumentSnapshot(const ApplicationGraphicsScene* scene, const QRectF& canvasRect) {
+        DocumentSnapshot document{canvasRect, {}};
+        document.layers.reserve(scene->getLayers().size());
+        for (const auto* layer : scene->getLayers()) {
+            document.layers.push_back(LayerSnapshot{layer->getName(),
+                                                    layer->isVisible(),
+                                                    layer->isLocked(),
+                                                    takeItemsSnapshot(layer->childItems())});
+        }
+        return document;
+    }
+
+    bool writeDocument(QIODevice* device, const DocumentSnapshot& document) {
+        QDataStream stream{device};
+        stream.setVersion(kStreamVersion);
+        stream << kDocumentMagic << kDocumentVersion << document.canvasRect;
+        writeLayers(stream, document.layers);
+        return stream.status() == QDataStream::Ok;
+    }
+
+    std::optional<DocumentSnapshot> readDocument(QIODevice* device) {
+        QDataStream stream{device};
+        stream.setVersion(kStreamVersion);
+
+        quint32 magic = 0;
+        quint16 version = 0;
+        stream >> magic >> version;
+        if (magic != kDocumentMagic) return std::nullopt;
+        if (version < kInlineStylesVersion || version > kDocumentVersion) return std::nullopt;
+
+        DocumentSnapshot document;
+        stream >> document.canvasRect;
+        if (version == kInlineStylesVersion) stream >> document.layers;
+        else readLayers(stream, document.layers);
+        if (stream.status() != QDataStream::Ok) return std::nullopt;
+        return document;
+    }
+
+    bool saveDocument(const QString& filePath, const DocumentSnapshot& document) {
+        QSaveFile file{filePath};
+        if (!file.open(QIODevice::WriteOnly)) return false;
+        if (!writeDocument(&file, document)) {
+            file.cancelWriting();
+            return false;
+        }
+        return file.commit();
+    }
+
+    std::optional<DocumentSnapshot> loadDocument(const QString& filePath) {
+        QFile file{filePath};
+        if (!file.open(QIODevice::ReadOnly)) return std::nullopt;
+        return readDocument(&file);
+    }
+
+}  // namespace detail
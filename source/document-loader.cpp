@@ -0,0 +1,189 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QDeadlineTimer>
+#include <QGraphicsItemGroup>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+#include "../include/document-loader.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+#include "../include/async-detail.h"
+
+namespace {
+    // Leaves most of a 60 Hz frame to painting and input handling.
+    constexpr qint64 kBatchTimeBudgetMs{8};
+    constexpr auto kUntitledLayerName{"Layer 1"};
+}  // namespace
+
+DocumentLoader::DocumentLoader(ApplicationGraphicsScene* scene, QObject* parent)
+    : QObject(parent),
+      scene_(scene),
+      batchTimer_(new QTimer{this}),
+      createdCount_(0),
+      totalCount_(0),
+      loadId_(0),
+      isLoading_(false)
+{
+    connect(batchTimer_, &QTimer::timeout, this, &DocumentLoader::processNextBatch);
+    connect(scene_, &ApplicationGraphicsScene::layersChanged, this, &DocumentLoader::forgetRemovedLayers);
+}
+
+DocumentLoader::~DocumentLoader() = default;
+
+void DocumentLoader::load(const QString& filePath, const QRectF& visibleRect) {
+    cancel();
+    isLoading_ = true;
+    visibleRect_ = visibleRect;
+
+    int loadId = ++loadId_;
+    QPointer<DocumentLoader> loader{this};
+    QThreadPool::globalInstance()->start([loader, filePath, loadId]() {
+        auto document = detail::loadDocument(filePath);
+        detail::invokeIfAlive(loader, [document, loadId](DocumentLoader* receiver) {
+            receiver->finishReading(document, loadId);
+        });
+    });
+}
+
+void DocumentLoader::finishReading(const std::optional<DocumentSnapshot>& document, int loadId) {
+    // The document is dropped if another one was opened or loading was cancelled meanwhile.
+    if (loadId != loadId_) return;
+    if (!document) {
+        isLoading_ = false;
+        emit failed();
+        return;
+    }
+    startInsertion(*document);
+}
+
+void DocumentLoader::finish() {
+    if (pendingLayers_.empty()) return;
+    batchTimer_->stop();
+    // Staged items are taken as they are, the rest is created in the document order.
+    if (insertItems(QDeadlineTimer{QDeadlineTimer::Forever})) completeLoading();
+}
+
+void DocumentLoader::cancel() {
+    ++loadId_;
+    batchTimer_->stop();
+    for (auto& pending : pendingLayers_) {
+        delete pending.stagingGroup;
+    }
+    pendingLayers_.clear();
+    isLoading_ = false;
+}
+
+bool DocumentLoader::isLoading() const noexcept {
+    return isLoading_;
+}
+
+void DocumentLoader::processNextBatch() {
+    QDeadlineTimer deadline{kBatchTimeBudgetMs};
+    bool isDone = stageVisibleItems(deadline) && insertItems(deadline);
+    emit progressChanged(createdCount_, totalCount_);
+    if (isDone) completeLoading();
+}
+
+void DocumentLoader::forgetRemovedLayers() {
+    // Layers removed while loading are deleted together with their staged items.
+    const auto& layers = scene_->getLayers();
+    pendingLayers_.erase(std::remove_if(pendingLayers_.begin(), pendingLayers_.end(),
+                                        [&layers](const PendingLayer& pending) {
+                                            return !layers.contains(pending.layer);
+                                        }),
+                         pendingLayers_.end());
+}
+
+void DocumentLoader::startInsertion(const DocumentSnapshot& document) {
+    // The scene always keeps at least one layer, so old layers are removed after new ones are added.
+    QList<LayerItem*> oldLayers = scene_->getLayers();
+    scene_->clearSelection();
+
+    std::vector<PendingLayer> pendingLayers;
+    pendingLayers.reserve(document.layers.size());
+    createdCount_ = 0;
+    totalCount_ = 0;
+    for (const auto& layerSnapshot : document.layers) {
+        // A new layer becomes the active one.
+        auto* layer = scene_->addLayer(layerSnapshot.name);
+        scene_->setLayerVisible(layer, layerSnapshot.isVisible);
+
+        QGraphicsItemGroup* stagingGroup = nullptr;
+        if (layerSnapshot.isVisible) {
+            stagingGroup = new QGraphicsItemGroup{layer};
+        }
+        pendingLayers.push_back(PendingLayer{layer,
+                                             stagingGroup,
+                                             layerSnapshot.items,
+                                             std::vector<QGraphicsItem*>(layerSnapshot.items.size(), nullptr),
+                                             0,
+                                             0,
+                                             layerSnapshot.isLocked});
+        totalCount_ += layerSnapshot.items.size();
+    }
+    if (document.layers.empty()) scene_->addLayer(kUntitledLayerName);
+
+    for (auto* layer : oldLayers) {
+        scene_->removeLayer(layer);
+    }
+
+    pendingLayers_ = std::move(pendingLayers);
+    emit progressChanged(createdCount_, totalCount_);
+    batchTimer_->start();
+}
+
+bool DocumentLoader::stageVisibleItems(const QDeadlineTimer& deadline) {
+    for (auto& pending : pendingLayers_) {
+        if (pending.stagingGroup == nullptr) continue;
+        for (; pending.stagingIndex < pending.items.size(); ++pending.stagingIndex) {
+            if (deadline.hasExpired()) return false;
+
+            const auto& item = pending.items[pending.stagingIndex];
+            if (!item.sceneBoundingRect().intersects(visibleRect_)) continue;
+
+            auto* stagedItem = detail::createItemFromSnapshot(item);
+            stagedItem->setFlag(QGraphicsItem::ItemIsSelectable, false);
+            stagedItem->setParentItem(pending.stagingGroup);
+            pending.stagedItems[pending.stagingIndex] = stagedItem;
+            ++createdCount_;
+        }
+    }
+    return true;
+}
+
+bool DocumentLoader::insertItems(const QDeadlineTimer& deadline) {
+    while (!pendingLayers_.empty()) {
+        auto& pending = pendingLayers_.front();
+
+        QList<QGraphicsItem*> batch;
+        while (pending.insertionIndex < pending.items.size() && !deadline.hasExpired()) {
+            qsizetype index = pending.insertionIndex++;
+            auto* item = pending.stagedItems[index];
+            if (item != nullptr) {
+                item->setFlag(QGraphicsItem::ItemIsSelectable, true);
+            } else {
+                item = detail::createItemFromSnapshot(pending.items[index]);
+                ++createdCount_;
+            }
+            batch.push_back(item);
+        }
+        if (!batch.isEmpty()) scene_->addItemsToLayer(pending.layer, batch);
+        if (pending.insertionIndex < pending.items.size()) return false;
+
+        LayerItem* layer = pending.layer;
+        bool isLocked = pending.isLocked;
+        delete pending.stagingGroup;
+        pendingLayers_.erase(pendingLayers_.begin());
+        // Locking caches the layer, which is done once all of its items are there.
+        if (isLocked) scene_->setLayerLocked(layer, true);
+    }
+    return true;
+}
+
+void DocumentLoader::completeLoading() {
+    batchTimer_->stop();
+    isLoading_ = false;
+    emit progressChanged(totalCount_, totalCount_);
+    emit finished();
+}
@@ -0,0 +1,162 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include <algorithm>
+#include "../include/document-model.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+
+DocumentModel::DocumentModel(ApplicationGraphicsScene* scene, QObject* parent)
+    : QObject(parent),
+      scene_(scene)
+{
+    connect(scene_, &ApplicationGraphicsScene::layersChanged, this, &DocumentModel::updateLayers);
+    connect(scene_, &ApplicationGraphicsScene::itemsAdded, this, &DocumentModel::addItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsMoved, this, &DocumentModel::moveItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsTransformed, this, &DocumentModel::updateItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsRestacked, this, &DocumentModel::reorderItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsAboutToBeDeleted, this, &DocumentModel::removeItems);
+
+    updateLayers();
+    for (const auto* layer : scene_->getLayers()) {
+        addItems(layer->childItems());
+    }
+}
+
+DocumentSnapshot DocumentModel::snapshot(const QRectF& canvasRect) {
+    DocumentSnapshot document{canvasRect, {}};
+    document.layers.reserve(static_cast<qsizetype>(layers_.size()));
+    for (auto& layer : layers_) {
+        compactLayer(layer);
+        document.layers.push_back(layer.snapshot);
+    }
+    return document;
+}
+
+qsizetype DocumentModel::itemsCount() const noexcept {
+    return locations_.size();
+}
+
+void DocumentModel::addItems(const QList<QGraphicsItem*>& items) {
+    for (const auto* item : items) {
+        if (!detail::isSnapshotSupported(item) || locations_.contains(item)) continue;
+        auto* layer = findLayer(qgraphicsitem_cast<const LayerItem*>(item->parentItem()));
+        if (layer == nullptr) continue;
+
+        // Added items are put on top of their layers.
+        locations_.insert(item, ItemLocation{layer->layer, layer->sources.size()});
+        layer->snapshot.items.push_back(detail::takeItemSnapshot(item));
+        layer->sources.push_back(item);
+    }
+}
+
+void DocumentModel::moveItems(const QList<QGraphicsItem*>& items) {
+    for (const auto* item : items) {
+        // Snapshots are placed in scene coordinates, as detail::takeItemSnapshot places them.
+        if (auto* snapshot = findItem(item)) snapshot->position = item->scenePos();
+    }
+}
+
+void DocumentModel::updateItems(const QList<QGraphicsItem*>& items) {
+    // Transformations keep the geometry and the style, only the placement of the snapshots is refreshed.
+    for (const auto* item : items) {
+        auto* snapshot = findItem(item);
+        if (snapshot == nullptr) continue;
+        snapshot->position = item->scenePos();
+        snapshot->transformOrigin = item->transformOriginPoint();
+        snapshot->rotation = item->rotation();
+        snapshot->scale = item->scale();
+    }
+}
+
+void DocumentModel::removeItems(const QList<QGraphicsItem*>& items) {
+    for (const auto* item : items) {
+        auto it = locations_.find(item);
+        if (it == locations_.end()) continue;
+        if (auto* layer = findLayer(it->layer)) {
+            layer->sources[it->row] = nullptr;
+            ++layer->removedCount;
+        }
+        locations_.erase(it);
+    }
+}
+
+void DocumentModel::reorderItems(const QList<QGraphicsItem*>& items) {
+    for (const auto* item : items) {
+        auto it = locations_.constFind(item);
+        if (it == locations_.cend()) continue;
+        if (auto* layer = findLayer(it->layer)) layer->isOrderChanged = true;
+    }
+}
+
+void DocumentModel::updateLayers() {
+    std::vector<ModelLayer> layers;
+    layers.reserve(scene_->getLayers().size());
+    for (const auto* layerItem : scene_->getLayers()) {
+        auto it = std::find_if(layers_.begin(), layers_.end(),
+                               [layerItem](const ModelLayer& layer) { return layer.layer == layerItem; });
+        if (it != layers_.end()) {
+            layers.push_back(std::move(*it));
+            layers_.erase(it);
+        } else {
+            layers.push_back(ModelLayer{layerItem, LayerSnapshot{}, {}, 0, false});
+        }
+
+        auto& snapshot = layers.back().snapshot;
+        snapshot.name = layerItem->getName();
+        snapshot.isVisible = layerItem->isVisible();
+        snapshot.isLocked = layerItem->isLocked();
+    }
+
+    // Items of the removed layers are deleted with them.
+    for (const auto& layer : layers_) {
+        for (const auto* item : layer.sources) {
+            if (item != nullptr) locations_.remove(item);
+        }
+    }
+    layers_ = std::move(layers);
+}
+
+DocumentModel::ModelLayer* DocumentModel::findLayer(const LayerItem* layer) {
+    if (layer == nullptr) return nullptr;
+    auto it = std::find_if(layers_.begin(), layers_.end(),
+                           [layer](const ModelLayer& modelLayer) { return modelLayer.layer == layer; });
+    return it != layers_.end() ? &*it : nullptr;
+}
+
+ItemSnapshot* DocumentModel::findItem(const QGraphicsItem* item) {
+    auto it = locations_.constFind(item);
+    if (it == locations_.cend()) return nullptr;
+    auto* layer = findLayer(it->layer);
+    return layer != nullptr ? &layer->snapshot.items[it->row] : nullptr;
+}
+
+void DocumentModel::compactLayer(ModelLayer& layer) {
+    if (layer.removedCount == 0 && !layer.isOrderChanged) return;
+
+    std::vector<qsizetype> rows;
+    rows.reserve(layer.sources.size() - layer.removedCount);
+    for (qsizetype row = 0; row < layer.sources.size(); ++row) {
+        if (layer.sources[row] != nullptr) rows.push_back(row);
+    }
+    // Z-values of the layer children are the keys of their stacking order.
+    if (layer.isOrderChanged) {
+        std::stable_sort(rows.begin(), rows.end(), [&layer](qsizetype first, qsizetype second) {
+            return layer.sources[first]->zValue() < layer.sources[second]->zValue();
+        });
+    }
+
+    QList<ItemSnapshot> items;
+    QList<const QGraphicsItem*> sources;
+    items.reserve(static_cast<qsizetype>(rows.size()));
+    sources.reserve(static_cast<qsizetype>(rows.size()));
+    for (auto row : rows) {
+        locations_[layer.sources[row]].row = items.size();
+        items.push_back(layer.snapshot.items[row]);
+        sources.push_back(layer.sources[row]);
+    }
+    layer.snapshot.items = std::move(items);
+    layer.sources = std::move(sources);
+    layer.removedCount = 0;
+    layer.isOrderChanged = false;
+}
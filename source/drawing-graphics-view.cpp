@@ -2,20 +2,18 @@
 
 #include <QMouseEvent>
 #include "../include/drawing-graphics-view.h"
+#include "../include/style-registry.h"
 #include "../include/constants.h"
 
 namespace {
     constexpr Qt::GlobalColor kDefaultColor{Qt::black};
 }
 
-DrawingGraphicsView::DrawingGraphicsView(QGraphicsScene* scene, QSize viewSize, int strokeWidth)
+DrawingGraphicsView::DrawingGraphicsView(ApplicationGraphicsScene* scene, QSize viewSize, int strokeWidth)
     : ApplicationGraphicsView(scene, viewSize),
       fillColor_(kDefaultColor),
       strokeColor_(kDefaultColor),
-      strokeWidth_(strokeWidth)
-{
-    setRenderHint(QPainter::Antialiasing);
-}
+      strokeWidth_(strokeWidth) {}
 
 DrawingGraphicsView::~DrawingGraphicsView() = default;
 
@@ -43,3 +41,11 @@ void DrawingGraphicsView::setStrokeWidth(int width) {
     assert(width >= 0); // this condition must be guaranteed by QSpinBox constraints of minimum value;
     strokeWidth_ = width;
 }
+
+QPen DrawingGraphicsView::shapePen() const {
+    return StyleRegistry::instance().pen(QPen{strokeColor_, strokeWidth_, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin});
+}
+
+QBrush DrawingGraphicsView::fillBrush() const {
+    return StyleRegistry::instance().brush(QBrush{fillColor_});
+}
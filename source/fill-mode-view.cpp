@@ -0,0 +1,60 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsPathItem>
+#include <QMouseEvent>
+#include <QPainter>
+#include <vector>
+#include "../include/fill-mode-view.h"
+#include "../include/graphics-scene.h"
+#include "../include/flood-fill-detail.h"
+#include "../include/graphics-items-detail.h"
+#include "../include/style-registry.h"
+
+namespace {
+    // Maximal per channel difference from the clicked pixel color for a pixel to be filled.
+    constexpr int kFillColorTolerance{8};
+}
+
+FillModeView::FillModeView(ApplicationGraphicsScene* scene, QSize viewSize)
+    : DrawingGraphicsView(scene, viewSize) {}
+
+void FillModeView::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton && applicationScene()->isActiveLayerEditable()) {
+        fillRegion(mapToScene(event->pos()));
+    }
+}
+
+void FillModeView::mouseMoveEvent(QMouseEvent* event) {
+    emit cursorPositionChanged(mapToScene(event->pos()));
+}
+
+QImage FillModeView::rasterizeCanvas(const QRect& window) const {
+    QImage image{window.size(), QImage::Format_RGB32};
+    image.fill(Qt::white);
+
+    // Antialiasing is left off on purpose: solid edges give the fill a closed boundary without gaps.
+    QPainter painter{&image};
+    scene()->render(&painter, QRectF{image.rect()}, QRectF{window}.translated(sceneRect().topLeft()));
+    return image;
+}
+
+void FillModeView::fillRegion(const QPointF& clickPos) {
+    QRectF canvas = sceneRect();
+    QPoint seed = (clickPos - canvas.topLeft()).toPoint();
+
+    // Only the part of the canvas the fill can reach is rasterized, which is usually far less than the canvas.
+    std::vector<std::uint8_t> mask;
+    auto rasterize = [this](const QRect& window) { return rasterizeCanvas(window); };
+    detail::ReachableFill fill = detail::fillReachableRegion(canvas.size().toSize(), seed, kFillColorTolerance,
+                                                            rasterize, mask);
+    if (fill.filledBounds.isEmpty()) return;
+
+    QPainterPath region = detail::traceFilledRegion(mask.data(), fill.window.size(), fill.filledBounds);
+    region.translate(canvas.topLeft() + fill.window.topLeft());
+
+    auto* regionItem = scene()->addPath(region, StyleRegistry::instance().pen(QPen{Qt::NoPen}), fillBrush());
+    if (regionItem == nullptr) return;
+    detail::makeItemSelectableAndMovable(regionItem);
+    applicationScene()->addItemToActiveLayer(regionItem);
+    emit changeStateOfScene();
+}
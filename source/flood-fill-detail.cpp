@@ -0,0 +1,360 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QtAlgorithms>
+#include <QPolygonF>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../include/flood-fill-detail.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    enum Direction : std::uint8_t {
+        kEast = 0,
+        kSouth = 1,
+        kWest = 2,
+        kNorth = 3
+    };
+
+    constexpr int kDirectionDx[]{1, 0, -1, 0};
+    constexpr int kDirectionDy[]{0, 1, 0, -1};
+
+    // Turns tried at every vertex of an outline, relative to the current direction: right, straight, left.
+    // Trying the right turn first keeps diagonally touching cells in separate outlines (4-connectivity).
+    constexpr int kTurnOrder[]{1, 0, 3};
+
+    // Side of the first window rasterized around the seed of a fill, enough for most enclosed areas.
+    constexpr int kInitialFillWindowSize{512};
+
+    struct Seed {
+        int x;
+        int y;
+    };
+
+    // Scans cells in [from, to) and returns the index of the first one equal to `value`, or `to`.
+    int findEqual(const std::uint8_t* row, int from, int to, std::uint8_t value) noexcept {
+        int x = from;
+#if defined(__AVX2__)
+        const __m256i wideNeedle = _mm256_set1_epi8(static_cast<char>(value));
+        for (; x + 32 <= to; x += 32) {
+            __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+            auto bits = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cells, wideNeedle)));
+            if (bits != 0) return x + static_cast<int>(qCountTrailingZeroBits(bits));
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+        for (; x + 16 <= to; x += 16) {
+            __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            auto bits = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(cells, needle)));
+            if (bits != 0) return x + static_cast<int>(qCountTrailingZeroBits(bits));
+        }
+#endif
+        for (; x < to; ++x) {
+            if (row[x] == value) return x;
+        }
+        return to;
+    }
+
+    // Scans cells in [from, to) and returns the index of the first one not equal to `value`, or `to`.
+    int findNotEqual(const std::uint8_t* row, int from, int to, std::uint8_t value) noexcept {
+        int x = from;
+#if defined(__AVX2__)
+        const __m256i wideNeedle = _mm256_set1_epi8(static_cast<char>(value));
+        for (; x + 32 <= to; x += 32) {
+            __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+            auto bits = ~static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cells, wideNeedle)));
+            if (bits != 0) return x + static_cast<int>(qCountTrailingZeroBits(bits));
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+        for (; x + 16 <= to; x += 16) {
+            __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            auto bits = ~static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(cells, needle))) & 0xFFFFu;
+            if (bits != 0) return x + static_cast<int>(qCountTrailingZeroBits(bits));
+        }
+#endif
+        for (; x < to; ++x) {
+            if (row[x] != value) return x;
+        }
+        return to;
+    }
+
+    // Returns the smallest index `left` such that all cells in [left, from] are equal to `value`.
+    int findRunStart(const std::uint8_t* row, int from, std::uint8_t value) noexcept {
+        int x = from;
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+        for (; x >= 16; x -= 16) {
+            __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 16));
+            auto bits = ~static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(cells, needle))) & 0xFFFFu;
+            if (bits != 0) return x - 16 + (32 - static_cast<int>(qCountLeadingZeroBits(bits)));
+        }
+#endif
+        for (; x > 0; --x) {
+            if (row[x - 1] != value) return x;
+        }
+        return 0;
+    }
+
+    void buildMaskRowScalar(const QRgb* pixels, int from, int to, QRgb seedColor, int tolerance, std::uint8_t* mask) noexcept {
+        for (int x = from; x < to; ++x) {
+            QRgb pixel = pixels[x];
+            bool isSimilar = std::abs(qRed(pixel) - qRed(seedColor)) <= tolerance &&
+                             std::abs(qGreen(pixel) - qGreen(seedColor)) <= tolerance &&
+                             std::abs(qBlue(pixel) - qBlue(seedColor)) <= tolerance &&
+                             std::abs(qAlpha(pixel) - qAlpha(seedColor)) <= tolerance;
+            mask[x] = isSimilar ? detail::kFillableCell : detail::kBoundaryCell;
+        }
+    }
+
+#if defined(__SSE2__)
+    // Returns 0xFFFFFFFF for every pixel having a channel that differs from the seed by more than the tolerance.
+    inline __m128i dissimilarPixels(const QRgb* pixels, __m128i seed, __m128i tolerance) noexcept {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        __m128i difference = _mm_or_si128(_mm_subs_epu8(values, seed), _mm_subs_epu8(seed, values));
+        __m128i excess = _mm_subs_epu8(difference, tolerance);
+        return _mm_xor_si128(_mm_cmpeq_epi32(excess, _mm_setzero_si128()), _mm_set1_epi32(-1));
+    }
+#endif
+
+    int buildMaskRowVectorized(const QRgb* pixels, int width, QRgb seedColor, int tolerance, std::uint8_t* mask) noexcept {
+        int x = 0;
+#if defined(__SSE2__)
+        const __m128i seed = _mm_set1_epi32(static_cast<int>(seedColor));
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(tolerance));
+        const __m128i boundaryCell = _mm_set1_epi8(detail::kBoundaryCell);
+        for (; x + 16 <= width; x += 16) {
+            __m128i low = _mm_packs_epi32(dissimilarPixels(pixels + x, seed, limit),
+                                          dissimilarPixels(pixels + x + 4, seed, limit));
+            __m128i high = _mm_packs_epi32(dissimilarPixels(pixels + x + 8, seed, limit),
+                                           dissimilarPixels(pixels + x + 12, seed, limit));
+            __m128i cells = _mm_and_si128(_mm_packs_epi16(low, high), boundaryCell);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(mask + x), cells);
+        }
+#else
+        Q_UNUSED(pixels)
+        Q_UNUSED(width)
+        Q_UNUSED(seedColor)
+        Q_UNUSED(tolerance)
+        Q_UNUSED(mask)
+#endif
+        return x;
+    }
+
+    void pushSeedsFromRow(const std::uint8_t* row, int y, int left, int right, std::vector<Seed>& seeds) {
+        int x = findEqual(row, left, right, detail::kFillableCell);
+        while (x < right) {
+            seeds.push_back({x, y});
+            x = findNotEqual(row, x, right, detail::kFillableCell);
+            x = findEqual(row, x, right, detail::kFillableCell);
+        }
+    }
+
+    class OutlineGrid {
+    /*
+     Directed cell edges lying between filled and not filled cells, stored as a bit set of outgoing
+     directions per lattice vertex. Edges are oriented clockwise around filled cells,
+     so every vertex has as many incoming edges as outgoing ones and every walk along them closes.
+    */
+     public:
+        explicit OutlineGrid(const QRect& bounds)
+            : bounds_(bounds),
+              width_(bounds.width() + 1),
+              height_(bounds.height() + 1),
+              edges_(static_cast<std::size_t>(width_) * height_, 0) {}
+
+        void addEdges(int fromX, int toX, int y, Direction direction) noexcept {
+            int dx = (direction == kSouth || direction == kWest) ? 1 : 0;
+            int dy = (direction == kWest || direction == kNorth) ? 1 : 0;
+            std::uint8_t* row = vertexRow(y + dy - bounds_.top());
+            for (int x = fromX; x < toX; ++x) {
+                row[x + dx - bounds_.left()] |= static_cast<std::uint8_t>(1u << direction);
+            }
+        }
+
+        void appendOutlines(QPainterPath& path) {
+            for (int y = 0; y < height_; ++y) {
+                const std::uint8_t* row = vertexRow(y);
+                int x = findNotEqual(row, 0, width_, 0);
+                while (x < width_) {
+                    path.addPolygon(traceOutline(x, y));
+                    path.closeSubpath();
+                    x = findNotEqual(row, x, width_, 0);
+                }
+            }
+        }
+
+     private:
+        std::uint8_t* vertexRow(int y) noexcept {
+            return edges_.data() + static_cast<std::size_t>(y) * width_;
+        }
+
+        QPolygonF traceOutline(int x, int y) {
+            QPolygonF outline;
+            outline << QPointF(bounds_.left() + x, bounds_.top() + y);
+
+            auto direction = static_cast<int>(qCountTrailingZeroBits(static_cast<quint32>(vertexRow(y)[x])));
+            for (;;) {
+                vertexRow(y)[x] &= static_cast<std::uint8_t>(~(1u << direction));
+                x += kDirectionDx[direction];
+                y += kDirectionDy[direction];
+
+                std::uint8_t outgoing = vertexRow(y)[x];
+                if (outgoing == 0) break;
+
+                int nextDirection = direction;
+                for (int turn : kTurnOrder) {
+                    int candidate = (direction + turn) & 3;
+                    if (outgoing & (1u << candidate)) {
+                        nextDirection = candidate;
+                        break;
+                    }
+                }
+
+                if (nextDirection != direction)
+                    outline << QPointF(bounds_.left() + x, bounds_.top() + y);
+                direction = nextDirection;
+            }
+            return outline;
+        }
+
+        QRect bounds_;
+        int width_;
+        int height_;
+        std::vector<std::uint8_t> edges_;
+    };
+
+    // Adds edges of type `direction` for cells of the filled run [left, right) of `row`
+    // which have no filled neighbour in `neighbourRow` (nullptr when the neighbour row is out of bounds).
+    void addRunEdges(OutlineGrid& grid, const std::uint8_t* neighbourRow,
+                     int left, int right, int y, Direction direction) {
+        if (neighbourRow == nullptr) {
+            grid.addEdges(left, right, y, direction);
+            return;
+        }
+
+        int x = findNotEqual(neighbourRow, left, right, detail::kFilledCell);
+        while (x < right) {
+            int end = findEqual(neighbourRow, x, right, detail::kFilledCell);
+            grid.addEdges(x, end, y, direction);
+            x = findNotEqual(neighbourRow, end, right, detail::kFilledCell);
+        }
+    }
+}  // namespace
+
+namespace detail {
+
+    void buildFillMask(const QImage& image, QRgb seedColor, int tolerance, std::uint8_t* mask) noexcept {
+        const int width = image.width();
+        for (int y = 0; y < image.height(); ++y) {
+            const auto* pixels = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+            std::uint8_t* maskRow = mask + static_cast<std::size_t>(y) * width;
+            int vectorizedEnd = buildMaskRowVectorized(pixels, width, seedColor, tolerance, maskRow);
+            buildMaskRowScalar(pixels, vectorizedEnd, width, seedColor, tolerance, maskRow);
+        }
+    }
+
+    QRect scanlineFloodFill(std::uint8_t* mask, QSize size, QPoint seed) {
+        const int width = size.width();
+        const int height = size.height();
+        if (!QRect{QPoint{0, 0}, size}.contains(seed) ||
+            mask[static_cast<std::size_t>(seed.y()) * width + seed.x()] != kFillableCell) return {};
+
+        int minX = seed.x(), maxX = seed.x();
+        int minY = seed.y(), maxY = seed.y();
+
+        std::vector<Seed> seeds;
+        seeds.push_back({seed.x(), seed.y()});
+        while (!seeds.empty()) {
+            auto [x, y] = seeds.back();
+            seeds.pop_back();
+
+            std::uint8_t* row = mask + static_cast<std::size_t>(y) * width;
+            if (row[x] != kFillableCell) continue;
+
+            int left = findRunStart(row, x, kFillableCell);
+            int right = findNotEqual(row, x, width, kFillableCell);
+            std::memset(row + left, kFilledCell, static_cast<std::size_t>(right - left));
+
+            minX = std::min(minX, left);
+            maxX = std::max(maxX, right - 1);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+
+            if (y > 0) pushSeedsFromRow(row - width, y - 1, left, right, seeds);
+            if (y + 1 < height) pushSeedsFromRow(row + width, y + 1, left, right, seeds);
+        }
+
+        return QRect{QPoint{minX, minY}, QPoint{maxX, maxY}};
+    }
+
+    QPainterPath traceFilledRegion(const std::uint8_t* mask, QSize size, const QRect& bounds) {
+        QPainterPath path;
+        path.setFillRule(Qt::OddEvenFill);
+        if (bounds.isEmpty()) return path;
+
+        const int width = size.width();
+        const int end = bounds.left() + bounds.width();
+        OutlineGrid grid{bounds};
+
+        for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+            const std::uint8_t* row = mask + static_cast<std::size_t>(y) * width;
+            const std::uint8_t* rowAbove = y > bounds.top() ? row - width : nullptr;
+            const std::uint8_t* rowBelow = y < bounds.bottom() ? row + width : nullptr;
+
+            int left = findEqual(row, bounds.left(), end, kFilledCell);
+            while (left < end) {
+                int right = findNotEqual(row, left, end, kFilledCell);
+                grid.addEdges(left, left + 1, y, kNorth);
+                grid.addEdges(right - 1, right, y, kSouth);
+                addRunEdges(grid, rowAbove, left, right, y, kEast);
+                addRunEdges(grid, rowBelow, left, right, y, kWest);
+                left = findEqual(row, right, end, kFilledCell);
+            }
+        }
+
+        grid.appendOutlines(path);
+        return path;
+    }
+
+    ReachableFill fillReachableRegion(QSize canvasSize, QPoint seed, int tolerance,
+                                      const std::function<QImage(const QRect&)>& rasterize,
+                                      std::vector<std::uint8_t>& mask) {
+        const QRect canvas{QPoint{0, 0}, canvasSize};
+        if (!canvas.contains(seed)) return {};
+
+        QRect window = QRect{seed - QPoint{kInitialFillWindowSize / 2, kInitialFillWindowSize / 2},
+                             QSize{kInitialFillWindowSize, kInitialFillWindowSize}}.intersected(canvas);
+        while (true) {
+            QImage image = rasterize(window);
+            if (image.size() != window.size()) return {};
+
+            QPoint windowSeed = seed - window.topLeft();
+            mask.resize(static_cast<std::size_t>(window.width()) * window.height());
+            buildFillMask(image, image.pixel(windowSeed), tolerance, mask.data());
+            QRect filledBounds = scanlineFloodFill(mask.data(), window.size(), windowSeed);
+            if (filledBounds.isEmpty()) return {window, filledBounds};
+
+            // A fill which stops short of every inner side of the window is enclosed inside it.
+            bool isLeaking = (filledBounds.left() == 0 && window.left() > canvas.left()) ||
+                             (filledBounds.top() == 0 && window.top() > canvas.top()) ||
+                             (filledBounds.right() == window.width() - 1 && window.right() < canvas.right()) ||
+                             (filledBounds.bottom() == window.height() - 1 && window.bottom() < canvas.bottom());
+            if (!isLeaking) return {window, filledBounds};
+
+            int dx = std::max(window.width() / 2, 1);
+            int dy = std::max(window.height() / 2, 1);
+            window = window.adjusted(-dx, -dy, dx, dy).intersected(canvas);
+        }
+    }
+
+}  // namespace detail
@@ -0,0 +1,402 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QSet>
+#include <QSignalBlocker>
+#include <QTimer>
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+#include "../include/tiled-image-item.h"
+
+namespace {
+    // Enough to free a large deletion in a few passes while the window stays responsive.
+    constexpr qsizetype kItemsFreedPerPass{2048};
+
+    bool isBelow(const QGraphicsItem* first, const QGraphicsItem* second) {
+        return first->zValue() < second->zValue();
+    }
+
+    // `count` keys evenly spread strictly between `from` and `to`, ordered from `from` to `to`.
+    // None, when neighbouring keys can not be told apart in double precision.
+    std::optional<QList<qreal>> keysBetween(qreal from, qreal to, qsizetype count) {
+        QList<qreal> keys;
+        keys.reserve(count);
+        qreal previous = from;
+        for (qsizetype i = 1; i <= count; ++i) {
+            qreal key = from + (to - from) * static_cast<qreal>(i) / static_cast<qreal>(count + 1);
+            bool isBetween = from < to ? previous < key && key < to : previous > key && key > to;
+            if (!isBetween) return std::nullopt;
+            keys.push_back(key);
+            previous = key;
+        }
+        return keys;
+    }
+
+    // Position of an item among the children of its layer, which are sorted by their z-values.
+    qsizetype stackingIndex(const QList<QGraphicsItem*>& children, const QGraphicsItem* item) {
+        auto it = std::lower_bound(children.cbegin(), children.cend(), item, isBelow);
+        while (it != children.cend() && *it != item) ++it;
+        return it - children.cbegin();
+    }
+}  // namespace
+
+ApplicationGraphicsScene::ApplicationGraphicsScene(QObject* parent)
+    : QGraphicsScene(parent),
+      activeLayer_(nullptr),
+      freeTimer_(new QTimer{this})
+{
+    connect(freeTimer_, &QTimer::timeout, this, &ApplicationGraphicsScene::freeDeletedItems);
+}
+
+ApplicationGraphicsScene::~ApplicationGraphicsScene() {
+    qDeleteAll(itemsToFree_);
+}
+
+LayerItem* ApplicationGraphicsScene::addLayer(const QString& name) {
+    return insertLayer(layers_.size(), name);
+}
+
+LayerItem* ApplicationGraphicsScene::insertLayer(qsizetype index, const QString& name) {
+    auto* layer = new LayerItem{name};
+    addItem(layer);
+    layers_.insert(std::clamp<qsizetype>(index, 0, layers_.size()), layer);
+    activeLayer_ = layer;
+    updateLayersZValues();
+    emit layersChanged();
+    return layer;
+}
+
+void ApplicationGraphicsScene::removeLayer(LayerItem* layer) {
+    if (layers_.size() <= 1 || !layers_.contains(layer)) return;
+
+    qsizetype index = layers_.indexOf(layer);
+    layers_.removeAt(index);
+    if (activeLayer_ == layer) activeLayer_ = layers_[std::max<qsizetype>(index - 1, 0)];
+
+    emit itemsAboutToBeDeleted(layer->childItems());
+    QList<QRectF> region;
+    for (auto* item : layer->childItems()) {
+        forgetLayerItem(item, region);
+    }
+    removeItem(layer);
+    delete layer;
+    updateLayersZValues();
+    emit layersChanged();
+    if (!region.isEmpty()) emit layerItemsRegionChanged(region);
+}
+
+void ApplicationGraphicsScene::setActiveLayer(LayerItem* layer) {
+    if (!layers_.contains(layer) || activeLayer_ == layer) return;
+    activeLayer_ = layer;
+    emit layersChanged();
+}
+
+void ApplicationGraphicsScene::setLayerVisible(LayerItem* layer, bool isVisible) {
+    if (layer->isVisible() == isVisible) return;
+    layer->setVisible(isVisible);
+    emit layersChanged();
+
+    QList<QRectF> region;
+    for (const auto* item : layer->childItems()) {
+        QRectF bounds = layerItemsGrid_.bounds(item);
+        if (!bounds.isEmpty()) region.push_back(bounds);
+    }
+    if (!region.isEmpty()) emit layerItemsRegionChanged(region);
+}
+
+void ApplicationGraphicsScene::setLayerLocked(LayerItem* layer, bool isLocked) {
+    if (layer->isLocked() == isLocked) return;
+    if (isLocked) {
+        for (auto* item : layer->childItems()) {
+            item->setSelected(false);
+        }
+    }
+    // Locked layers can not be edited, so their content is static and can be painted from the cache.
+    // Tiled images page in only the visible tiles themselves, a cache would hold the whole image at the view scale.
+    const auto children = layer->childItems();
+    bool hasTiledImage = std::any_of(children.cbegin(), children.cend(), [](const QGraphicsItem* item) {
+        return item->type() == TiledImageItem::Type;
+    });
+    layer->setLocked(isLocked);
+    layer->setCached(isLocked && !hasTiledImage);
+    emit layersChanged();
+}
+
+void ApplicationGraphicsScene::setLayerName(LayerItem* layer, const QString& name) {
+    if (layer->getName() == name) return;
+    layer->setName(name);
+    emit layersChanged();
+}
+
+const QList<LayerItem*>& ApplicationGraphicsScene::getLayers() const noexcept {
+    return layers_;
+}
+
+LayerItem* ApplicationGraphicsScene::getActiveLayer() const noexcept {
+    return activeLayer_;
+}
+
+bool ApplicationGraphicsScene::isActiveLayerEditable() const noexcept {
+    return activeLayer_ != nullptr && !activeLayer_->isLocked() && activeLayer_->isVisible();
+}
+
+void ApplicationGraphicsScene::addItemToActiveLayer(QGraphicsItem* item) {
+    insertItemToLayer(activeLayer_, item);
+    emit itemsAdded({item});
+    updateLayerItemsRegion({item});
+}
+
+void ApplicationGraphicsScene::addItemsToActiveLayer(const QList<QGraphicsItem*>& items) {
+    addItemsToLayer(activeLayer_, items);
+}
+
+void ApplicationGraphicsScene::addItemsToLayer(LayerItem* layer, const QList<QGraphicsItem*>& items) {
+    // The scene merges the updates of the inserted items and repaints them once, when the event loop is reached.
+    for (auto* item : items) {
+        insertItemToLayer(layer, item);
+    }
+    emit itemsAdded(items);
+    updateLayerItemsRegion(items);
+}
+
+void ApplicationGraphicsScene::addItemToLayerOf(QGraphicsItem* item, const QGraphicsItem* layerMember) {
+    auto* layer = qgraphicsitem_cast<LayerItem*>(layerMember->parentItem());
+    insertItemToLayer(layer != nullptr ? layer : activeLayer_, item);
+    emit itemsAdded({item});
+    updateLayerItemsRegion({item});
+}
+
+void ApplicationGraphicsScene::moveItems(const QList<QGraphicsItem*>& items, const QPointF& delta) {
+    for (auto* item : items) {
+        item->moveBy(delta.x(), delta.y());
+    }
+    emit itemsMoved(items, delta);
+    updateLayerItemsRegion(items);
+}
+
+void ApplicationGraphicsScene::notifyItemsTransformed(const QList<QGraphicsItem*>& items) {
+    emit itemsTransformed(items);
+    updateLayerItemsRegion(items);
+}
+
+void ApplicationGraphicsScene::restackItems(const QList<QGraphicsItem*>& items, StackingMove move) {
+    QHash<LayerItem*, QList<QGraphicsItem*>> layersItems;
+    for (auto* item : items) {
+        auto* layer = qgraphicsitem_cast<LayerItem*>(item->parentItem());
+        if (layer != nullptr) layersItems[layer].push_back(item);
+    }
+    if (layersItems.isEmpty()) return;
+
+    for (auto it = layersItems.begin(); it != layersItems.end(); ++it) {
+        std::sort(it->begin(), it->end(), isBelow);
+        if (restackLayerItems(it.key(), *it, move)) continue;
+        // Renumbered children are a whole unit apart, which leaves enough room between any two of them.
+        it.key()->renumberChildren();
+        restackLayerItems(it.key(), *it, move);
+    }
+    emit itemsRestacked(items, move);
+    updateLayerItemsRegion(items);
+}
+
+void ApplicationGraphicsScene::deleteItems(const QList<QGraphicsItem*>& items) {
+    if (items.isEmpty()) return;
+    emit itemsAboutToBeDeleted(items);
+
+    // The items are deselected at once, so the selection change is reported once instead of once per item.
+    bool isSelectionChanged = false;
+    {
+        const QSignalBlocker blocker{this};
+        for (auto* item : items) {
+            if (!item->isSelected()) continue;
+            item->setSelected(false);
+            isSelectionChanged = true;
+        }
+    }
+
+    QSet<QGraphicsItem*> itemsToRemove{items.cbegin(), items.cend()};
+    QList<LayerItem*> affectedLayers;
+    for (auto* item : items) {
+        auto* layer = qgraphicsitem_cast<LayerItem*>(item->parentItem());
+        if (layer != nullptr && !affectedLayers.contains(layer)) affectedLayers.push_back(layer);
+    }
+
+    QList<QRectF> region;
+    for (auto* layer : affectedLayers) {
+        // Removing from the top of the stacking order shrinks the list of children from its end.
+        const auto children = layer->childItems();
+        for (auto it = children.crbegin(); it != children.crend(); ++it) {
+            if (!itemsToRemove.remove(*it)) continue;
+            forgetLayerItem(*it, region);
+            removeItem(*it);
+            itemsToFree_.push_back(*it);
+        }
+    }
+    for (auto* item : std::as_const(itemsToRemove)) {
+        forgetLayerItem(item, region);
+        removeItem(item);
+        itemsToFree_.push_back(item);
+    }
+
+    if (isSelectionChanged) emit selectionChanged();
+    if (!region.isEmpty()) emit layerItemsRegionChanged(region);
+    if (!freeTimer_->isActive()) freeTimer_->start();
+}
+
+QGraphicsItem* ApplicationGraphicsScene::editableItemAt(const QPointF& position) const {
+    for (auto* item : items(position)) {
+        if (isItemEditable(item)) return item;
+    }
+    return nullptr;
+}
+
+QList<QGraphicsItem*> ApplicationGraphicsScene::editableItems(const QRectF& rect) const {
+    QList<QGraphicsItem*> editable = items(rect);
+    editable.removeIf([](const QGraphicsItem* item) { return !isItemEditable(item); });
+    return editable;
+}
+
+bool ApplicationGraphicsScene::isItemEditable(const QGraphicsItem* item) {
+    if (!(item->flags() & QGraphicsItem::ItemIsSelectable)) return false;
+    const auto* layer = qgraphicsitem_cast<const LayerItem*>(item->parentItem());
+    return layer == nullptr || !layer->isLocked();
+}
+
+QList<QGraphicsItem*> ApplicationGraphicsScene::layerItems(const QRectF& rect) const {
+    QList<QGraphicsItem*> items;
+    layerItemsGrid_.forEachItem(rect, [&items](QGraphicsItem* item) { items.push_back(item); });
+    // Z-values of the layers follow their order, z-values of the items their order within the layer.
+    std::sort(items.begin(), items.end(), [](const QGraphicsItem* first, const QGraphicsItem* second) {
+        qreal firstLayerZ = first->parentItem()->zValue();
+        qreal secondLayerZ = second->parentItem()->zValue();
+        return firstLayerZ != secondLayerZ ? firstLayerZ < secondLayerZ : isBelow(first, second);
+    });
+    return items;
+}
+
+qsizetype ApplicationGraphicsScene::selectSimilarItems(const QList<QGraphicsItem*>& samples) {
+    QList<QGraphicsItem*> similar = attributeIndex_.similarItems(samples);
+    similar.removeIf([](const QGraphicsItem* item) { return !item->isVisible() || !isItemEditable(item); });
+
+    // The selection change is reported once instead of once per item.
+    {
+        const QSignalBlocker blocker{this};
+        for (auto* item : similar) {
+            item->setSelected(true);
+        }
+    }
+    emit selectionChanged();
+    return similar.size();
+}
+
+void ApplicationGraphicsScene::insertItemToLayer(LayerItem* layer, QGraphicsItem* item) {
+    if (layer != nullptr) {
+        item->setParentItem(layer);
+        item->setZValue(layer->takeFrontZValue());
+        layerItemsGrid_.update(item);
+    } else if (item->scene() != this) addItem(item);
+    attributeIndex_.insert(item);
+}
+
+void ApplicationGraphicsScene::forgetLayerItem(QGraphicsItem* item, QList<QRectF>& region) {
+    attributeIndex_.remove(item);
+    QRectF bounds = layerItemsGrid_.remove(item);
+    if (!bounds.isEmpty()) region.push_back(bounds);
+}
+
+void ApplicationGraphicsScene::updateLayerItemsRegion(const QList<QGraphicsItem*>& items) {
+    // A changed item is repainted where it was before the change and where it is now.
+    QList<QRectF> region;
+    region.reserve(items.size() * 2);
+    for (auto* item : items) {
+        if (!layerItemsGrid_.contains(item)) continue;
+        QRectF previousBounds = layerItemsGrid_.update(item);
+        if (!previousBounds.isEmpty()) region.push_back(previousBounds);
+        region.push_back(layerItemsGrid_.bounds(item));
+    }
+    if (!region.isEmpty()) emit layerItemsRegionChanged(region);
+}
+
+bool ApplicationGraphicsScene::restackLayerItems(LayerItem* layer, const QList<QGraphicsItem*>& items,
+                                                 StackingMove move) {
+    // `items` are sorted from the bottom to the top. New z-values are applied only when all of them are found.
+    std::vector<std::pair<QGraphicsItem*, qreal>> zValues;
+    zValues.reserve(items.size());
+
+    if (move == StackingMove::kToFront) {
+        for (auto* item : items) {
+            zValues.emplace_back(item, layer->takeFrontZValue());
+        }
+    } else if (move == StackingMove::kToBack) {
+        for (auto it = items.crbegin(); it != items.crend(); ++it) {
+            zValues.emplace_back(*it, layer->takeBackZValue());
+        }
+    } else {
+        // Both directions are handled as moving forward along the children walked in the direction of the move.
+        const QList<QGraphicsItem*> children = layer->childItems();
+        const qsizetype count = children.size();
+        const bool isForward = move == StackingMove::kForward;
+        auto childAt = [&](qsizetype index) { return children[isForward ? index : count - 1 - index]; };
+
+        std::vector<qsizetype> indices;
+        indices.reserve(items.size());
+        for (const auto* item : items) {
+            qsizetype index = stackingIndex(children, item);
+            indices.push_back(isForward ? index : count - 1 - index);
+        }
+        std::sort(indices.begin(), indices.end());
+
+        // Runs of adjacent items, each one is put right past the first other child it is followed by.
+        std::vector<std::pair<qsizetype, qsizetype>> runs;
+        for (auto index : indices) {
+            if (!runs.empty() && runs.back().second + 1 == index) runs.back().second = index;
+            else runs.emplace_back(index, index);
+        }
+
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+            auto [first, last] = runs[i];
+            qsizetype passed = last + 1;
+            if (passed >= count) continue;
+
+            // The next run, if adjacent to the passed child, is either moved past its own follower or stays in place.
+            qsizetype next = passed + 1;
+            bool isNextRunMoved = i + 1 < runs.size() && runs[i + 1].first == next && runs[i + 1].second + 1 < count;
+            if (isNextRunMoved) next = runs[i + 1].second + 1;
+
+            qsizetype runSize = last - first + 1;
+            if (next >= count) {
+                for (qsizetype index = first; index <= last; ++index) {
+                    zValues.emplace_back(childAt(index), isForward ? layer->takeFrontZValue()
+                                                                   : layer->takeBackZValue());
+                }
+                continue;
+            }
+            auto keys = keysBetween(childAt(passed)->zValue(), childAt(next)->zValue(), runSize);
+            if (!keys) return false;
+            for (qsizetype index = first; index <= last; ++index) {
+                zValues.emplace_back(childAt(index), (*keys)[index - first]);
+            }
+        }
+    }
+
+    for (auto [item, zValue] : zValues) {
+        item->setZValue(zValue);
+    }
+    return true;
+}
+
+void ApplicationGraphicsScene::freeDeletedItems() {
+    qsizetype count = std::min(itemsToFree_.size(), kItemsFreedPerPass);
+    qDeleteAll(itemsToFree_.cend() - count, itemsToFree_.cend());
+    itemsToFree_.resize(itemsToFree_.size() - count);
+    if (itemsToFree_.isEmpty()) freeTimer_->stop();
+}
+
+void ApplicationGraphicsScene::updateLayersZValues() {
+    // Layers stay below zero, above them are temporary items of the modes and the selection area.
+    for (qsizetype i = 0; i < layers_.size(); ++i) {
+        layers_[i]->setZValue(static_cast<qreal>(i - layers_.size()));
+    }
+}
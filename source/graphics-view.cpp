@@ -1,10 +1,26 @@
 // @copyright Copyright (c) 2023 by Konstantin Belousov
 
 #include <QEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
 #include "../include/graphics-view.h"
+#include "../include/graphics-scene.h"
+#include "../include/render-quality-governor.h"
 
-ApplicationGraphicsView::ApplicationGraphicsView(QGraphicsScene* scene, QSize viewSize)
+namespace {
+    // Zoom factor per notch of a mouse wheel.
+    constexpr qreal kZoomStep{1.25};
+    constexpr qreal kWheelNotchDelta{120.0};
+    constexpr qreal kMinZoom{1.0};
+    constexpr qreal kMaxZoom{16.0};
+}  // namespace
+
+ApplicationGraphicsView::ApplicationGraphicsView(ApplicationGraphicsScene* scene, QSize viewSize)
     : QGraphicsView(scene),
+      applicationScene_(scene),
+      qualityGovernor_(new RenderQualityGovernor{this}),
       viewSize_(viewSize)
 {
     setMouseTracking(true);
@@ -12,6 +28,13 @@ ApplicationGraphicsView::ApplicationGraphicsView(QGraphicsScene* scene, QSize vi
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setSceneRect(0, 0, viewSize_.width() + 1, viewSize_.height() + 1);
     setFixedSize(viewSize_.width() + 3, viewSize_.height() + 3);
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    connect(qualityGovernor_, &RenderQualityGovernor::fullQualityRestored,
+            this, &ApplicationGraphicsView::fullQualityRestored);
+}
+
+ApplicationGraphicsScene* ApplicationGraphicsView::applicationScene() const noexcept {
+    return applicationScene_;
 }
 
 bool ApplicationGraphicsView::event(QEvent* event) {
@@ -22,3 +45,36 @@ bool ApplicationGraphicsView::event(QEvent* event) {
 
     return QGraphicsView::event(event);
 }
+
+bool ApplicationGraphicsView::viewportEvent(QEvent* event) {
+    // Dragging with any button held moves, rotates, selects or draws something, which is painted in draft quality.
+    if (event->type() == QEvent::MouseMove && static_cast<QMouseEvent*>(event)->buttons() != Qt::NoButton) {
+        qualityGovernor_->noteInteraction();
+    } else if (event->type() == QEvent::Wheel) {
+        qualityGovernor_->noteInteraction();
+    }
+    return QGraphicsView::viewportEvent(event);
+}
+
+void ApplicationGraphicsView::paintEvent(QPaintEvent* event) {
+    QGraphicsView::paintEvent(event);
+    emit framePainted(mapToScene(viewport()->rect()).boundingRect(), transform(), qualityGovernor_->isDraft());
+}
+
+void ApplicationGraphicsView::wheelEvent(QWheelEvent* event) {
+    // The scene rectangle is the canvas, zooming in lets a part of it be looked at closer and panned around.
+    qreal zoom = transform().m11();
+    qreal newZoom = std::clamp(zoom * std::pow(kZoomStep, event->angleDelta().y() / kWheelNotchDelta),
+                               kMinZoom,
+                               kMaxZoom);
+    if (!qFuzzyCompare(zoom, newZoom)) {
+        scale(newZoom / zoom, newZoom / zoom);
+        emit visibleAreaChanged();
+    }
+    event->accept();
+}
+
+void ApplicationGraphicsView::scrollContentsBy(int dx, int dy) {
+    QGraphicsView::scrollContentsBy(dx, dy);
+    emit visibleAreaChanged();
+}
@@ -0,0 +1,115 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include "../include/item-attribute-index.h"
+#include "../include/stroke-item.h"
+#include "../include/bezier-path-item.h"
+
+namespace {
+    struct ItemStyle {
+        QPen pen{Qt::NoPen};
+        QBrush brush{Qt::NoBrush};
+
+        bool operator==(const ItemStyle& other) const {
+            return pen == other.pen && brush == other.brush;
+        }
+    };
+
+    template<typename ItemType>
+    ItemStyle shapeStyle(const ItemType* item) {
+        return ItemStyle{item->pen(), item->brush()};
+    }
+
+    ItemStyle itemStyle(const QGraphicsItem* item) {
+        if (const auto* rectItem = qgraphicsitem_cast<const QGraphicsRectItem*>(item)) {
+            return shapeStyle(rectItem);
+        } else if (const auto* ellipseItem = qgraphicsitem_cast<const QGraphicsEllipseItem*>(item)) {
+            return shapeStyle(ellipseItem);
+        } else if (const auto* polygonItem = qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)) {
+            return shapeStyle(polygonItem);
+        } else if (const auto* pathItem = qgraphicsitem_cast<const QGraphicsPathItem*>(item)) {
+            return shapeStyle(pathItem);
+        } else if (const auto* lineItem = qgraphicsitem_cast<const QGraphicsLineItem*>(item)) {
+            return ItemStyle{lineItem->pen()};
+        } else if (const auto* strokeItem = qgraphicsitem_cast<const StrokeItem*>(item)) {
+            return ItemStyle{strokeItem->pen()};
+        } else if (const auto* bezierItem = qgraphicsitem_cast<const BezierPathItem*>(item)) {
+            return ItemStyle{bezierItem->pen()};
+        }
+        return ItemStyle{};
+    }
+}  // namespace
+
+namespace detail {
+
+    size_t qHash(const AttributesKey& key, size_t seed) noexcept {
+        return qHashMulti(seed, key.type, key.pen, key.brush, key.isExact);
+    }
+
+    AttributesKey itemAttributesKey(const QGraphicsItem* item) {
+        ItemStyle style = itemStyle(item);
+        auto penKey = penStyleKey(style.pen);
+        auto brushKey = brushStyleKey(style.brush);
+        if (!penKey || !brushKey) return AttributesKey{item->type(), {}, {}, false};
+        return AttributesKey{item->type(), *penKey, *brushKey, true};
+    }
+
+}  // namespace detail
+
+void ItemAttributeIndex::insert(QGraphicsItem* item) {
+    remove(item);
+    auto key = detail::itemAttributesKey(item);
+    keys_.insert(item, key);
+    buckets_[key].insert(item);
+}
+
+void ItemAttributeIndex::remove(QGraphicsItem* item) {
+    auto keyIt = keys_.find(item);
+    if (keyIt == keys_.end()) return;
+
+    auto bucketIt = buckets_.find(*keyIt);
+    bucketIt->remove(item);
+    if (bucketIt->isEmpty()) buckets_.erase(bucketIt);
+    keys_.erase(keyIt);
+}
+
+void ItemAttributeIndex::clear() {
+    buckets_.clear();
+    keys_.clear();
+}
+
+QList<QGraphicsItem*> ItemAttributeIndex::similarItems(const QList<QGraphicsItem*>& samples) const {
+    QSet<detail::AttributesKey> exactKeys;
+    QHash<detail::AttributesKey, QList<ItemStyle>> inexactStyles;
+    for (const auto* sample : samples) {
+        auto keyIt = keys_.find(sample);
+        if (keyIt == keys_.end()) continue;
+        if (keyIt->isExact) {
+            exactKeys.insert(*keyIt);
+        } else {
+            ItemStyle style = itemStyle(sample);
+            auto& styles = inexactStyles[*keyIt];
+            if (!styles.contains(style)) styles.push_back(style);
+        }
+    }
+
+    QList<QGraphicsItem*> similar;
+    for (const auto& key : std::as_const(exactKeys)) {
+        const auto bucket = buckets_.value(key);
+        similar.reserve(similar.size() + bucket.size());
+        for (auto* item : bucket) {
+            similar.push_back(item);
+        }
+    }
+    // Only the few items with gradient or textured styles are compared one by one.
+    for (auto it = inexactStyles.cbegin(); it != inexactStyles.cend(); ++it) {
+        for (auto* item : buckets_.value(it.key())) {
+            if (it->contains(itemStyle(item))) similar.push_back(item);
+        }
+    }
+    return similar;
+}
+
+qsizetype ItemAttributeIndex::size() const noexcept {
+    return keys_.size();
+}
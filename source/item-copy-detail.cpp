@@ -0,0 +1,45 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include "../include/item-copy-detail.h"
+#include "../include/graphics-items-detail.h"
+
+namespace detail {
+
+    QGraphicsPixmapItem* copyPixmapItem(const QGraphicsPixmapItem* originalItem) {
+        auto* copiedItem = new QGraphicsPixmapItem{originalItem->pixmap()};
+        copiedItem->setTransformationMode(originalItem->transformationMode());
+        copiedItem->setPos(originalItem->scenePos());
+        copiedItem->setScale(originalItem->scale());
+        copiedItem->setTransformOriginPoint(originalItem->transformOriginPoint());
+        copiedItem->setRotation(originalItem->rotation());
+        return copiedItem;
+    }
+
+    QGraphicsItem* cloneGraphicsItem(QGraphicsItem* originalItem) {
+        QGraphicsItem* copiedItem = nullptr;
+
+        if (auto* rectItem = qgraphicsitem_cast<QGraphicsRectItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(rectItem);
+        } else if (auto* ellipseItem = qgraphicsitem_cast<QGraphicsEllipseItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(ellipseItem);
+        } else if (auto* polygonItem = qgraphicsitem_cast<QGraphicsPolygonItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(polygonItem);
+        } else if (auto* pathItem = qgraphicsitem_cast<QGraphicsPathItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(pathItem);
+        } else if (auto* lineItem = qgraphicsitem_cast<QGraphicsLineItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(lineItem);
+        } else if (auto* strokeItem = qgraphicsitem_cast<StrokeItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(strokeItem);
+        } else if (auto* bezierItem = qgraphicsitem_cast<BezierPathItem*>(originalItem)) {
+            copiedItem = copyGraphicsItem(bezierItem);
+        } else if (auto* pixmapItem = qgraphicsitem_cast<QGraphicsPixmapItem*>(originalItem)) {
+            copiedItem = copyPixmapItem(pixmapItem);
+        }
+
+        if (copiedItem != nullptr)
+            makeItemSelectableAndMovable(copiedItem);
+
+        return copiedItem;
+    }
+
+}  // namespace detail
@@ -0,0 +1,83 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include <cmath>
+#include "../include/item-grid.h"
+
+ItemGrid::ItemGrid(qreal cellSize)
+    : cellSize_(cellSize),
+      lookup_(0)
+{
+}
+
+QRectF ItemGrid::update(QGraphicsItem* item) {
+    QRectF bounds = item->sceneBoundingRect();
+    QRect cells = cellsOf(bounds);
+    auto it = entries_.find(item);
+    if (it == entries_.end()) {
+        entries_.insert(item, Entry{bounds, cells, 0});
+        link(item, cells);
+        return {};
+    }
+
+    QRectF previousBounds = it->bounds;
+    it->bounds = bounds;
+    if (it->cells != cells) {
+        unlink(item, it->cells);
+        link(item, cells);
+        it->cells = cells;
+    }
+    return previousBounds;
+}
+
+QRectF ItemGrid::remove(QGraphicsItem* item) {
+    auto it = entries_.find(item);
+    if (it == entries_.end()) return {};
+    QRectF bounds = it->bounds;
+    unlink(item, it->cells);
+    entries_.erase(it);
+    return bounds;
+}
+
+void ItemGrid::clear() {
+    entries_.clear();
+    cells_.clear();
+}
+
+bool ItemGrid::contains(const QGraphicsItem* item) const {
+    return entries_.contains(item);
+}
+
+QRectF ItemGrid::bounds(const QGraphicsItem* item) const {
+    auto it = entries_.constFind(item);
+    return it != entries_.cend() ? it->bounds : QRectF{};
+}
+
+QRect ItemGrid::cellsOf(const QRectF& rect) const {
+    if (rect.isEmpty()) return {};
+    return QRect{QPoint{static_cast<int>(std::floor(rect.left() / cellSize_)),
+                        static_cast<int>(std::floor(rect.top() / cellSize_))},
+                 QPoint{static_cast<int>(std::floor(rect.right() / cellSize_)),
+                        static_cast<int>(std::floor(rect.bottom() / cellSize_))}};
+}
+
+void ItemGrid::link(QGraphicsItem* item, const QRect& cells) {
+    if (cells.isEmpty()) return;
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            cells_[QPoint{x, y}].push_back(item);
+        }
+    }
+}
+
+void ItemGrid::unlink(QGraphicsItem* item, const QRect& cells) {
+    if (cells.isEmpty()) return;
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            auto cell = cells_.find(QPoint{x, y});
+            if (cell == cells_.end()) continue;
+            cell->removeOne(item);
+            if (cell->isEmpty()) cells_.erase(cell);
+        }
+    }
+}
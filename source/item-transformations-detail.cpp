@@ -0,0 +1,39 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <qmath.h>
+#include "../include/item-transformations-detail.h"
+
+namespace detail {
+
+    QPointF getGraphicsItemSceneCenterPos(const QGraphicsItem* item) {
+        if (const auto* polygonItem = qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)) {
+            return getPolygonCenterRelativeTo<CoordsType::kSceneCoords>(polygonItem);
+        } else {
+            return item->sceneBoundingRect().center();
+        }
+    }
+
+    QPointF getGraphicsItemOwnCenterPos(const QGraphicsItem* item) {
+        if (const auto* polygonItem = qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)) {
+            return getPolygonCenterRelativeTo<CoordsType::kItemCoords>(polygonItem);
+        } else {
+            return item->boundingRect().center();
+        }
+    }
+
+    qreal calculateRotationAngle(const QPointF& geometricCenterO,
+                                 const QPointF& initialCursorPosA,
+                                 const QPointF& currentCursorPosB) noexcept {
+        qreal angleAO = qAtan2(initialCursorPosA.y() - geometricCenterO.y(),
+                               initialCursorPosA.x() - geometricCenterO.x());
+        qreal angleBO = qAtan2(currentCursorPosB.y() - geometricCenterO.y(),
+                               currentCursorPosB.x() - geometricCenterO.x());
+
+        qreal angle = angleBO - angleAO;
+
+        if (angle < 0) angle += 2 * M_PI;
+
+        return qRadiansToDegrees(angle);
+    }
+
+}  // namespace detail
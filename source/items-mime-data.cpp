@@ -0,0 +1,83 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <string_view>
+#include "../include/items-mime-data.h"
+
+namespace {
+    using std::operator ""sv;
+
+    constexpr auto kItemsMimeType{"application/x-qt-painter-items"sv};
+    constexpr auto kSvgMimeType{"image/svg+xml"sv};
+    constexpr quint32 kItemsPayloadMagic{0x51504943};
+    constexpr QDataStream::Version kStreamVersion{QDataStream::Qt_6_5};
+}  // namespace
+
+ItemsMimeData::ItemsMimeData(QList<ItemSnapshot> items)
+    : items_(std::move(items)) {}
+
+const QList<ItemSnapshot>& ItemsMimeData::getItems() const noexcept {
+    return items_;
+}
+
+QStringList ItemsMimeData::formats() const {
+    return {kItemsMimeType.data(), kSvgMimeType.data()};
+}
+
+bool ItemsMimeData::hasFormat(const QString& mimeType) const {
+    return mimeType == kItemsMimeType.data() || mimeType == kSvgMimeType.data();
+}
+
+std::optional<QList<ItemSnapshot>> ItemsMimeData::decodeItems(const QMimeData* mimeData) {
+    if (mimeData == nullptr) return std::nullopt;
+    if (const auto* itemsMimeData = qobject_cast<const ItemsMimeData*>(mimeData)) return itemsMimeData->getItems();
+    if (!mimeData->hasFormat(kItemsMimeType.data())) return std::nullopt;
+
+    QDataStream stream{mimeData->data(kItemsMimeType.data())};
+    stream.setVersion(kStreamVersion);
+
+    quint32 magic = 0;
+    QList<ItemSnapshot> items;
+    stream >> magic >> items;
+    if (magic != kItemsPayloadMagic || stream.status() != QDataStream::Ok) return std::nullopt;
+    return items;
+}
+
+QVariant ItemsMimeData::retrieveData(const QString& mimeType, QMetaType type) const {
+    if (mimeType == kItemsMimeType.data()) return encodeItems();
+    if (mimeType == kSvgMimeType.data()) return renderSvg();
+    return QMimeData::retrieveData(mimeType, type);
+}
+
+QByteArray ItemsMimeData::encodeItems() const {
+    QByteArray payload;
+    QDataStream stream{&payload, QIODevice::WriteOnly};
+    stream.setVersion(kStreamVersion);
+    stream << kItemsPayloadMagic << items_;
+    return payload;
+}
+
+QByteArray ItemsMimeData::renderSvg() const {
+    QRectF boundingRect;
+    for (const auto& item : items_) {
+        boundingRect |= item.sceneBoundingRect();
+    }
+
+    QBuffer buffer;
+    QSvgGenerator generator;
+    generator.setOutputDevice(&buffer);
+    generator.setSize(boundingRect.size().toSize());
+    generator.setViewBox(boundingRect);
+
+    QPainter painter;
+    if (!painter.begin(&generator)) return {};
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (const auto& item : items_) {
+        detail::paintItemSnapshot(painter, item);
+    }
+    painter.end();
+    return buffer.data();
+}
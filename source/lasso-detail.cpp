@@ -0,0 +1,35 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <algorithm>
+#include "../include/lasso-detail.h"
+
+namespace {
+    constexpr qsizetype kMinPolygonPointsCount{3};
+}  // namespace
+
+namespace detail {
+
+    void testPointsInPolygon(const float* xs, const float* ys, std::size_t count,
+                             const QPolygonF& polygon, std::uint8_t* isInside) noexcept {
+        std::fill_n(isInside, count, std::uint8_t{0});
+        if (polygon.size() < kMinPolygonPointsCount) return;
+
+        for (qsizetype i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+            auto x1 = static_cast<float>(polygon[j].x());
+            auto y1 = static_cast<float>(polygon[j].y());
+            auto x2 = static_cast<float>(polygon[i].x());
+            auto y2 = static_cast<float>(polygon[i].y());
+            // A horizontal edge is never crossed by a horizontal ray.
+            if (y1 == y2) continue;
+
+            float slope = (x2 - x1) / (y2 - y1);
+            for (std::size_t k = 0; k < count; ++k) {
+                float y = ys[k];
+                bool isSpanned = (y < y1) != (y < y2);
+                float crossingX = x1 + (y - y1) * slope;
+                isInside[k] ^= static_cast<std::uint8_t>(isSpanned & (xs[k] < crossingX));
+            }
+        }
+    }
+
+}  // namespace detail
@@ -0,0 +1,165 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include "../include/layer-item.h"
+#include "../include/raster-paint-layer.h"
+
+namespace {
+    constexpr qreal kNoCacheScale{0.0};
+}
+
+LayerItem::LayerItem(const QString& name, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      name_(name),
+      cacheScale_(kNoCacheScale),
+      frontZValue_(0.0),
+      backZValue_(0.0),
+      rasterSurface_(nullptr),
+      isLocked_(false),
+      isCached_(false)
+{
+    setFlag(QGraphicsItem::ItemHasNoContents, true);
+    setFlag(QGraphicsItem::ItemIsSelectable, false);
+    setFlag(QGraphicsItem::ItemIsMovable, false);
+}
+
+int LayerItem::type() const {
+    return Type;
+}
+
+QRectF LayerItem::boundingRect() const {
+    return cacheRect_;
+}
+
+QPainterPath LayerItem::shape() const {
+    return {};
+}
+
+bool LayerItem::contains(const QPointF&) const {
+    return false;
+}
+
+void LayerItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*) {
+    if (!isCached_) return;
+
+    qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    if (!qFuzzyCompare(scale, cacheScale_)) renderCache(scale);
+    if (!cache_.isNull()) painter->drawPixmap(cacheRect_, cache_, QRectF{cache_.rect()});
+}
+
+const QString& LayerItem::getName() const noexcept {
+    return name_;
+}
+
+bool LayerItem::isLocked() const noexcept {
+    return isLocked_;
+}
+
+bool LayerItem::isCached() const noexcept {
+    return isCached_;
+}
+
+void LayerItem::setName(const QString& name) {
+    name_ = name;
+}
+
+void LayerItem::setLocked(bool isLocked) {
+    isLocked_ = isLocked;
+}
+
+void LayerItem::setCached(bool isCached) {
+    if (isCached_ == isCached) return;
+    isCached_ = isCached;
+
+    prepareGeometryChange();
+    if (isCached_) {
+        cacheRect_ = calculateContentRect();
+        cacheScale_ = kNoCacheScale;
+    } else {
+        cacheRect_ = QRectF{};
+        cache_ = QPixmap{};
+    }
+    setFlag(QGraphicsItem::ItemHasNoContents, !isCached_);
+    setChildrenVisible(!isCached_);
+}
+
+void LayerItem::invalidateCache() {
+    if (!isCached_) return;
+    prepareGeometryChange();
+    cacheRect_ = calculateContentRect();
+    cacheScale_ = kNoCacheScale;
+    update();
+}
+
+qreal LayerItem::takeFrontZValue() noexcept {
+    frontZValue_ += 1.0;
+    return frontZValue_;
+}
+
+qreal LayerItem::takeBackZValue() noexcept {
+    backZValue_ -= 1.0;
+    return backZValue_;
+}
+
+void LayerItem::renumberChildren() {
+    // A copy, since the children are sorted again as their z-values change.
+    const QList<QGraphicsItem*> children = childItems();
+    backZValue_ = 0.0;
+    frontZValue_ = 0.0;
+    for (auto* child : children) {
+        child->setZValue(takeFrontZValue());
+    }
+}
+
+RasterPaintLayer* LayerItem::rasterSurface(const QRectF& canvas) {
+    if (rasterSurface_ == nullptr) {
+        rasterSurface_ = new RasterPaintLayer{canvas, this};
+        rasterSurface_->setZValue(takeFrontZValue());
+        rasterSurface_->setVisible(!isCached_);
+        invalidateCache();
+    }
+    return rasterSurface_;
+}
+
+void LayerItem::renderCache(qreal scale) {
+    cacheScale_ = scale;
+    QSize pixmapSize = (cacheRect_.size() * scale).toSize();
+    if (pixmapSize.isEmpty()) {
+        cache_ = QPixmap{};
+        return;
+    }
+
+    cache_ = QPixmap{pixmapSize};
+    cache_.fill(Qt::transparent);
+
+    QPainter painter{&cache_};
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(scale, scale);
+    painter.translate(-cacheRect_.topLeft());
+
+    for (auto* child : childItems()) {
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = child->boundingRect();
+        option.rect = option.exposedRect.toAlignedRect();
+
+        painter.save();
+        painter.setTransform(child->itemTransform(this), true);
+        child->paint(&painter, &option, nullptr);
+        painter.restore();
+    }
+}
+
+void LayerItem::setChildrenVisible(bool isVisible) {
+    for (auto* child : childItems()) {
+        child->setVisible(isVisible);
+    }
+}
+
+QRectF LayerItem::calculateContentRect() const {
+    QRectF contentRect;
+    for (const auto* child : childItems()) {
+        contentRect |= child->mapRectToParent(child->boundingRect());
+    }
+    return contentRect;
+}
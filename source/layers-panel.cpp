@@ -0,0 +1,111 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QHBoxLayout>
+#include <QListWidget>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <string_view>
+#include "../include/layers-panel.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+
+namespace {
+    using std::operator ""sv;
+
+    constexpr auto kLayerNameTemplate{"Layer %1"sv};
+    constexpr auto kAddButtonText{"Add"sv};
+    constexpr auto kRemoveButtonText{"Remove"sv};
+    constexpr auto kLockButtonText{"Lock"sv};
+
+    constexpr Qt::GlobalColor kLockedLayerTextColor{Qt::gray};
+}  // namespace
+
+LayersPanel::LayersPanel(ApplicationGraphicsScene* scene, QWidget* parent)
+    : QWidget(parent),
+      scene_(scene),
+      layersList_(new QListWidget{this}),
+      addButton_(new QPushButton{kAddButtonText.data(), this}),
+      removeButton_(new QPushButton{kRemoveButtonText.data(), this}),
+      lockButton_(new QPushButton{kLockButtonText.data(), this}),
+      createdLayersCount_(static_cast<int>(scene->getLayers().size())),
+      isUpdating_(false)
+{
+    lockButton_->setCheckable(true);
+    setUpLayout();
+    setUpConnections();
+    updateLayersList();
+}
+
+void LayersPanel::setUpLayout() {
+    auto* buttonsLayout = new QHBoxLayout{};
+    buttonsLayout->addWidget(addButton_);
+    buttonsLayout->addWidget(removeButton_);
+    buttonsLayout->addWidget(lockButton_);
+
+    auto* layout = new QVBoxLayout{this};
+    layout->addWidget(layersList_);
+    layout->addLayout(buttonsLayout);
+}
+
+void LayersPanel::setUpConnections() {
+    // Queued, because the list must not be rebuilt from inside of its own signals.
+    connect(scene_, &ApplicationGraphicsScene::layersChanged, this, &LayersPanel::updateLayersList, Qt::QueuedConnection);
+    connect(addButton_, &QPushButton::clicked, this, &LayersPanel::addLayer);
+    connect(removeButton_, &QPushButton::clicked, this, &LayersPanel::removeLayer);
+    connect(lockButton_, &QPushButton::toggled, this, &LayersPanel::setActiveLayerLocked);
+    connect(layersList_, &QListWidget::itemChanged, this, &LayersPanel::applyLayerItemChanges);
+    connect(layersList_, &QListWidget::currentRowChanged, this, &LayersPanel::activateLayer);
+}
+
+LayerItem* LayersPanel::layerAt(int row) const {
+    // The topmost layer is shown in the first row.
+    const auto& layers = scene_->getLayers();
+    qsizetype index = layers.size() - 1 - row;
+    return (row >= 0 && index >= 0) ? layers[index] : nullptr;
+}
+
+void LayersPanel::updateLayersList() {
+    isUpdating_ = true;
+    layersList_->clear();
+
+    const auto& layers = scene_->getLayers();
+    for (auto layer = layers.crbegin(); layer != layers.crend(); ++layer) {
+        auto* listItem = new QListWidgetItem{(*layer)->getName(), layersList_};
+        listItem->setFlags(listItem->flags() | Qt::ItemIsUserCheckable | Qt::ItemIsEditable);
+        listItem->setCheckState((*layer)->isVisible() ? Qt::Checked : Qt::Unchecked);
+        if ((*layer)->isLocked()) listItem->setForeground(QColor{kLockedLayerTextColor});
+        if (*layer == scene_->getActiveLayer()) layersList_->setCurrentItem(listItem);
+    }
+
+    auto* activeLayer = scene_->getActiveLayer();
+    lockButton_->setChecked(activeLayer != nullptr && activeLayer->isLocked());
+    removeButton_->setEnabled(layers.size() > 1);
+    isUpdating_ = false;
+}
+
+void LayersPanel::addLayer() {
+    scene_->addLayer(QString{kLayerNameTemplate.data()}.arg(++createdLayersCount_));
+}
+
+void LayersPanel::removeLayer() {
+    if (auto* layer = layerAt(layersList_->currentRow())) scene_->removeLayer(layer);
+}
+
+void LayersPanel::setActiveLayerLocked(bool isLocked) {
+    if (isUpdating_) return;
+    if (auto* layer = scene_->getActiveLayer()) scene_->setLayerLocked(layer, isLocked);
+}
+
+void LayersPanel::applyLayerItemChanges(QListWidgetItem* listItem) {
+    if (isUpdating_) return;
+    auto* layer = layerAt(layersList_->row(listItem));
+    if (layer == nullptr) return;
+
+    scene_->setLayerName(layer, listItem->text());
+    scene_->setLayerVisible(layer, listItem->checkState() == Qt::Checked);
+}
+
+void LayersPanel::activateLayer(int row) {
+    if (isUpdating_) return;
+    if (auto* layer = layerAt(row)) scene_->setActiveLayer(layer);
+}
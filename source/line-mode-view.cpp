@@ -3,6 +3,7 @@
 #include <QGraphicsLineItem>
 #include <QMouseEvent>
 #include "../include/line-mode-view.h"
+#include "../include/graphics-scene.h"
 #include "../include/graphics-items-detail.h"
 #include "../include/constants.h"
 
@@ -10,24 +11,17 @@ namespace {
     constexpr qreal kDefaultLineWidth{5.0};
 }
 
-LineModeView::LineModeView(QGraphicsScene *scene, QSize viewSize)
+LineModeView::LineModeView(ApplicationGraphicsScene *scene, QSize viewSize)
     : DrawingGraphicsView(scene, viewSize, kDefaultLineWidth),
       currentItem_(nullptr),
       startCursorPos_(constants::kZeroPointF) {}
 
 void LineModeView::mousePressEvent(QMouseEvent *event) {
-    if (event->button() == Qt::LeftButton) {
+    if (event->button() == Qt::LeftButton && applicationScene()->isActiveLayerEditable()) {
         startCursorPos_ = mapToScene(event->pos());
-        currentItem_ = scene()->addLine(QLineF{startCursorPos_,
-                                               startCursorPos_},
-                                        QPen{strokeColor_,
-                                             strokeWidth_,
-                                             Qt::SolidLine,
-                                             Qt::SquareCap,
-                                             Qt::MiterJoin});
-
-        if (currentItem_ != nullptr)
-            detail::makeItemSelectableAndMovable(currentItem_);
+        currentItem_ = previewPool_.acquire(scene());
+        currentItem_->setLine(QLineF{startCursorPos_, startCursorPos_});
+        currentItem_->setPen(shapePen());
     }
 }
 
@@ -43,7 +37,10 @@ void LineModeView::mouseMoveEvent(QMouseEvent *event) {
 void LineModeView::mouseReleaseEvent(QMouseEvent *event) {
     if (event->button() == Qt::LeftButton && currentItem_ != nullptr) {
         if (currentItem_->line().p1() == currentItem_->line().p2()) {
-            detail::deleteItem(scene(), currentItem_);
+            previewPool_.release(currentItem_);
+        } else {
+            detail::makeItemSelectableAndMovable(currentItem_);
+            applicationScene()->addItemToActiveLayer(currentItem_);
         }
         currentItem_ = nullptr;
     }
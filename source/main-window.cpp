@@ -4,24 +4,51 @@
 #include <QGraphicsView>
 #include <QToolBar>
 #include <QPushButton>
-#include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QStringView>
 #include <QMenuBar>
+#include <QMenu>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QLatin1String>
 #include <QToolButton>
 #include <QSpinBox>
 #include <QStatusBar>
 #include <QColorDialog>
 #include <QLabel>
+#include <QDockWidget>
+#include <QLocale>
+#include <QPixmapCache>
+#include <QHash>
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QThreadPool>
+#include <memory>
 #include <string_view>
 #include "../include/main-window.h"
+#include "../include/graphics-scene.h"
+#include "../include/layers-panel.h"
 #include "../include/modification-mode-view.h"
 #include "../include/rect-like-shapes-mode.h"
 #include "../include/polygon-mode-view.h"
 #include "../include/line-mode-view.h"
 #include "../include/brush-mode-view.h"
+#include "../include/fill-mode-view.h"
+#include "../include/bezier-mode-view.h"
 #include "../include/graphics-items-detail.h"
+#include "../include/startup-timer.h"
+#include "../include/async-detail.h"
+#include "../include/document-file.h"
+#include "../include/document-model.h"
+#include "../include/render-cache-policy.h"
+#include "../include/document-loader.h"
+#include "../include/document-diff.h"
+#include "../include/diff-overlay-item.h"
+#include "../include/pdf-exporter.h"
+#include "../include/layer-item.h"
+#include "../include/tiled-image-item.h"
+#include "../include/scene-mirror.h"
+#include "../include/scene-navigator.h"
 
 
 namespace {
@@ -33,13 +60,51 @@ namespace {
     constexpr auto kBrushModeIconPath{":/images/buttons/imgs/brushimg.png"sv};
     constexpr auto kLineModeIconPath{":/images/buttons/imgs/lineimg.png"sv};
     constexpr auto kPolygonModeIconPath{":/images/buttons/imgs/polygonimg.png"sv};
+    constexpr auto kFillModeIconPath{":/images/buttons/imgs/fillimg.png"sv};
+    constexpr auto kBezierModeIconPath{":/images/buttons/imgs/bezierimg.png"sv};
+    constexpr auto kRasterBrushIconPath{":/images/buttons/imgs/rasterbrushimg.png"sv};
     constexpr auto kToolBarStyleSheetPath{":/styles/toolbarbtnstylesheet.qss"sv};
     constexpr auto kChooseColorSuggestion{"Choose color"sv};
+    constexpr auto kRasterBrushActionText{"Raster brush"sv};
+    constexpr auto kDefaultLayerName{"Layer 1"sv};
+    constexpr auto kLayersPanelTitle{"Layers"sv};
+    constexpr auto kFlatteningReclaimedReport{"Flattened %1 items, about %2 of memory reclaimed"sv};
+    constexpr auto kSimilarSelectionReport{"Selected %1 similar items"sv};
+    constexpr auto kFileMenuTitle{"&File"sv};
+    constexpr auto kOpenActionText{"&Open..."sv};
+    constexpr auto kSaveActionText{"&Save As..."sv};
+    constexpr auto kDocumentFilesFilter{"Painter documents (*.qpd)"sv};
+    constexpr auto kExportPdfActionText{"&Export PDF..."sv};
+    constexpr auto kExportPdfPagesActionText{"Export PDF in &Pages..."sv};
+    constexpr auto kPdfFilesFilter{"PDF files (*.pdf)"sv};
+    constexpr auto kExportProgressFormat{"Exporting %p%"sv};
+    constexpr auto kExportPdfError{"The PDF file can not be written."sv};
+    constexpr auto kCompareActionText{"&Compare With..."sv};
+    constexpr auto kClearComparisonActionText{"C&lear Comparison"sv};
+    constexpr auto kComparingReport{"Comparing the drawings..."sv};
+    constexpr auto kComparisonReport{"Compared with %1: %2 added, %3 removed, %4 moved, %5 restyled, %6 unchanged"sv};
+    constexpr auto kCompareDocumentError{"The document can not be compared."sv};
+    constexpr auto kImportBackgroundActionText{"&Import Background..."sv};
+    constexpr auto kBackgroundFilesFilter{"Images (*.png *.jpg *.jpeg *.tif *.tiff *.bmp)"sv};
+    constexpr auto kBackgroundPreparingReport{"Preparing the background image..."sv};
+    constexpr auto kImportBackgroundError{"The image can not be imported."sv};
+    constexpr auto kMirroringMenuTitle{"&Mirroring"sv};
+    constexpr auto kBroadcastActionText{"&Broadcast drawing"sv};
+    constexpr auto kFollowActionText{"&Follow drawing"sv};
+    constexpr auto kMirrorServerName{"qt_painter_mirror"sv};
+    constexpr auto kBroadcastingError{"Broadcasting can not be started"sv};
+    constexpr auto kFollowingStoppedReport{"Following stopped"sv};
+    constexpr auto kOpenDocumentError{"The document can not be opened."sv};
+    constexpr auto kLoadingProgressFormat{"Loading %p%"sv};
+    constexpr auto kSaveDocumentError{"The document can not be saved."sv};
+    constexpr auto kFlatteningGrownReport{"Flattened %1 items, about %2 of memory used additionally"sv};
 
     constexpr Qt::GlobalColor kDefaultSceneBackgroundColor{Qt::white};
     constexpr QSize kDefaultBtnIconSize{24, 24};
 
     constexpr int kDefaultStatusBarCursorLabelSize{45};
+    constexpr int kLoadingProgressBarWidth{160};
+    constexpr int kStatusBarReportTimeoutMs{5000};
 }  // namespace
 
 QSize defineWindowSize();
@@ -47,30 +112,52 @@ QSize calcWindowRelativeSize(QSize wSize, double x);
 
 MainWindow::MainWindow(QSize viewSize, QWidget *parent)
     : QMainWindow{parent},
-      graphicsScene_(new QGraphicsScene{this}),
+      graphicsScene_(new ApplicationGraphicsScene{this}),
       stackedWidget_(new QStackedWidget{this}),
+      navigator_(nullptr),
       toolBar_(new QToolBar{this}),
       statusBar_(new QStatusBar{this}),
       modificationModeView_(nullptr),
+      brushModeView_(nullptr),
+      documentModel_(new DocumentModel{graphicsScene_, this}),
+      renderCachePolicy_(new RenderCachePolicy{graphicsScene_, this}),
+      documentLoader_(new DocumentLoader{graphicsScene_, this}),
+      mirrorPublisher_(nullptr),
+      mirrorFollower_(nullptr),
+      broadcastAction_(nullptr),
+      followAction_(nullptr),
       strokeWidthSpinBox_(new QSpinBox{}),
       fillColorAction_(nullptr),
       strokeColorAction_(nullptr),
       strokeWidthAction_(nullptr),
+      rasterBrushAction_(nullptr),
       labelCursorPosX_(new QLabel{this}),
       labelCursorPosY_(new QLabel{this}),
+      loadingProgressBar_(new QProgressBar{this}),
+      exportProgressBar_(new QProgressBar{this}),
+      diffOverlay_(nullptr),
       windowSize_(defineWindowSize()),
       graphicsViewsSize_(viewSize),
+      currentModeIndex_(0),
       isModified_(false)
 {
     setUpScreen();
     setUpWidgetsPlacement();
     setUpScene();
+    setUpLayersPanel();
+    setUpFileMenu();
+    setUpMirroringMenu();
     addGraphicsViews();
     setUpApplicationStyles();
     setUpDrawingPropertiesButtons();
     setUpToolBarActionsConnections();
     setUpStatusBar();
-    setUpConnectionsForStatusBar();
+
+    // The modification mode is active at startup, the other views are created on demand.
+    auto* initialView = modeView(currentModeIndex_);
+    stackedWidget_->setCurrentWidget(initialView);
+    initialView->viewport()->installEventFilter(this);
+    setUpNavigator(initialView);
 }
 
 QSize defineWindowSize() {
@@ -80,6 +167,14 @@ QSize defineWindowSize() {
 
 MainWindow::~MainWindow() = default;
 
+bool MainWindow::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::Paint && !StartupTimer::instance().isFinished()) {
+        StartupTimer::instance().finish();
+        watched->removeEventFilter(this);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
 void MainWindow::setUpScreen() {
     auto [screenWidth, screenHeight] = QGuiApplication::primaryScreen()->size();
     auto [windowWidth, windowHeight] =
@@ -101,11 +196,19 @@ QSize calcWindowRelativeSize(QSize wSize, double x) {
 
 void MainWindow::setUpStackedWidgetLayout() {
     auto* centralWidget = new QWidget{this};
-    auto* layout = new QVBoxLayout{centralWidget};
+    auto* layout = new QHBoxLayout{centralWidget};
     layout->addWidget(stackedWidget_, 0, Qt::AlignCenter);
     setCentralWidget(centralWidget);
 }
 
+// The scene rectangle of a view is the canvas, which the navigator shows as a whole.
+void MainWindow::setUpNavigator(ApplicationGraphicsView* view) {
+    navigator_ = new SceneNavigator{graphicsScene_, view->sceneRect(), this};
+    navigator_->setView(view);
+    centralWidget()->layout()->addWidget(navigator_);
+    centralWidget()->layout()->setAlignment(navigator_, Qt::AlignTop);
+}
+
 void MainWindow::setUpWidgetsPlacement() {
     addToolBar(toolBar_);
     setStatusBar(statusBar_);
@@ -115,6 +218,43 @@ void MainWindow::setUpWidgetsPlacement() {
 void MainWindow::setUpScene() {
     graphicsScene_->setItemIndexMethod(QGraphicsScene::NoIndex);
     graphicsScene_->setBackgroundBrush(QBrush{kDefaultSceneBackgroundColor});
+    graphicsScene_->addLayer(kDefaultLayerName.data());
+}
+
+void MainWindow::setUpLayersPanel() {
+    auto* dockWidget = new QDockWidget{kLayersPanelTitle.data(), this};
+    dockWidget->setWidget(new LayersPanel{graphicsScene_, dockWidget});
+    dockWidget->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+    addDockWidget(Qt::RightDockWidgetArea, dockWidget);
+}
+
+void MainWindow::setUpFileMenu() {
+    auto* fileMenu = menuBar()->addMenu(kFileMenuTitle.data());
+    fileMenu->addAction(kOpenActionText.data(), QKeySequence::Open, this, &MainWindow::openDocument);
+    fileMenu->addAction(kSaveActionText.data(), QKeySequence::Save, this, &MainWindow::saveDocument);
+    fileMenu->addSeparator();
+    fileMenu->addAction(kExportPdfActionText.data(), this, [this]() { exportPdf(false); });
+    fileMenu->addAction(kExportPdfPagesActionText.data(), this, [this]() { exportPdf(true); });
+    fileMenu->addSeparator();
+    fileMenu->addAction(kCompareActionText.data(), this, &MainWindow::compareWithDocument);
+    fileMenu->addAction(kClearComparisonActionText.data(), this, &MainWindow::clearComparison);
+    fileMenu->addSeparator();
+    fileMenu->addAction(kImportBackgroundActionText.data(), this, &MainWindow::importBackground);
+
+    connect(documentLoader_, &DocumentLoader::progressChanged, this, &MainWindow::showLoadingProgress);
+    connect(documentLoader_, &DocumentLoader::finished, this, &MainWindow::finishDocumentLoading);
+    connect(documentLoader_, &DocumentLoader::failed, this, &MainWindow::reportDocumentLoadingError);
+}
+
+void MainWindow::setUpMirroringMenu() {
+    auto* mirroringMenu = menuBar()->addMenu(kMirroringMenuTitle.data());
+    broadcastAction_ = mirroringMenu->addAction(kBroadcastActionText.data());
+    broadcastAction_->setCheckable(true);
+    followAction_ = mirroringMenu->addAction(kFollowActionText.data());
+    followAction_->setCheckable(true);
+
+    connect(broadcastAction_, &QAction::toggled, this, &MainWindow::setBroadcasting);
+    connect(followAction_, &QAction::toggled, this, &MainWindow::setFollowing);
 }
 
 void MainWindow::addGraphicsViews() {
@@ -124,6 +264,8 @@ void MainWindow::addGraphicsViews() {
     setUpGraphicView<PolygonModeView>(kPolygonModeIconPath);
     setUpGraphicView<LineModeView>(kLineModeIconPath);
     setUpGraphicView<BrushModeView>(kBrushModeIconPath);
+    setUpGraphicView<FillModeView>(kFillModeIconPath);
+    setUpGraphicView<BezierModeView>(kBezierModeIconPath);
     toolBar_->addSeparator();
 }
 
@@ -137,16 +279,33 @@ void MainWindow::setUpApplicationStyles() {
 
 template<typename Widget>
 void addStyleSheetsToWidget(Widget* widget, std::string_view qssPath) {
-    QFile file(qssPath.data());
-    file.open(QFile::ReadOnly);
-    QString strCSS = QLatin1String(file.readAll());
-    widget->setStyleSheet(strCSS);
+    static QHash<QString, QString> loadedStyleSheets;
+
+    QString path{qssPath.data()};
+    auto styleSheet = loadedStyleSheets.constFind(path);
+    if (styleSheet == loadedStyleSheets.cend()) {
+        QFile file(path);
+        file.open(QFile::ReadOnly);
+        styleSheet = loadedStyleSheets.insert(path, QLatin1String(file.readAll()));
+    }
+    widget->setStyleSheet(*styleSheet);
+}
+
+QPixmap loadIconPixmap(std::string_view iconPath) {
+    QString key{iconPath.data()};
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        pixmap.load(key);
+        QPixmapCache::insert(key, pixmap);
+    }
+    return pixmap;
 }
 
 void MainWindow::setUpDrawingPropertiesButtons() {
     setUpToolBarColorButtons(fillColorAction_);
     setUpToolBarColorButtons(strokeColorAction_);
     setUpToolBarSpinBox(strokeWidthSpinBox_, strokeWidthAction_);
+    setUpToolBarRasterBrushButton();
 }
 
 void MainWindow::setUpToolBarColorButtons(QAction*& action) {
@@ -166,10 +325,18 @@ void MainWindow::setUpToolBarSpinBox(QSpinBox* spinBox, QAction*& action) {
     modePropertiesActions_.push_back(action);
 }
 
+void MainWindow::setUpToolBarRasterBrushButton() {
+    rasterBrushAction_ = toolBar_->addAction(QIcon{loadIconPixmap(kRasterBrushIconPath)}, kRasterBrushActionText.data());
+    rasterBrushAction_->setCheckable(true);
+    rasterBrushAction_->setVisible(false);
+    modePropertiesActions_.push_back(rasterBrushAction_);
+}
+
 void MainWindow::setUpToolBarActionsConnections() {
     connect(fillColorAction_, &QAction::triggered, this, &MainWindow::setFillColor);
     connect(strokeColorAction_, &QAction::triggered, this, &MainWindow::setStrokeColor);
     connect(strokeWidthSpinBox_, &QSpinBox::valueChanged, this, &MainWindow::setStrokeWidth);
+    connect(rasterBrushAction_, &QAction::toggled, this, &MainWindow::setRasterBrush);
 }
 
 inline void addLabelToStatusBar(QStatusBar* statusBar, QLabel* label, int labelWidth) {
@@ -180,23 +347,39 @@ inline void addLabelToStatusBar(QStatusBar* statusBar, QLabel* label, int labelW
 void MainWindow::setUpStatusBar() {
     addLabelToStatusBar(statusBar_, labelCursorPosX_, kDefaultStatusBarCursorLabelSize);
     addLabelToStatusBar(statusBar_, labelCursorPosY_, kDefaultStatusBarCursorLabelSize);
+
+    loadingProgressBar_->setFixedWidth(kLoadingProgressBarWidth);
+    loadingProgressBar_->setFormat(kLoadingProgressFormat.data());
+    loadingProgressBar_->hide();
+    statusBar_->addPermanentWidget(loadingProgressBar_);
+
+    exportProgressBar_->setFixedWidth(kLoadingProgressBarWidth);
+    exportProgressBar_->setFormat(kExportProgressFormat.data());
+    exportProgressBar_->hide();
+    statusBar_->addPermanentWidget(exportProgressBar_);
+}
+
+void MainWindow::connectViewToStatusBar(ApplicationGraphicsView* view) {
+    connect(view, &ApplicationGraphicsView::cursorPositionChanged, this, &MainWindow::updateCursorPosition);
+    connect(view, &ApplicationGraphicsView::cursorHasLeavedView, this, &MainWindow::hideCursorLabelsFromStatusBar);
 }
 
-void MainWindow::setUpConnectionsForStatusBar() {
-    connect(modificationModeView_, &ApplicationGraphicsView::cursorPositionChanged, this, &MainWindow::updateCursorPosition);
-    connect(modificationModeView_, &ApplicationGraphicsView::cursorHasLeavedView, this, &MainWindow::hideCursorLabelsFromStatusBar);
-    for (auto* view : drawingViewsList_) {
-        connect(view, &ApplicationGraphicsView::cursorPositionChanged, this, &MainWindow::updateCursorPosition);
-        connect(view, &ApplicationGraphicsView::cursorHasLeavedView, this, &MainWindow::hideCursorLabelsFromStatusBar);
+ApplicationGraphicsView* MainWindow::modeView(int modeIndex) {
+    if (modeViews_[modeIndex] == nullptr) {
+        modeViews_[modeIndex] = modeViewFactories_[modeIndex](modeIndex);
+        connect(modeViews_[modeIndex], &ApplicationGraphicsView::framePainted,
+                renderCachePolicy_, &RenderCachePolicy::notePaintedFrame);
+        connect(modeViews_[modeIndex], &ApplicationGraphicsView::fullQualityRestored,
+                renderCachePolicy_, &RenderCachePolicy::refreshDraftCaches);
+        StartupTimer::instance().markPhase("mode view created");
     }
+    return modeViews_[modeIndex];
 }
 
 QPushButton* MainWindow::addToolBarButton(std::string_view iconPath) {
     auto* button = new QPushButton{};
     modeButtonsList_.push_back(button);
-    QPixmap pixmap{iconPath.data()};
-
-    button->setIcon(QIcon{pixmap});
+    button->setIcon(QIcon{loadIconPixmap(iconPath)});
     button->setIconSize(kDefaultBtnIconSize);
     button->setCheckable(true);
     button->setChecked(false);
@@ -208,7 +391,9 @@ QPushButton* MainWindow::addToolBarButton(std::string_view iconPath) {
 void MainWindow::addModeButtonsAndConnections(std::string_view iconPath, int btnIndex) {
     auto* button = addToolBarButton(iconPath);
     connect(button, &QPushButton::clicked, this, [&, button, btnIndex]() {
-        stackedWidget_->setCurrentIndex(btnIndex);
+        stackedWidget_->setCurrentWidget(modeView(btnIndex));
+        navigator_->setView(modeView(btnIndex));
+        currentModeIndex_ = btnIndex;
         for (auto* btn : modeButtonsList_) {
             btn->setChecked(false);
         }
@@ -221,8 +406,11 @@ void MainWindow::addModeButtonsAndConnections(std::string_view iconPath, int btn
 }
 
 void MainWindow::changeActionsVisibility(int btnIndex) {
-    if (btnIndex == 4 || btnIndex == 5) {
+    rasterBrushAction_->setVisible(btnIndex == 5);
+    if (btnIndex == 4 || btnIndex == 5 || btnIndex == 7) {
         setUpModePropertiesToolButtons<2>(drawingViewsList_[btnIndex - 1]);
+    } else if (btnIndex == 6) {
+        setUpModePropertiesToolButtons<1>(drawingViewsList_[btnIndex - 1]);
     } else {
         setUpModePropertiesToolButtons<3>(drawingViewsList_[btnIndex - 1]);
     }
@@ -250,8 +438,210 @@ void MainWindow::hideCursorLabelsFromStatusBar() {
 
 void MainWindow::setStrokeWidth(int width) {
     assert(width >= 0);
-    int viewIndex = stackedWidget_->currentIndex();
-    drawingViewsList_[viewIndex - 1]->setStrokeWidth(width);
+    drawingViewsList_[currentModeIndex_ - 1]->setStrokeWidth(width);
+}
+
+void MainWindow::setRasterBrush(bool isEnabled) {
+    if (brushModeView_ == nullptr) return;
+    brushModeView_->setBackend(isEnabled ? BrushBackend::kRaster : BrushBackend::kVector);
+}
+
+void MainWindow::showFlatteningReport(qsizetype itemsCount, qint64 reclaimedBytes) {
+    auto report = reclaimedBytes >= 0 ? kFlatteningReclaimedReport : kFlatteningGrownReport;
+    statusBar_->showMessage(QString{report.data()}
+                                    .arg(itemsCount)
+                                    .arg(QLocale{}.formattedDataSize(qAbs(reclaimedBytes))),
+                            kStatusBarReportTimeoutMs);
+}
+
+void MainWindow::showSimilarSelectionReport(qsizetype itemsCount) {
+    statusBar_->showMessage(QString{kSimilarSelectionReport.data()}.arg(itemsCount), kStatusBarReportTimeoutMs);
+}
+
+void MainWindow::openDocument() {
+    QString filePath = QFileDialog::getOpenFileName(this, {}, {}, kDocumentFilesFilter.data());
+    if (filePath.isEmpty()) return;
+
+    // The differences were found for the drawing which is replaced.
+    clearComparison();
+    // Items in the visible part of the scene are shown first, the rest is added while the window stays responsive.
+    auto* view = modeView(currentModeIndex_);
+    documentLoader_->load(filePath, view->mapToScene(view->viewport()->rect()).boundingRect());
+}
+
+void MainWindow::showLoadingProgress(qsizetype createdCount, qsizetype totalCount) {
+    loadingProgressBar_->setRange(0, static_cast<int>(totalCount));
+    loadingProgressBar_->setValue(static_cast<int>(createdCount));
+    loadingProgressBar_->show();
+}
+
+void MainWindow::finishDocumentLoading() {
+    loadingProgressBar_->hide();
+    isModified_ = false;
+}
+
+void MainWindow::reportDocumentLoadingError() {
+    loadingProgressBar_->hide();
+    QMessageBox::warning(this, {}, kOpenDocumentError.data());
+}
+
+void MainWindow::saveDocument() {
+    QString filePath = QFileDialog::getSaveFileName(this, {}, {}, kDocumentFilesFilter.data());
+    if (filePath.isEmpty()) return;
+
+    // A document being loaded is saved completely.
+    documentLoader_->finish();
+    DocumentSnapshot document = documentModel_->snapshot(modificationModeView_->sceneRect());
+    // Changes made while the document is written mark it as modified again.
+    isModified_ = false;
+    QPointer<MainWindow> window{this};
+    QThreadPool::globalInstance()->start([window, filePath, document]() {
+        bool isSaved = detail::saveDocument(filePath, document);
+        detail::invokeIfAlive(window, [isSaved](MainWindow* receiver) { receiver->finishDocumentSaving(isSaved); });
+    });
+}
+
+void MainWindow::finishDocumentSaving(bool isSaved) {
+    if (isSaved) return;
+    isModified_ = true;
+    QMessageBox::warning(this, {}, kSaveDocumentError.data());
+}
+
+void MainWindow::exportPdf(bool isSplitIntoPages) {
+    QString filePath = QFileDialog::getSaveFileName(this, {}, {}, kPdfFilesFilter.data());
+    if (filePath.isEmpty()) return;
+
+    // The file is written from a snapshot, drawing can go on while a large document is exported.
+    documentLoader_->finish();
+    DocumentSnapshot document = documentModel_->snapshot(modificationModeView_->sceneRect());
+    PdfExportOptions options;
+    options.isSplitIntoPages = isSplitIntoPages;
+
+    exportProgressBar_->setRange(0, 0);
+    exportProgressBar_->show();
+    QPointer<MainWindow> window{this};
+    QThreadPool::globalInstance()->start([window, filePath, document, options]() {
+        auto progress = [window](qsizetype paintedCount, qsizetype totalCount) {
+            detail::invokeIfAlive(window, [paintedCount, totalCount](MainWindow* receiver) {
+                receiver->showExportProgress(paintedCount, totalCount);
+            });
+        };
+        bool isExported = PdfExporter{options}.exportDocument(document, filePath, progress);
+        detail::invokeIfAlive(window, [isExported](MainWindow* receiver) { receiver->finishPdfExport(isExported); });
+    });
+}
+
+void MainWindow::showExportProgress(qsizetype paintedCount, qsizetype totalCount) {
+    exportProgressBar_->setRange(0, static_cast<int>(totalCount));
+    exportProgressBar_->setValue(static_cast<int>(paintedCount));
+}
+
+void MainWindow::finishPdfExport(bool isExported) {
+    exportProgressBar_->hide();
+    if (!isExported) QMessageBox::warning(this, {}, kExportPdfError.data());
+}
+
+void MainWindow::compareWithDocument() {
+    QString filePath = QFileDialog::getOpenFileName(this, {}, {}, kDocumentFilesFilter.data());
+    if (filePath.isEmpty()) return;
+
+    // The saved version is the base, the differences are shown on the current drawing.
+    documentLoader_->finish();
+    DocumentSnapshot document = documentModel_->snapshot(modificationModeView_->sceneRect());
+    statusBar_->showMessage(kComparingReport.data());
+    QPointer<MainWindow> window{this};
+    QThreadPool::globalInstance()->start([window, filePath, document]() {
+        std::optional<DocumentDifference> difference;
+        if (auto base = detail::loadDocument(filePath)) difference = detail::diffDocuments(*base, document);
+        detail::invokeIfAlive(window, [filePath, difference](MainWindow* receiver) {
+            receiver->finishComparison(QFileInfo{filePath}.fileName(), difference);
+        });
+    });
+}
+
+void MainWindow::finishComparison(const QString& fileName, const std::optional<DocumentDifference>& difference) {
+    statusBar_->clearMessage();
+    if (!difference) {
+        QMessageBox::warning(this, {}, kCompareDocumentError.data());
+        return;
+    }
+
+    clearComparison();
+    diffOverlay_ = new DiffOverlayItem{*difference};
+    graphicsScene_->addItem(diffOverlay_);
+    statusBar_->showMessage(QString{kComparisonReport.data()}
+                                    .arg(fileName)
+                                    .arg(difference->count(ItemChange::kAdded))
+                                    .arg(difference->count(ItemChange::kRemoved))
+                                    .arg(difference->count(ItemChange::kMoved))
+                                    .arg(difference->count(ItemChange::kRestyled))
+                                    .arg(difference->unchangedCount));
+}
+
+void MainWindow::clearComparison() {
+    delete diffOverlay_;
+    diffOverlay_ = nullptr;
+    statusBar_->clearMessage();
+}
+
+void MainWindow::importBackground() {
+    QString imagePath = QFileDialog::getOpenFileName(this, {}, {}, kBackgroundFilesFilter.data());
+    if (imagePath.isEmpty()) return;
+
+    // The image is decoded once into the tiles cache, the next imports of the same image open the cache at once.
+    statusBar_->showMessage(kBackgroundPreparingReport.data());
+    QPointer<MainWindow> window{this};
+    QThreadPool::globalInstance()->start([window, imagePath]() {
+        QString cachePath = TiledImageFile::cachePathFor(imagePath);
+        bool isBuilt = TiledImageFile::build(imagePath, cachePath);
+        detail::invokeIfAlive(window, [imagePath, cachePath, isBuilt](MainWindow* receiver) {
+            receiver->finishBackgroundImport(imagePath, isBuilt ? cachePath : QString{});
+        });
+    });
+}
+
+void MainWindow::finishBackgroundImport(const QString& imagePath, const QString& cachePath) {
+    statusBar_->clearMessage();
+    auto file = std::make_unique<TiledImageFile>();
+    if (cachePath.isEmpty() || !file->open(cachePath)) {
+        QMessageBox::warning(this, {}, kImportBackgroundError.data());
+        return;
+    }
+
+    // The background goes under all layers and is locked, drawing continues in the active layer.
+    LayerItem* activeLayer = graphicsScene_->getActiveLayer();
+    LayerItem* layer = graphicsScene_->insertLayer(0, QFileInfo{imagePath}.fileName());
+    // Scans are far larger than the canvas, the whole image is shown and painted from the reduced levels.
+    auto* imageItem = new TiledImageItem{std::move(file)};
+    imageItem->fitInto(modificationModeView_->sceneRect());
+    graphicsScene_->addItemsToLayer(layer, {imageItem});
+    graphicsScene_->setLayerLocked(layer, true);
+    if (activeLayer != nullptr) graphicsScene_->setActiveLayer(activeLayer);
+}
+
+void MainWindow::setBroadcasting(bool isEnabled) {
+    delete mirrorPublisher_;
+    mirrorPublisher_ = nullptr;
+    if (!isEnabled) return;
+
+    mirrorPublisher_ = new SceneMirrorPublisher{graphicsScene_, this};
+    if (!mirrorPublisher_->listen(kMirrorServerName.data())) {
+        statusBar_->showMessage(kBroadcastingError.data(), kStatusBarReportTimeoutMs);
+        broadcastAction_->setChecked(false);
+    }
+}
+
+void MainWindow::setFollowing(bool isEnabled) {
+    if (mirrorFollower_ != nullptr) mirrorFollower_->deleteLater();
+    mirrorFollower_ = nullptr;
+    if (!isEnabled) return;
+
+    mirrorFollower_ = new SceneMirrorFollower{graphicsScene_, this};
+    connect(mirrorFollower_, &SceneMirrorFollower::disconnected, this, [this]() {
+        statusBar_->showMessage(kFollowingStoppedReport.data(), kStatusBarReportTimeoutMs);
+        followAction_->setChecked(false);
+    });
+    mirrorFollower_->connectToPublisher(kMirrorServerName.data());
 }
 
 void MainWindow::changeSceneState() {
@@ -264,24 +654,24 @@ enum class ColorButtonType {
 };
 
 template<ColorButtonType BtnType>
-void setColor(const QStackedWidget* stackedWidget,
+void setColor(int viewIndex,
               const QList<DrawingGraphicsView*>& drawingViewsList,
               QAction* action);
 
 void MainWindow::setStrokeColor() {
-    setColor<ColorButtonType::STROKE>(stackedWidget_,
+    setColor<ColorButtonType::STROKE>(currentModeIndex_,
                                       drawingViewsList_,
                                       strokeColorAction_);
 }
 
 void MainWindow::setFillColor() {
-    setColor<ColorButtonType::FILL>(stackedWidget_,
+    setColor<ColorButtonType::FILL>(currentModeIndex_,
                                     drawingViewsList_,
                                     fillColorAction_);
 }
 
 template<ColorButtonType BtnType>
-void setColor(const QStackedWidget* stackedWidget,
+void setColor(int viewIndex,
               const QList<DrawingGraphicsView*>& drawingViewsList,
               QAction* action)
 {
@@ -290,8 +680,6 @@ void setColor(const QStackedWidget* stackedWidget,
                                           kChooseColorSuggestion.data(),
                                           QColorDialog::ShowAlphaChannel);
     if (color.isValid()) {
-        int viewIndex = stackedWidget->currentIndex();
-
         if constexpr (BtnType == ColorButtonType::STROKE)
             drawingViewsList[viewIndex - 1]->setStrokeColor(color);
         else if constexpr (BtnType == ColorButtonType::FILL)
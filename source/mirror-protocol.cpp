@@ -0,0 +1,315 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QDataStream>
+#include <QHash>
+#include <QtEndian>
+#include <algorithm>
+#include "../include/mirror-protocol.h"
+#include "../include/graphics-scene.h"
+
+namespace {
+    constexpr QDataStream::Version kStreamVersion{QDataStream::Qt_6_5};
+    constexpr qsizetype kMessageHeaderSize{sizeof(quint32)};
+    constexpr quint32 kMaxMessageSize{256 * 1024 * 1024};
+    constexpr quint8 kVarUIntPayloadMask{0x7f};
+    constexpr quint8 kVarUIntContinuationBit{0x80};
+    constexpr int kVarUIntPayloadBits{7};
+    constexpr quint8 kLayerVisibleFlag{0x01};
+    constexpr quint8 kLayerLockedFlag{0x02};
+    // The count of ids of a move is sent increased by one, zero refers to the items of the previous move.
+    constexpr quint64 kPreviousMoveIds{0};
+    constexpr quint64 kMoveIdsCountOffset{1};
+
+    enum class OperationCode : quint8 {
+        kResetScene = 1,
+        kUpdateLayers,
+        kCreateItems,
+        kMoveItems,
+        kTransformItems,
+        kDeleteItems,
+        kRestackItems
+    };
+
+    template<typename... Visitors>
+    struct Overloaded : Visitors... {
+        using Visitors::operator()...;
+    };
+
+    template<typename... Visitors>
+    Overloaded(Visitors...) -> Overloaded<Visitors...>;
+
+    void writeVarUInt(QDataStream& stream, quint64 value) {
+        while (value > kVarUIntPayloadMask) {
+            stream << static_cast<quint8>((value & kVarUIntPayloadMask) | kVarUIntContinuationBit);
+            value >>= kVarUIntPayloadBits;
+        }
+        stream << static_cast<quint8>(value);
+    }
+
+    quint64 readVarUInt(QDataStream& stream) {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += kVarUIntPayloadBits) {
+            quint8 byte = 0;
+            stream >> byte;
+            value |= static_cast<quint64>(byte & kVarUIntPayloadMask) << shift;
+            if ((byte & kVarUIntContinuationBit) == 0) return value;
+        }
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return 0;
+    }
+
+    // Ids are written as gaps between sorted values, which keeps them to one or two bytes each.
+    void writeIds(QDataStream& stream, QList<quint64> ids, quint64 countOffset = 0) {
+        std::sort(ids.begin(), ids.end());
+        writeVarUInt(stream, static_cast<quint64>(ids.size()) + countOffset);
+        quint64 previousId = 0;
+        for (auto id : ids) {
+            writeVarUInt(stream, id - previousId);
+            previousId = id;
+        }
+    }
+
+    QList<quint64> readIds(QDataStream& stream, quint64 count) {
+        QList<quint64> ids;
+        quint64 previousId = 0;
+        for (quint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            previousId += readVarUInt(stream);
+            ids.push_back(previousId);
+        }
+        return ids;
+    }
+
+    void writeLayers(QDataStream& stream, const QList<MirrorLayer>& layers) {
+        writeVarUInt(stream, static_cast<quint64>(layers.size()));
+        for (const auto& layer : layers) {
+            quint8 flags = (layer.isVisible ? kLayerVisibleFlag : 0) | (layer.isLocked ? kLayerLockedFlag : 0);
+            writeVarUInt(stream, layer.id);
+            stream << layer.name << flags;
+        }
+    }
+
+    QList<MirrorLayer> readLayers(QDataStream& stream) {
+        QList<MirrorLayer> layers;
+        quint64 count = readVarUInt(stream);
+        for (quint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            MirrorLayer layer;
+            quint8 flags = 0;
+            layer.id = readVarUInt(stream);
+            stream >> layer.name >> flags;
+            layer.isVisible = flags & kLayerVisibleFlag;
+            layer.isLocked = flags & kLayerLockedFlag;
+            layers.push_back(layer);
+        }
+        return layers;
+    }
+
+    void writeItems(QDataStream& stream, const QList<MirrorItem>& items) {
+        writeVarUInt(stream, static_cast<quint64>(items.size()));
+        for (const auto& item : items) {
+            writeVarUInt(stream, item.id);
+            writeVarUInt(stream, item.layerId);
+            stream << item.snapshot;
+        }
+    }
+
+    QList<MirrorItem> readItems(QDataStream& stream) {
+        QList<MirrorItem> items;
+        quint64 count = readVarUInt(stream);
+        for (quint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            MirrorItem item;
+            item.id = readVarUInt(stream);
+            item.layerId = readVarUInt(stream);
+            stream >> item.snapshot;
+            items.push_back(std::move(item));
+        }
+        return items;
+    }
+
+    void writeTransforms(QDataStream& stream, const QList<MirrorItemTransform>& transforms) {
+        writeVarUInt(stream, static_cast<quint64>(transforms.size()));
+        for (const auto& transform : transforms) {
+            writeVarUInt(stream, transform.id);
+            stream << transform.position << transform.transformOrigin << transform.rotation << transform.scale;
+        }
+    }
+
+    QList<MirrorItemTransform> readTransforms(QDataStream& stream) {
+        QList<MirrorItemTransform> transforms;
+        quint64 count = readVarUInt(stream);
+        for (quint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            MirrorItemTransform transform;
+            transform.id = readVarUInt(stream);
+            stream >> transform.position >> transform.transformOrigin >> transform.rotation >> transform.scale;
+            transforms.push_back(transform);
+        }
+        return transforms;
+    }
+}  // namespace
+
+QByteArray MirrorEncoder::encode(const QList<MirrorOperation>& operations) {
+    QByteArray message;
+    QDataStream stream{&message, QIODevice::WriteOnly};
+    stream.setVersion(kStreamVersion);
+    stream << quint32{0};
+
+    for (const auto& operation : operations) {
+        std::visit(Overloaded{
+                [&](const ResetSceneOperation& reset) {
+                    lastMovedIds_.clear();
+                    stream << static_cast<quint8>(OperationCode::kResetScene);
+                    writeLayers(stream, reset.layers);
+                    writeItems(stream, reset.items);
+                },
+                [&](const UpdateLayersOperation& update) {
+                    stream << static_cast<quint8>(OperationCode::kUpdateLayers);
+                    writeLayers(stream, update.layers);
+                },
+                [&](const CreateItemsOperation& create) {
+                    stream << static_cast<quint8>(OperationCode::kCreateItems);
+                    writeItems(stream, create.items);
+                },
+                [&](const MoveItemsOperation& move) {
+                    stream << static_cast<quint8>(OperationCode::kMoveItems);
+                    if (move.ids == lastMovedIds_ && !move.ids.isEmpty()) {
+                        writeVarUInt(stream, kPreviousMoveIds);
+                    } else {
+                        writeIds(stream, move.ids, kMoveIdsCountOffset);
+                        lastMovedIds_ = move.ids;
+                    }
+                    stream << move.delta;
+                },
+                [&](const TransformItemsOperation& transform) {
+                    stream << static_cast<quint8>(OperationCode::kTransformItems);
+                    writeTransforms(stream, transform.transforms);
+                },
+                [&](const DeleteItemsOperation& deletion) {
+                    stream << static_cast<quint8>(OperationCode::kDeleteItems);
+                    writeIds(stream, deletion.ids);
+                },
+                [&](const RestackItemsOperation& restack) {
+                    stream << static_cast<quint8>(OperationCode::kRestackItems);
+                    writeIds(stream, restack.ids);
+                    stream << static_cast<quint8>(restack.move);
+                }
+            }, operation);
+    }
+
+    qToBigEndian(static_cast<quint32>(message.size() - kMessageHeaderSize), message.data());
+    return message;
+}
+
+void MirrorDecoder::append(const QByteArray& data) {
+    buffer_.append(data);
+}
+
+std::optional<QList<MirrorOperation>> MirrorDecoder::takeMessage() {
+    if (!isValid_ || buffer_.size() < kMessageHeaderSize) return std::nullopt;
+
+    auto messageSize = qFromBigEndian<quint32>(buffer_.constData());
+    if (messageSize > kMaxMessageSize) {
+        isValid_ = false;
+        return std::nullopt;
+    }
+    if (buffer_.size() < kMessageHeaderSize + static_cast<qsizetype>(messageSize)) return std::nullopt;
+
+    QByteArray payload = buffer_.mid(kMessageHeaderSize, messageSize);
+    buffer_.remove(0, kMessageHeaderSize + messageSize);
+
+    QDataStream stream{payload};
+    stream.setVersion(kStreamVersion);
+
+    QList<MirrorOperation> operations;
+    while (!stream.atEnd() && stream.status() == QDataStream::Ok) {
+        quint8 code = 0;
+        stream >> code;
+
+        switch (static_cast<OperationCode>(code)) {
+            case OperationCode::kResetScene: {
+                lastMovedIds_.clear();
+                ResetSceneOperation reset;
+                reset.layers = readLayers(stream);
+                reset.items = readItems(stream);
+                operations.push_back(std::move(reset));
+                break;
+            }
+            case OperationCode::kUpdateLayers:
+                operations.push_back(UpdateLayersOperation{readLayers(stream)});
+                break;
+            case OperationCode::kCreateItems:
+                operations.push_back(CreateItemsOperation{readItems(stream)});
+                break;
+            case OperationCode::kMoveItems: {
+                quint64 count = readVarUInt(stream);
+                if (count != kPreviousMoveIds) lastMovedIds_ = readIds(stream, count - kMoveIdsCountOffset);
+                QPointF delta;
+                stream >> delta;
+                operations.push_back(MoveItemsOperation{lastMovedIds_, delta});
+                break;
+            }
+            case OperationCode::kTransformItems:
+                operations.push_back(TransformItemsOperation{readTransforms(stream)});
+                break;
+            case OperationCode::kDeleteItems:
+                operations.push_back(DeleteItemsOperation{readIds(stream, readVarUInt(stream))});
+                break;
+            case OperationCode::kRestackItems: {
+                RestackItemsOperation restack{readIds(stream, readVarUInt(stream))};
+                quint8 move = 0;
+                stream >> move;
+                if (move > static_cast<quint8>(StackingMove::kBackward)) stream.setStatus(QDataStream::ReadCorruptData);
+                restack.move = static_cast<StackingMove>(move);
+                operations.push_back(std::move(restack));
+                break;
+            }
+            default:
+                stream.setStatus(QDataStream::ReadCorruptData);
+                break;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        isValid_ = false;
+        return std::nullopt;
+    }
+    return operations;
+}
+
+bool MirrorDecoder::isValid() const noexcept {
+    return isValid_;
+}
+
+namespace detail {
+
+    bool mergeMirrorOperation(MirrorOperation& last, const MirrorOperation& operation) {
+        if (auto* lastMove = std::get_if<MoveItemsOperation>(&last)) {
+            const auto* move = std::get_if<MoveItemsOperation>(&operation);
+            if (move == nullptr || move->ids != lastMove->ids) return false;
+            lastMove->delta += move->delta;
+            return true;
+        }
+
+        if (auto* lastTransform = std::get_if<TransformItemsOperation>(&last)) {
+            const auto* transform = std::get_if<TransformItemsOperation>(&operation);
+            if (transform == nullptr) return false;
+
+            QHash<quint64, qsizetype> indices;
+            for (qsizetype i = 0; i < lastTransform->transforms.size(); ++i) {
+                indices.insert(lastTransform->transforms[i].id, i);
+            }
+            for (const auto& itemTransform : transform->transforms) {
+                auto index = indices.constFind(itemTransform.id);
+                if (index != indices.cend()) lastTransform->transforms[*index] = itemTransform;
+                else lastTransform->transforms.push_back(itemTransform);
+            }
+            return true;
+        }
+
+        if (std::holds_alternative<UpdateLayersOperation>(last) &&
+            std::holds_alternative<UpdateLayersOperation>(operation)) {
+            last = operation;
+            return true;
+        }
+        return false;
+    }
+
+}  // namespace detail
@@ -1,27 +1,47 @@
 // @copyright Copyright (c) 2023 by Konstantin Belousov
 
 #include <QApplication>
+#include <QClipboard>
 #include <QMouseEvent>
 #include <QGraphicsItem>
 #include <QGraphicsScene>
 #include <QGraphicsView>
 #include <QPointF>
-#include <qmath.h>
+#include <QInputDialog>
+#include <QThreadPool>
+#include <QSet>
+#include <cstdint>
+#include <string_view>
+#include <vector>
 #include "../include/modification-mode-view.h"
+#include "../include/graphics-scene.h"
 #include "../include/graphics-items-detail.h"
+#include "../include/async-detail.h"
 #include "../include/rectangles-detail.h"
+#include "../include/scene-snapshot.h"
+#include "../include/items-mime-data.h"
+#include "../include/item-transformations-detail.h"
+#include "../include/item-copy-detail.h"
+#include "../include/lasso-detail.h"
+#include "../include/simplification-detail.h"
 
 namespace {
+    using std::operator ""sv;
+
     const QColor kSelectionAreaBrush{0, 0, 200, 15};
     const QColor kSelectionAreaPen{0 , 0, 255};
     constexpr QRectF kZeroSizeFRectangle{0, 0, 0, 0};
     constexpr qreal kSelectionAreaZValue{1.0};
-    constexpr qreal kZeroAngle{0};
 
-    enum class CoordsType {
-        kSceneCoords,
-        kItemCoords
-    };
+    constexpr auto kFlattenDialogTitle{"Flatten selection"sv};
+    constexpr auto kFlattenDialogLabel{"Pixels per scene unit:"sv};
+    constexpr qreal kDefaultFlattenScale{1.0};
+    constexpr qreal kMinFlattenScale{0.25};
+    constexpr qreal kMaxFlattenScale{8.0};
+    constexpr int kFlattenScaleDecimals{2};
+
+    // Lasso points closer than a device pixel to the outline do not change which items it encloses.
+    constexpr qreal kLassoToleranceInPixels{1.0};
 }  // namespace
 
 class RotationInfo {
@@ -46,31 +66,65 @@ class RotationInfo {
     QList<qreal> angles_;
 };
 
+class LassoInfo {
+/*
+ Items which can be selected by the lasso being drawn, filled when the lasso is started.
+ An item is enclosed by the lasso when the center of its bounding rectangle is inside the lasso. Centers are kept
+ as separate arrays of coordinates, so every update of the lasso only narrows the items by the bounding rectangle
+ of the lasso and passes centers of the rest to the containment kernel in one batch. Items selected before
+ the lasso was started stay selected. An update only revisits the candidates and the items which were inside
+ the lasso on the previous update, and changes the selection of those whose state differs.
+*/
+ public:
+    void clear();
+    void fillInfo(const QList<QGraphicsItem*>& items);
+    void select(const QPolygonF& lasso);
+    [[nodiscard]] bool isEmpty() const noexcept;
+
+ private:
+    void updateItemSelection(std::size_t i);
+
+    std::vector<QGraphicsItem*> items_;
+    std::vector<float> centersX_;
+    std::vector<float> centersY_;
+    std::vector<std::uint8_t> wasSelected_;
+    std::vector<std::uint8_t> isSelected_;
+    std::vector<std::uint8_t> isInsideLasso_;
+    // Items inside the lasso on the previous update.
+    std::vector<std::size_t> insideItems_;
+
+    // Buffers of the candidates of an update, they keep their capacity between updates.
+    std::vector<std::size_t> candidates_;
+    std::vector<float> candidatesX_;
+    std::vector<float> candidatesY_;
+    std::vector<std::uint8_t> isInside_;
+    std::vector<std::size_t> nextInsideItems_;
+};
+
 void updateSceneSelection(QGraphicsScene* scene, const QList<QGraphicsItem*>& items);
-QPointF getGraphicsItemSceneCenterPos(const QGraphicsItem* item);
-QPointF getGraphicsItemOwnCenterPos(const QGraphicsItem* item);
-QList<QGraphicsItem*> cloneSelectedItems(QGraphicsScene* scene);
-qreal calculateRotationAngle(const QPointF& geometricCenterO,
-                             const QPointF& initialCursorPosA,
-                             const QPointF& currentCursorPosB) noexcept;
+QList<QGraphicsItem*> cloneSelectedItems(ApplicationGraphicsScene* scene);
 
 // ------------------------------------------------------------------------------------------------------------
 
-ModificationModeView::ModificationModeView(QGraphicsScene* graphic_scene, QSize viewSize)
+ModificationModeView::ModificationModeView(ApplicationGraphicsScene* graphic_scene, QSize viewSize)
     : ApplicationGraphicsView(graphic_scene, viewSize),
       selectionArea_(new QGraphicsRectItem()),
+      lassoArea_(new QGraphicsPolygonItem()),
       rotationInfo_(std::make_unique<RotationInfo>()),
+      lassoInfo_(std::make_unique<LassoInfo>()),
       selectionStartPos_(constants::kZeroPointF),
       lastClickPos_(constants::kZeroPointF),
       initialCursorPosA_(constants::kZeroPointF),
-      isMoving_(false)
+      flattenJobsCount_(0),
+      isMoving_(false),
+      isLassoSelection_(false)
 {
     setSelectionAreaProperties();
 }
 
 void ModificationModeView::mousePressEvent(QMouseEvent* event) {
     QPointF currentCursorPos = mapToScene(event->pos());
-    QGraphicsItem* itemUnderCursor = scene()->itemAt(currentCursorPos, QTransform{});
+    QGraphicsItem* itemUnderCursor = applicationScene()->editableItemAt(currentCursorPos);
 
     if (event->button() == Qt::LeftButton && event->modifiers() & Qt::ShiftModifier) {
         handleMiddleButtonClick(itemUnderCursor, currentCursorPos);
@@ -106,20 +160,34 @@ void ModificationModeView::mouseReleaseEvent(QMouseEvent* event) {
     isMoving_ = false;
     selectionArea_->setRect(kZeroSizeFRectangle);
     selectionArea_->hide();
-}
-
-template<typename GraphicScene>
-void deleteSelectedItems(GraphicScene* scene) {
-    for (auto* item : scene->selectedItems()) {
-        scene->removeItem(item);
-        delete item;
-    }
+    lassoArea_->hide();
+    lassoPoints_.clear();
+    lassoInfo_->clear();
 }
 
 void ModificationModeView::keyPressEvent(QKeyEvent* event) {
-    if (event->key() == Qt::Key_D) {
-        deleteSelectedItems(scene());
+    if (event->matches(QKeySequence::Copy)) {
+        copySelectedItems();
+    } else if (event->matches(QKeySequence::Paste)) {
+        pasteItems();
+    } else if (event->key() == Qt::Key_D) {
+        applicationScene()->deleteItems(scene()->selectedItems());
         emit changeStateOfScene();
+    } else if (event->key() == Qt::Key_F) {
+        flattenSelectedItems();
+    } else if (event->key() == Qt::Key_L) {
+        isLassoSelection_ = !isLassoSelection_;
+    } else if (event->key() == Qt::Key_Home) {
+        restackSelectedItems(StackingMove::kToFront);
+    } else if (event->key() == Qt::Key_End) {
+        restackSelectedItems(StackingMove::kToBack);
+    } else if (event->key() == Qt::Key_PageUp) {
+        restackSelectedItems(StackingMove::kForward);
+    } else if (event->key() == Qt::Key_PageDown) {
+        restackSelectedItems(StackingMove::kBackward);
+    } else if (event->key() == Qt::Key_S) {
+        QList<QGraphicsItem*> samples = scene()->selectedItems();
+        if (!samples.isEmpty()) emit similarItemsSelected(applicationScene()->selectSimilarItems(samples));
     }
 }
 
@@ -130,6 +198,7 @@ void ModificationModeView::handleLeftButtonClick(QMouseEvent* event,
         QGraphicsView::mousePressEvent(event);
         if (event->modifiers() ^ Qt::ControlModifier) scene()->clearSelection();
         selectionStartPos_ = currentCursorPos;
+        if (isLassoSelection_) startLasso(currentCursorPos);
     } else {
         if (event->modifiers() & Qt::ControlModifier) {
             itemUnderCursor->setSelected(!itemUnderCursor->isSelected());
@@ -145,7 +214,7 @@ void ModificationModeView::handleLeftButtonClick(QMouseEvent* event,
 void ModificationModeView::handleMiddleButtonClick(QGraphicsItem* itemUnderCursor,
                                                    const QPointF& currentCursorPos) {
     if (itemUnderCursor != nullptr) {
-        QList<QGraphicsItem*> clonedItems = cloneSelectedItems(scene());
+        QList<QGraphicsItem*> clonedItems = cloneSelectedItems(applicationScene());
         updateSceneSelection(scene(), clonedItems);
         isMoving_ = true;
         lastClickPos_ = currentCursorPos;
@@ -163,15 +232,37 @@ void ModificationModeView::handleRightButtonClick(QMouseEvent* event,
 
 void ModificationModeView::updateSelectionArea(QMouseEvent* event,
                                                const QPointF& mouseCurrentPos) {
+    if (isLassoSelection_) {
+        updateLasso(mouseCurrentPos);
+        return;
+    }
     selectionArea_->show();
     selectionArea_->setRect(detail::makeRectangle(selectionStartPos_,
                                                   mouseCurrentPos));
     updateItemsSelection(event, selectionArea_->rect());
 }
 
+void ModificationModeView::startLasso(const QPointF& currentCursorPos) {
+    lassoPoints_ = QPolygonF{{currentCursorPos}};
+    QList<QGraphicsItem*> items = scene()->items();
+    items.removeIf([](const QGraphicsItem* item) {
+        return !item->isVisible() || !ApplicationGraphicsScene::isItemEditable(item);
+    });
+    lassoInfo_->fillInfo(items);
+}
+
+void ModificationModeView::updateLasso(const QPointF& mouseCurrentPos) {
+    if (lassoPoints_.isEmpty()) return;
+    lassoPoints_ << mouseCurrentPos;
+    lassoArea_->setPolygon(lassoPoints_);
+    lassoArea_->show();
+    // The simplified outline selects the same items with far fewer edges to test every point against.
+    lassoInfo_->select(detail::simplifyPolyline(lassoPoints_, kLassoToleranceInPixels / transform().m11()));
+}
+
 void ModificationModeView::updateItemsSelection(QMouseEvent* event,
                                                 const QRectF &selectionRectangle) {
-    QList<QGraphicsItem*> itemsInRect = scene()->items(selectionRectangle);
+    QList<QGraphicsItem*> itemsInRect = applicationScene()->editableItems(selectionRectangle);
     for (auto* item : scene()->items()) {
         if (event->modifiers() ^ Qt::ControlModifier) {
             item->setSelected(itemsInRect.contains(item));
@@ -181,11 +272,15 @@ void ModificationModeView::updateItemsSelection(QMouseEvent* event,
     }
 }
 
+void ModificationModeView::restackSelectedItems(StackingMove move) {
+    QList<QGraphicsItem*> selectedItems = scene()->selectedItems();
+    if (selectedItems.isEmpty()) return;
+    applicationScene()->restackItems(selectedItems, move);
+    emit changeStateOfScene();
+}
+
 void ModificationModeView::moveSelectedItems(const QPointF& mouseCurrentPos) {
-    QPointF delta = mouseCurrentPos - lastClickPos_;
-    for (auto* item : scene()->selectedItems()) {
-        item->moveBy(delta.x(), delta.y());
-    }
+    applicationScene()->moveItems(scene()->selectedItems(), mouseCurrentPos - lastClickPos_);
     lastClickPos_ = mouseCurrentPos;
 }
 
@@ -195,163 +290,171 @@ void ModificationModeView::rotateSelectedItems(QMouseEvent* event) {
     for (int i = 0; i < rotationInfo_->size(); i++) {
         rotateItem(event, items[i], angles[i]);
     }
+    applicationScene()->notifyItemsTransformed(items);
 }
 
 void ModificationModeView::rotateItem(QMouseEvent *event, QGraphicsItem* item, qreal startAngle) {
-    QPointF geometricCenterO = getGraphicsItemSceneCenterPos(item);
+    QPointF geometricCenterO = detail::getGraphicsItemSceneCenterPos(item);
     QPointF currentCursorPosB = mapToScene(event->pos());
-    qreal rotationAngle = calculateRotationAngle(geometricCenterO,
-                                                 initialCursorPosA_,
-                                                 currentCursorPosB);
+    qreal rotationAngle = detail::calculateRotationAngle(geometricCenterO,
+                                                         initialCursorPosA_,
+                                                         currentCursorPosB);
 
-    item->setTransformOriginPoint(getGraphicsItemOwnCenterPos(item));
+    item->setTransformOriginPoint(detail::getGraphicsItemOwnCenterPos(item));
     item->setRotation(startAngle + rotationAngle);
 }
 
-void ModificationModeView::setSelectionAreaProperties() {
-    selectionArea_->setPen(QPen{kSelectionAreaPen});
-    selectionArea_->setBrush(QBrush{kSelectionAreaBrush});
-    selectionArea_->hide();
-    selectionArea_->setFlag(QGraphicsItem::ItemIsSelectable, false);
-    selectionArea_->setFlag(QGraphicsItem::ItemIsMovable, false);
-    selectionArea_->setZValue(kSelectionAreaZValue);
-    scene()->addItem(selectionArea_);
+QList<QGraphicsItem*> ModificationModeView::selectedItemsInStackingOrder() const {
+    QRectF sceneRect;
+    for (const auto* item : scene()->selectedItems()) {
+        sceneRect |= item->sceneBoundingRect();
+    }
+    if (sceneRect.isNull()) return {};
+
+    // Items must be painted in the stacking order of the scene, which selectedItems() does not keep.
+    QList<QGraphicsItem*> items = scene()->items(sceneRect, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder);
+    items.removeIf([](const QGraphicsItem* item) {
+        return !item->isSelected() || !detail::isSnapshotSupported(item);
+    });
+    return items;
 }
 
-// ------------------------------------------------------------------------------------------------------------
+void ModificationModeView::copySelectedItems() {
+    QList<QGraphicsItem*> items = selectedItemsInStackingOrder();
+    if (items.isEmpty()) return;
+    QApplication::clipboard()->setMimeData(new ItemsMimeData{detail::takeItemsSnapshot(items)});
+}
 
-void updateSceneSelection(QGraphicsScene* scene, const QList<QGraphicsItem*>& items) {
-    scene->clearSelection();
-    for (auto* item : items) {
-        item->setSelected(true);
+void ModificationModeView::pasteItems() {
+    if (!applicationScene()->isActiveLayerEditable()) return;
+    auto snapshot = ItemsMimeData::decodeItems(QApplication::clipboard()->mimeData());
+    if (!snapshot || snapshot->isEmpty()) return;
+
+    QList<QGraphicsItem*> pastedItems;
+    pastedItems.reserve(snapshot->size());
+    for (const auto& item : *snapshot) {
+        pastedItems.push_back(detail::createItemFromSnapshot(item));
     }
+    applicationScene()->addItemsToActiveLayer(pastedItems);
+    updateSceneSelection(scene(), pastedItems);
+    emit changeStateOfScene();
 }
 
-template<CoordsType type>
-QPointF getPolygonCenterRelativeTo(const QGraphicsPolygonItem* polygonItem) {
-    auto points = polygonItem->polygon().toVector();
-    QPointF sum{};
+void ModificationModeView::flattenSelectedItems() {
+    if (scene()->selectedItems().isEmpty()) return;
 
-    for (const auto& point : points) {
-        if constexpr (type == CoordsType::kSceneCoords) {
-            sum += polygonItem->mapToScene(point);
-        } else if constexpr (type == CoordsType::kItemCoords) {
-            sum += point;
-        }
-    }
+    bool isAccepted = false;
+    qreal scale = QInputDialog::getDouble(this, kFlattenDialogTitle.data(), kFlattenDialogLabel.data(),
+                                          kDefaultFlattenScale, kMinFlattenScale, kMaxFlattenScale,
+                                          kFlattenScaleDecimals, &isAccepted);
+    if (!isAccepted) return;
 
-    return sum / static_cast<qreal>(points.size());
-}
+    QList<QGraphicsItem*> items = selectedItemsInStackingOrder();
+    if (items.isEmpty()) return;
 
-QPointF getGraphicsItemSceneCenterPos(const QGraphicsItem* item) {
-    if (const auto* polygonItem = qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)) {
-        return getPolygonCenterRelativeTo<CoordsType::kSceneCoords>(polygonItem);
-    } else {
-        return item->sceneBoundingRect().center();
+    QRectF sceneRect;
+    for (const auto* item : items) {
+        sceneRect |= item->sceneBoundingRect();
     }
-}
 
-QPointF getGraphicsItemOwnCenterPos(const QGraphicsItem* item) {
-    if (const auto* polygonItem = qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)) {
-        return getPolygonCenterRelativeTo<CoordsType::kItemCoords>(polygonItem);
-    } else {
-        return item->boundingRect().center();
+    QList<ItemSnapshot> snapshot = detail::takeItemsSnapshot(items);
+    qint64 originalBytes = 0;
+    for (const auto& item : snapshot) {
+        originalBytes += detail::estimateMemoryUsage(item);
     }
-}
 
-template<typename ItemT, typename ItemU>
-void copyGraphicProperties(const ItemT* originalItem, ItemU* destinationElement) {
-    destinationElement->setPen(originalItem->pen());
-    if constexpr (!std::is_same_v<ItemT, QGraphicsLineItem>) {
-        destinationElement->setBrush(originalItem->brush());
+    // Items being flattened can not be selected, so they stay untouched until the image is ready.
+    int jobId = ++flattenJobsCount_;
+    scene()->clearSelection();
+    for (auto* item : items) {
+        item->setFlag(QGraphicsItem::ItemIsSelectable, false);
+        item->setData(constants::kFlattenJobDataKey, jobId);
     }
-}
 
-template<typename ItemType, typename AngleT>
-inline void setUpItemsAngles(ItemType* originalItem, ItemType* destinationItem, AngleT angle) {
-    destinationItem->setTransformOriginPoint(getGraphicsItemSceneCenterPos(destinationItem));
-    destinationItem->setRotation(angle);
-    originalItem->setRotation(angle);
-    copyGraphicProperties(originalItem, destinationItem);
-}
+    QPointer<ModificationModeView> view{this};
+    QThreadPool::globalInstance()->start([view, items, jobId, snapshot, sceneRect, scale, originalBytes]() {
+        QImage image = detail::renderItemsSnapshot(snapshot, sceneRect, scale);
+        detail::invokeIfAlive(view, [=](ModificationModeView* receiver) {
+            receiver->finishFlattening(items, jobId, image, sceneRect, scale, originalBytes);
+        });
+    });
+}
+
+void ModificationModeView::finishFlattening(const QList<QGraphicsItem*>& items, int jobId, const QImage& image,
+                                            const QRectF& sceneRect, qreal scale, qint64 originalBytes) {
+    // Items could have been deleted together with their layer while the image was rendered,
+    // in which case the image shows something that no longer exists and is dropped.
+    const QList<QGraphicsItem*> sceneItems = scene()->items();
+    const QSet<QGraphicsItem*> aliveItems{sceneItems.cbegin(), sceneItems.cend()};
+    QList<QGraphicsItem*> flattenedItems;
+    for (auto* item : items) {
+        if (aliveItems.contains(item) && item->data(constants::kFlattenJobDataKey).toInt() == jobId) {
+            item->setData(constants::kFlattenJobDataKey, QVariant{});
+            flattenedItems.push_back(item);
+        }
+    }
 
-inline QLineF translateLineToSceneCoords(const QGraphicsLineItem* item) {
-    QLineF newLine{item->mapToScene(item->line().p1()),
-                   item->mapToScene(item->line().p2())};
+    if (flattenedItems.size() != items.size() || image.isNull()) {
+        for (auto* item : flattenedItems) {
+            item->setFlag(QGraphicsItem::ItemIsSelectable, true);
+        }
+        return;
+    }
 
-    return newLine;
-}
+    auto* pixmapItem = new QGraphicsPixmapItem{QPixmap::fromImage(image)};
+    pixmapItem->setTransformationMode(Qt::SmoothTransformation);
+    pixmapItem->setPos(sceneRect.topLeft());
+    pixmapItem->setScale(1.0 / scale);
+    detail::makeItemSelectableAndMovable(pixmapItem);
+    applicationScene()->addItemToLayerOf(pixmapItem, flattenedItems.back());
 
-template<typename ItemType>
-auto copyGraphicsItem(ItemType* originalItem) {
-    auto rotationAngle = originalItem->rotation();
-    originalItem->setRotation(kZeroAngle);
-    ItemType* temporaryItem{nullptr};
+    applicationScene()->deleteItems(flattenedItems);
 
-    if constexpr (std::is_same_v<ItemType, QGraphicsRectItem> || std::is_same_v<ItemType, QGraphicsEllipseItem>) {
-        temporaryItem = new ItemType{originalItem->sceneBoundingRect()};
-    } else if constexpr (std::is_same_v<ItemType, QGraphicsPolygonItem>) {
-        temporaryItem = new ItemType{originalItem->mapToScene(originalItem->polygon())};
-    } else if constexpr (std::is_same_v<ItemType, QGraphicsPathItem>) {
-        temporaryItem = new ItemType{originalItem->mapToScene(originalItem->path())};
-    } else if constexpr (std::is_same_v<ItemType, QGraphicsLineItem>) {
-        temporaryItem = new ItemType{translateLineToSceneCoords(originalItem)};
-    }
+    ItemSnapshot bakedItem;
+    bakedItem.geometry = image;
+    emit selectionFlattened(flattenedItems.size(), originalBytes - detail::estimateMemoryUsage(bakedItem));
+    emit changeStateOfScene();
+}
 
-    if (temporaryItem != nullptr)
-        setUpItemsAngles(originalItem, temporaryItem, rotationAngle);
+void ModificationModeView::setSelectionAreaProperties() {
+    selectionArea_->setPen(QPen{kSelectionAreaPen});
+    selectionArea_->setBrush(QBrush{kSelectionAreaBrush});
+    selectionArea_->hide();
+    selectionArea_->setFlag(QGraphicsItem::ItemIsSelectable, false);
+    selectionArea_->setFlag(QGraphicsItem::ItemIsMovable, false);
+    selectionArea_->setZValue(kSelectionAreaZValue);
+    scene()->addItem(selectionArea_);
 
-    return temporaryItem;
+    lassoArea_->setPen(QPen{kSelectionAreaPen});
+    lassoArea_->setBrush(QBrush{kSelectionAreaBrush});
+    lassoArea_->hide();
+    lassoArea_->setFlag(QGraphicsItem::ItemIsSelectable, false);
+    lassoArea_->setFlag(QGraphicsItem::ItemIsMovable, false);
+    lassoArea_->setZValue(kSelectionAreaZValue);
+    scene()->addItem(lassoArea_);
 }
 
-QGraphicsItem* cloneGraphicsItem(QGraphicsItem* originalItem) {
-    QGraphicsItem* copiedItem = nullptr;
+// ------------------------------------------------------------------------------------------------------------
 
-    if (auto* rectItem = qgraphicsitem_cast<QGraphicsRectItem*>(originalItem)) {
-        copiedItem = copyGraphicsItem(rectItem);
-    } else if (auto* ellipseItem = qgraphicsitem_cast<QGraphicsEllipseItem*>(originalItem)) {
-        copiedItem = copyGraphicsItem(ellipseItem);
-    } else if (auto* polygonItem = qgraphicsitem_cast<QGraphicsPolygonItem*>(originalItem)) {
-        copiedItem = copyGraphicsItem(polygonItem);
-    } else if (auto* pathItem = qgraphicsitem_cast<QGraphicsPathItem*>(originalItem)) {
-        copiedItem = copyGraphicsItem(pathItem);
-    } else if (auto* lineItem = qgraphicsitem_cast<QGraphicsLineItem*>(originalItem)) {
-        copiedItem = copyGraphicsItem(lineItem);
+void updateSceneSelection(QGraphicsScene* scene, const QList<QGraphicsItem*>& items) {
+    scene->clearSelection();
+    for (auto* item : items) {
+        item->setSelected(true);
     }
-
-    if (copiedItem != nullptr)
-        detail::makeItemSelectableAndMovable(copiedItem);
-
-    return copiedItem;
 }
 
-QList<QGraphicsItem*> cloneSelectedItems(QGraphicsScene* scene) {
+QList<QGraphicsItem*> cloneSelectedItems(ApplicationGraphicsScene* scene) {
     QList<QGraphicsItem*> clonedItems;
     for (auto* item : scene->selectedItems()) {
-        QGraphicsItem* clonedItem = cloneGraphicsItem(item);
+        QGraphicsItem* clonedItem = detail::cloneGraphicsItem(item);
         if (clonedItem) {
             clonedItems.append(clonedItem);
-            scene->addItem(clonedItem);
+            scene->addItemToLayerOf(clonedItem, item);
         }
     }
     return clonedItems;
 }
 
-qreal calculateRotationAngle(const QPointF& geometricCenterO,
-                             const QPointF& initialCursorPosA,
-                             const QPointF& currentCursorPosB) noexcept {
-    qreal angleAO = qAtan2(initialCursorPosA.y() - geometricCenterO.y(),
-                           initialCursorPosA.x() - geometricCenterO.x());
-    qreal angleBO = qAtan2(currentCursorPosB.y() - geometricCenterO.y(),
-                           currentCursorPosB.x() - geometricCenterO.x());
-
-    qreal angle = angleBO - angleAO;
-
-    if (angle < 0) angle += 2 * M_PI;
-
-    return qRadiansToDegrees(angle);
-}
-
 // ------------------------------------------------------------------------------------------------------------
 
 void RotationInfo::clear() {
@@ -383,3 +486,77 @@ const QList<QGraphicsItem*>& RotationInfo::getItems() const noexcept {
 const QList<qreal>& RotationInfo::getAngles() const noexcept {
     return angles_;
 }
+
+// ------------------------------------------------------------------------------------------------------------
+
+void LassoInfo::clear() {
+    items_.clear();
+    centersX_.clear();
+    centersY_.clear();
+    wasSelected_.clear();
+    isSelected_.clear();
+    isInsideLasso_.clear();
+    insideItems_.clear();
+}
+
+void LassoInfo::fillInfo(const QList<QGraphicsItem*>& items) {
+    clear();
+    items_.reserve(items.size());
+    centersX_.reserve(items.size());
+    centersY_.reserve(items.size());
+    wasSelected_.reserve(items.size());
+    for (auto* item : items) {
+        QPointF center = item->sceneBoundingRect().center();
+        items_.push_back(item);
+        centersX_.push_back(static_cast<float>(center.x()));
+        centersY_.push_back(static_cast<float>(center.y()));
+        wasSelected_.push_back(item->isSelected() ? 1 : 0);
+    }
+    isSelected_ = wasSelected_;
+    isInsideLasso_.assign(items_.size(), 0);
+}
+
+void LassoInfo::select(const QPolygonF& lasso) {
+    QRectF bounds = lasso.boundingRect();
+    candidates_.clear();
+    candidatesX_.clear();
+    candidatesY_.clear();
+    for (std::size_t i = 0; i < items_.size(); ++i) {
+        if (!bounds.contains(centersX_[i], centersY_[i])) continue;
+        candidates_.push_back(i);
+        candidatesX_.push_back(centersX_[i]);
+        candidatesY_.push_back(centersY_[i]);
+    }
+    isInside_.resize(candidates_.size());
+    detail::testPointsInPolygon(candidatesX_.data(), candidatesY_.data(), candidates_.size(), lasso, isInside_.data());
+
+    for (auto i : insideItems_) {
+        isInsideLasso_[i] = 0;
+    }
+    nextInsideItems_.clear();
+    for (std::size_t i = 0; i < candidates_.size(); ++i) {
+        if (isInside_[i] == 0) continue;
+        isInsideLasso_[candidates_[i]] = 1;
+        nextInsideItems_.push_back(candidates_[i]);
+    }
+
+    // Items which left the lasso are among the previous ones, items which entered it are among the next ones.
+    for (auto i : insideItems_) {
+        updateItemSelection(i);
+    }
+    for (auto i : nextInsideItems_) {
+        updateItemSelection(i);
+    }
+    insideItems_.swap(nextInsideItems_);
+}
+
+void LassoInfo::updateItemSelection(std::size_t i) {
+    auto shouldBeSelected = static_cast<std::uint8_t>(wasSelected_[i] | isInsideLasso_[i]);
+    if (shouldBeSelected == isSelected_[i]) return;
+    items_[i]->setSelected(shouldBeSelected != 0);
+    isSelected_[i] = shouldBeSelected;
+}
+
+bool LassoInfo::isEmpty() const noexcept {
+    return items_.empty();
+}
@@ -0,0 +1,113 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QPdfWriter>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../include/pdf-exporter.h"
+
+namespace {
+    // Progress is reported once per this number of items, so a large drawing does not flood the receiver.
+    constexpr qsizetype kProgressItemsStep{512};
+
+    struct PaintedItem {
+        const ItemSnapshot* item;
+        QRectF sceneBounds;
+    };
+
+    // Items of visible layers from the bottom to the top, bounds are computed once and reused by every page.
+    std::vector<PaintedItem> collectPaintedItems(const DocumentSnapshot& document) {
+        std::vector<PaintedItem> items;
+        for (const auto& layer : document.layers) {
+            if (!layer.isVisible) continue;
+            for (const auto& item : layer.items) {
+                items.push_back({&item, item.sceneBoundingRect()});
+            }
+        }
+        return items;
+    }
+}  // namespace
+
+PdfExporter::PdfExporter(PdfExportOptions options)
+    : options_(std::move(options)) {}
+
+bool PdfExporter::exportDocument(const DocumentSnapshot& document, const QString& filePath,
+                                 const ProgressCallback& progress) const {
+    QFile file{filePath};
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return exportDocument(document, &file, progress) && file.flush();
+}
+
+bool PdfExporter::exportDocument(const DocumentSnapshot& document, QIODevice* device,
+                                 const ProgressCallback& progress) const {
+    const QList<QRectF> pages = pageRects(document.canvasRect);
+    if (pages.isEmpty()) return false;
+
+    const std::vector<PaintedItem> items = collectPaintedItems(document);
+    qsizetype totalCount = 0;
+    for (const auto& page : pages) {
+        for (const auto& item : items) {
+            if (item.sceneBounds.intersects(page)) ++totalCount;
+        }
+    }
+
+    QPdfWriter writer{device};
+    writer.setResolution(options_.resolution);
+    writer.setPageLayout(QPageLayout{options_.pageSize, options_.orientation, QMarginsF{}});
+    if (auto* file = qobject_cast<QFile*>(device)) writer.setTitle(QFileInfo{file->fileName()}.completeBaseName());
+
+    QPainter painter;
+    if (!painter.begin(&writer)) return false;
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    const QRectF deviceRect{0, 0, static_cast<qreal>(writer.width()), static_cast<qreal>(writer.height())};
+    qsizetype paintedCount = 0;
+    for (qsizetype i = 0; i < pages.size(); ++i) {
+        const QRectF& page = pages[i];
+        if (i > 0 && !writer.newPage()) return false;
+
+        // The page part of the canvas is mapped onto the whole page keeping its proportions.
+        qreal scale = std::min(deviceRect.width() / page.width(), deviceRect.height() / page.height());
+        QTransform transform;
+        transform.translate((deviceRect.width() - page.width() * scale) / 2.0,
+                            (deviceRect.height() - page.height() * scale) / 2.0);
+        transform.scale(scale, scale);
+        transform.translate(-page.left(), -page.top());
+        painter.setTransform(transform);
+        painter.setClipRect(page);
+
+        for (const auto& item : items) {
+            if (!item.sceneBounds.intersects(page)) continue;
+            detail::paintItemSnapshot(painter, *item.item);
+            if (++paintedCount % kProgressItemsStep == 0 && progress) progress(paintedCount, totalCount);
+        }
+        if (progress) progress(paintedCount, totalCount);
+    }
+
+    return painter.end();
+}
+
+QList<QRectF> PdfExporter::pageRects(const QRectF& canvasRect) const {
+    if (canvasRect.isEmpty()) return {};
+    if (!options_.isSplitIntoPages) return {canvasRect};
+
+    QPageLayout layout{options_.pageSize, options_.orientation, QMarginsF{}};
+    QSizeF pageSize = layout.fullRectPixels(options_.resolution).size();
+    if (pageSize.isEmpty()) return {};
+
+    // Pages go row by row, pages of the last row and column reach past the canvas.
+    auto columnsCount = static_cast<int>(std::ceil(canvasRect.width() / pageSize.width()));
+    auto rowsCount = static_cast<int>(std::ceil(canvasRect.height() / pageSize.height()));
+    QList<QRectF> pages;
+    pages.reserve(static_cast<qsizetype>(columnsCount) * rowsCount);
+    for (int row = 0; row < rowsCount; ++row) {
+        for (int column = 0; column < columnsCount; ++column) {
+            QPointF topLeft{canvasRect.left() + column * pageSize.width(), canvasRect.top() + row * pageSize.height()};
+            pages.push_back(QRectF{topLeft, pageSize});
+        }
+    }
+    return pages;
+}
@@ -3,25 +3,26 @@
 #include <QMouseEvent>
 #include <QGraphicsLineItem>
 #include "../include/polygon-mode-view.h"
+#include "../include/graphics-scene.h"
 #include "../include/graphics-items-detail.h"
 
-PolygonModeView::PolygonModeView(QGraphicsScene* scene, QSize viewSize)
+PolygonModeView::PolygonModeView(ApplicationGraphicsScene* scene, QSize viewSize)
     : DrawingGraphicsView(scene, viewSize) {}
 
 void PolygonModeView::mousePressEvent(QMouseEvent* event) {
+    if (!applicationScene()->isActiveLayerEditable()) return;
+
     if (event->button() == Qt::LeftButton) {
             lastClickPos_ = mapToScene(event->pos());
-            auto* tmpLinePointer =
-                    scene()->addLine(QLineF{lastClickPos_, lastClickPos_});
-
-            if (tmpLinePointer == nullptr) return;
-            tmpLinePointer->setPen(QPen{strokeColor_, strokeWidth_, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin});
-            points_.push_back(lastClickPos_);
+            auto* tmpLinePointer = linePool_.acquire(scene());
+            tmpLinePointer->setLine(QLineF{lastClickPos_, lastClickPos_});
+            tmpLinePointer->setPen(shapePen());
+            points_.append(lastClickPos_);
             lineItems_.push_back(tmpLinePointer);
     } else if (event->button() == Qt::RightButton) {
         deleteTemporaryLines();
         lastClickPos_ = mapToScene(event->pos());
-        points_.push_back(lastClickPos_);
+        points_.append(lastClickPos_);
         createPolygon();
         emit changeStateOfScene();
     }
@@ -35,23 +36,14 @@ void PolygonModeView::mouseMoveEvent(QMouseEvent* event) {
 }
 
 void PolygonModeView::deleteTemporaryLines() {
-    for (auto* lineItem : lineItems_) {
-        scene()->removeItem(lineItem);
-        delete lineItem;
-    }
-    lineItems_.clear();
+    linePool_.releaseAll(lineItems_);
 }
 
 void PolygonModeView::createPolygon() {
-    QPolygonF polygon;
-    for (const auto& point : points_) {
-        polygon << point;
-    }
-    auto* polygonItem = scene()->addPolygon(polygon,
-                                            QPen{strokeColor_, strokeWidth_, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin},
-                                            QBrush{fillColor_});
+    auto* polygonItem = scene()->addPolygon(points_.toPolygon(), shapePen(), fillBrush());
 
     if (polygonItem == nullptr) return;
     detail::makeItemSelectableAndMovable(polygonItem);
-    points_.clear();
+    applicationScene()->addItemToActiveLayer(polygonItem);
+    points_.reset();
 }
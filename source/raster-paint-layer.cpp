@@ -0,0 +1,111 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+#include "../include/raster-paint-layer.h"
+
+namespace {
+    constexpr int kTileSize{256};
+    constexpr qreal kAntialiasingMargin{1.0};
+
+    inline quint64 tileKey(int column, int row) noexcept {
+        return (static_cast<quint64>(static_cast<quint32>(column)) << 32) | static_cast<quint32>(row);
+    }
+
+    inline int tileIndex(qreal coordinate) noexcept {
+        return static_cast<int>(std::floor(coordinate / kTileSize));
+    }
+}  // namespace
+
+RasterPaintLayer::RasterPaintLayer(const QRectF& canvas, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      canvas_(canvas)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setFlag(QGraphicsItem::ItemIsSelectable, false);
+    setFlag(QGraphicsItem::ItemIsMovable, false);
+}
+
+int RasterPaintLayer::type() const {
+    return Type;
+}
+
+QRectF RasterPaintLayer::boundingRect() const {
+    return canvas_;
+}
+
+QPainterPath RasterPaintLayer::shape() const {
+    return {};
+}
+
+bool RasterPaintLayer::contains(const QPointF&) const {
+    return false;
+}
+
+void RasterPaintLayer::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    QRectF exposedRect = option->exposedRect.intersected(canvas_);
+    if (exposedRect.isEmpty()) return;
+
+    for (int row = tileIndex(exposedRect.top()); row <= tileIndex(exposedRect.bottom()); ++row) {
+        for (int column = tileIndex(exposedRect.left()); column <= tileIndex(exposedRect.right()); ++column) {
+            auto tile = tiles_.constFind(tileKey(column, row));
+            if (tile != tiles_.cend())
+                painter->drawImage(QPointF(column * kTileSize, row * kTileSize), *tile);
+        }
+    }
+}
+
+void RasterPaintLayer::stampDot(const QPointF& center, qreal diameter, const QColor& color) {
+    qreal radius = diameter / 2.0;
+    QRectF dotRect{center.x() - radius, center.y() - radius, diameter, diameter};
+    paintIntoTiles(dotRect, [&](QPainter& painter) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(color);
+        painter.drawEllipse(dotRect);
+    });
+}
+
+void RasterPaintLayer::stampSegment(const QLineF& segment, const QPen& pen) {
+    qreal margin = pen.widthF() / 2.0;
+    QRectF segmentRect = QRectF{segment.p1(), segment.p2()}.normalized()
+                                                         .adjusted(-margin, -margin, margin, margin);
+    paintIntoTiles(segmentRect, [&](QPainter& painter) {
+        painter.setPen(pen);
+        painter.drawLine(segment);
+    });
+}
+
+qsizetype RasterPaintLayer::tileCount() const noexcept {
+    return tiles_.size();
+}
+
+qsizetype RasterPaintLayer::memoryUsage() const noexcept {
+    return tiles_.size() * static_cast<qsizetype>(kTileSize) * kTileSize * static_cast<qsizetype>(sizeof(QRgb));
+}
+
+template<typename PaintFunction>
+void RasterPaintLayer::paintIntoTiles(const QRectF& dirtyRect, PaintFunction paintFunction) {
+    QRectF rect = dirtyRect.adjusted(-kAntialiasingMargin, -kAntialiasingMargin,
+                                     kAntialiasingMargin, kAntialiasingMargin).intersected(canvas_);
+    if (rect.isEmpty()) return;
+
+    for (int row = tileIndex(rect.top()); row <= tileIndex(rect.bottom()); ++row) {
+        for (int column = tileIndex(rect.left()); column <= tileIndex(rect.right()); ++column) {
+            QPainter painter{&tileAt(column, row)};
+            painter.setRenderHint(QPainter::Antialiasing);
+            painter.translate(-column * kTileSize, -row * kTileSize);
+            paintFunction(painter);
+        }
+    }
+    update(rect);
+}
+
+QImage& RasterPaintLayer::tileAt(int column, int row) {
+    auto tile = tiles_.find(tileKey(column, row));
+    if (tile == tiles_.end()) {
+        tile = tiles_.insert(tileKey(column, row), QImage{kTileSize, kTileSize, QImage::Format_ARGB32_Premultiplied});
+        tile->fill(Qt::transparent);
+    }
+    return *tile;
+}
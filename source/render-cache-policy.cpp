@@ -0,0 +1,231 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include <QPixmapCache>
+#include <QtGlobal>
+#include <algorithm>
+#include "../include/render-cache-policy.h"
+#include "../include/graphics-scene.h"
+#include "../include/stroke-item.h"
+#include "../include/bezier-path-item.h"
+
+Q_LOGGING_CATEGORY(lcRenderCache, "qt_painter.render_cache")
+
+namespace {
+    constexpr auto kRenderCacheBudgetVariable{"QT_PAINTER_RENDER_CACHE_BUDGET_MB"};
+    constexpr qint64 kDefaultRenderCacheBudgetMb{64};
+    constexpr qint64 kBytesPerMb{1024 * 1024};
+    // Room in QPixmapCache for the pixmaps of icons and other users besides the item caches, in kilobytes.
+    constexpr int kPixmapCacheHeadroomKb{10 * 1024};
+
+    // Vertices below which an item is rasterized about as fast as its cache is blitted.
+    constexpr qsizetype kMinCachedComplexity{256};
+    // Vertices of a flattened Bézier segment at a usual zoom.
+    constexpr qsizetype kBezierSegmentComplexity{16};
+    // Items larger on screen take more memory for the cache than the rasterization saves, about 4 MB each.
+    constexpr qint64 kMaxCachedDeviceArea{1024 * 1024};
+    constexpr qint64 kBytesPerPixel{4};
+
+    constexpr qint64 kReportIntervalMs{5000};
+
+    qsizetype renderComplexity(const QGraphicsItem* item) {
+        switch (item->type()) {
+            case QGraphicsPolygonItem::Type:
+                return qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)->polygon().size();
+            case QGraphicsPathItem::Type:
+                return qgraphicsitem_cast<const QGraphicsPathItem*>(item)->path().elementCount();
+            case StrokeItem::Type:
+                return qgraphicsitem_cast<const StrokeItem*>(item)->pointsCount();
+            case BezierPathItem::Type:
+                return qgraphicsitem_cast<const BezierPathItem*>(item)->segmentsCount() * kBezierSegmentComplexity;
+            default:
+                return 0;
+        }
+    }
+
+    // A device coordinate cache is kept while the view is only scrolled, a zoom or rotation paints it anew.
+    bool isSameDeviceScale(const QTransform& first, const QTransform& second) {
+        return first.m11() == second.m11() && first.m12() == second.m12() &&
+               first.m21() == second.m21() && first.m22() == second.m22();
+    }
+}  // namespace
+
+RenderCachePolicy::RenderCachePolicy(ApplicationGraphicsScene* scene, QObject* parent)
+    : QObject(parent),
+      scene_(scene),
+      budgetBytes_(kDefaultRenderCacheBudgetMb * kBytesPerMb),
+      usedBytes_(0),
+      frame_(0),
+      hitsCount_(0),
+      missesCount_(0),
+      evictionsCount_(0)
+{
+    bool hasBudget = false;
+    qint64 budgetMb = qEnvironmentVariableIntValue(kRenderCacheBudgetVariable, &hasBudget);
+    if (hasBudget && budgetMb >= 0) budgetBytes_ = budgetMb * kBytesPerMb;
+    // Item caches live in QPixmapCache, which would otherwise drop them behind the policy at its default limit.
+    auto limitKb = static_cast<int>(budgetBytes_ / 1024) + kPixmapCacheHeadroomKb;
+    QPixmapCache::setCacheLimit(std::max(QPixmapCache::cacheLimit(), limitKb));
+
+    connect(scene_, &ApplicationGraphicsScene::itemsAdded, this, &RenderCachePolicy::addItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsMoved, this, &RenderCachePolicy::moveItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsTransformed, this, &RenderCachePolicy::invalidateItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsAboutToBeDeleted, this, &RenderCachePolicy::removeItems);
+    reportTimer_.start();
+}
+
+void RenderCachePolicy::notePaintedFrame(const QRectF& visibleRect, const QTransform& viewTransform, bool isDraft) {
+    ++frame_;
+    candidatesGrid_.forEachItem(visibleRect, [this, &viewTransform, isDraft](QGraphicsItem* item) {
+        if (item->isVisible()) noteVisibleItem(item, candidates_[item], viewTransform, isDraft);
+    });
+
+    evictLeastRecentlyPainted();
+    if (reportTimer_.elapsed() >= kReportIntervalMs) reportStatistics();
+}
+
+void RenderCachePolicy::refreshDraftCaches() {
+    for (auto* item : std::as_const(draftCaches_)) {
+        auto it = candidates_.find(item);
+        if (it == candidates_.end() || !it->isCached) continue;
+        // Switching the cache mode drops the pixmap and schedules a repaint of the item, which caches it anew.
+        item->setCacheMode(QGraphicsItem::NoCache);
+        item->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+        it->isCacheValid = false;
+    }
+    draftCaches_.clear();
+}
+
+qint64 RenderCachePolicy::budgetBytes() const noexcept {
+    return budgetBytes_;
+}
+
+qint64 RenderCachePolicy::usedBytes() const noexcept {
+    return usedBytes_;
+}
+
+qsizetype RenderCachePolicy::cachedItemsCount() const noexcept {
+    return static_cast<qsizetype>(recentlyPainted_.size());
+}
+
+void RenderCachePolicy::addItems(const QList<QGraphicsItem*>& items) {
+    for (auto* item : items) {
+        qsizetype complexity = renderComplexity(item);
+        if (complexity < kMinCachedComplexity || candidates_.contains(item)) continue;
+        candidates_.insert(item, CandidateItem{complexity, 0, QTransform{}, false, false, 0, recentlyPainted_.end()});
+        candidatesGrid_.update(item);
+    }
+}
+
+void RenderCachePolicy::moveItems(const QList<QGraphicsItem*>& items) {
+    for (auto* item : items) {
+        if (candidates_.contains(item)) candidatesGrid_.update(item);
+    }
+}
+
+void RenderCachePolicy::invalidateItems(const QList<QGraphicsItem*>& items) {
+    for (auto* item : items) {
+        auto it = candidates_.find(item);
+        if (it == candidates_.end()) continue;
+        it->isCacheValid = false;
+        candidatesGrid_.update(item);
+    }
+}
+
+void RenderCachePolicy::removeItems(const QList<QGraphicsItem*>& items) {
+    for (auto* item : items) {
+        auto it = candidates_.find(item);
+        if (it == candidates_.end()) continue;
+        // The item goes away together with its cache.
+        if (it->isCached) {
+            usedBytes_ -= it->cacheBytes;
+            recentlyPainted_.erase(it->recentPosition);
+        }
+        candidatesGrid_.remove(item);
+        draftCaches_.remove(item);
+        candidates_.erase(it);
+    }
+}
+
+void RenderCachePolicy::noteVisibleItem(QGraphicsItem* item, CandidateItem& candidate,
+                                        const QTransform& viewTransform, bool isDraft) {
+    QRect deviceRect = viewTransform.mapRect(item->sceneBoundingRect()).toAlignedRect();
+    qint64 deviceArea = static_cast<qint64>(deviceRect.width()) * deviceRect.height();
+    if (deviceArea > kMaxCachedDeviceArea) {
+        if (candidate.isCached) uncacheItem(item, candidate);
+        return;
+    }
+
+    candidate.paintedFrame = frame_;
+    if (!candidate.isCached) {
+        // A draft frame would fill the new cache with draft quality pixels.
+        if (!isDraft) cacheItem(item, candidate, viewTransform, deviceArea * kBytesPerPixel);
+        return;
+    }
+
+    if (!candidate.isCacheValid || !isSameDeviceScale(candidate.cacheTransform, viewTransform)) {
+        // Qt has painted the cache anew in this frame.
+        ++missesCount_;
+        usedBytes_ -= candidate.cacheBytes;
+        candidate.cacheBytes = deviceArea * kBytesPerPixel;
+        usedBytes_ += candidate.cacheBytes;
+        candidate.cacheTransform = viewTransform;
+        candidate.isCacheValid = true;
+        if (isDraft) {
+            draftCaches_.insert(item);
+        } else {
+            draftCaches_.remove(item);
+        }
+    } else {
+        ++hitsCount_;
+    }
+    recentlyPainted_.splice(recentlyPainted_.begin(), recentlyPainted_, candidate.recentPosition);
+}
+
+void RenderCachePolicy::cacheItem(QGraphicsItem* item, CandidateItem& candidate, const QTransform& viewTransform,
+                                  qint64 bytes) {
+    item->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    candidate.isCached = true;
+    // Qt fills the cache when the item is painted next time.
+    candidate.isCacheValid = false;
+    candidate.cacheBytes = bytes;
+    candidate.cacheTransform = viewTransform;
+    candidate.recentPosition = recentlyPainted_.insert(recentlyPainted_.begin(), item);
+    usedBytes_ += bytes;
+}
+
+void RenderCachePolicy::uncacheItem(QGraphicsItem* item, CandidateItem& candidate) {
+    item->setCacheMode(QGraphicsItem::NoCache);
+    candidate.isCached = false;
+    draftCaches_.remove(item);
+    usedBytes_ -= candidate.cacheBytes;
+    candidate.cacheBytes = 0;
+    recentlyPainted_.erase(candidate.recentPosition);
+    candidate.recentPosition = recentlyPainted_.end();
+}
+
+void RenderCachePolicy::evictLeastRecentlyPainted() {
+    while (usedBytes_ > budgetBytes_ && !recentlyPainted_.empty()) {
+        QGraphicsItem* item = recentlyPainted_.back();
+        CandidateItem& candidate = candidates_[item];
+        // Everything left is on screen, dropping it would only paint it anew in the next frame.
+        if (candidate.paintedFrame == frame_) break;
+        uncacheItem(item, candidate);
+        ++evictionsCount_;
+    }
+}
+
+void RenderCachePolicy::reportStatistics() {
+    qint64 lookupsCount = hitsCount_ + missesCount_;
+    if (lookupsCount > 0 || evictionsCount_ > 0) {
+        double hitRate = lookupsCount > 0 ? 100.0 * static_cast<double>(hitsCount_) / lookupsCount : 0.0;
+        qCDebug(lcRenderCache, "hit rate %.1f%% (%lld hits, %lld misses), %lld evictions, "
+                               "%lld items cached in %lld of %lld KB",
+                hitRate, hitsCount_, missesCount_, evictionsCount_,
+                static_cast<long long>(recentlyPainted_.size()), usedBytes_ / 1024, budgetBytes_ / 1024);
+    }
+    hitsCount_ = 0;
+    missesCount_ = 0;
+    evictionsCount_ = 0;
+    reportTimer_.restart();
+}
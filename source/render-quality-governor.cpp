@@ -0,0 +1,43 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsView>
+#include <QTimer>
+#include "../include/render-quality-governor.h"
+
+namespace {
+    constexpr int kSettleIntervalMs{150};
+}  // namespace
+
+RenderQualityGovernor::RenderQualityGovernor(QGraphicsView* view)
+    : QObject(view),
+      view_(view),
+      settleTimer_(new QTimer{this}),
+      isDraft_(true)
+{
+    settleTimer_->setSingleShot(true);
+    settleTimer_->setInterval(kSettleIntervalMs);
+    connect(settleTimer_, &QTimer::timeout, this, &RenderQualityGovernor::restoreFullQuality);
+    setDraft(false);
+}
+
+void RenderQualityGovernor::noteInteraction() {
+    setDraft(true);
+    settleTimer_->start();
+}
+
+bool RenderQualityGovernor::isDraft() const noexcept {
+    return isDraft_;
+}
+
+void RenderQualityGovernor::restoreFullQuality() {
+    // Changing the render hints already schedules a repaint of the whole viewport.
+    setDraft(false);
+    emit fullQualityRestored();
+}
+
+void RenderQualityGovernor::setDraft(bool isDraft) {
+    if (isDraft_ == isDraft) return;
+    isDraft_ = isDraft;
+    view_->setRenderHint(QPainter::Antialiasing, !isDraft_);
+    view_->setRenderHint(QPainter::SmoothPixmapTransform, !isDraft_);
+}
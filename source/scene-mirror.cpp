@@ -0,0 +1,338 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
+#include "../include/scene-mirror.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+#include "../include/constants.h"
+
+namespace {
+    // Roughly one message per frame, continuous drawing and dragging is merged into it.
+    constexpr int kFlushIntervalMs{16};
+
+    quint64 mirrorIdOf(const QGraphicsItem* item) {
+        return item->data(constants::kMirrorIdDataKey).toULongLong();
+    }
+}  // namespace
+
+SceneMirrorPublisher::SceneMirrorPublisher(ApplicationGraphicsScene* scene, QObject* parent)
+    : QObject(parent),
+      scene_(scene),
+      server_(new QLocalServer{this}),
+      flushTimer_(new QTimer{this}),
+      lastId_(0)
+{
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(kFlushIntervalMs);
+
+    connect(flushTimer_, &QTimer::timeout, this, &SceneMirrorPublisher::flush);
+    connect(server_, &QLocalServer::newConnection, this, &SceneMirrorPublisher::acceptConnections);
+    connect(scene_, &ApplicationGraphicsScene::itemsAdded, this, &SceneMirrorPublisher::publishAddedItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsMoved, this, &SceneMirrorPublisher::publishMovedItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsTransformed, this, &SceneMirrorPublisher::publishTransformedItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsAboutToBeDeleted, this, &SceneMirrorPublisher::publishDeletedItems);
+    connect(scene_, &ApplicationGraphicsScene::itemsRestacked, this, &SceneMirrorPublisher::publishRestackedItems);
+    connect(scene_, &ApplicationGraphicsScene::layersChanged, this, &SceneMirrorPublisher::publishLayers);
+}
+
+SceneMirrorPublisher::~SceneMirrorPublisher() = default;
+
+bool SceneMirrorPublisher::listen(const QString& serverName) {
+    // A server of a crashed instance leaves its socket file behind.
+    QLocalServer::removeServer(serverName);
+    return server_->listen(serverName);
+}
+
+void SceneMirrorPublisher::acceptConnections() {
+    while (auto* socket = server_->nextPendingConnection()) {
+        // Connected followers must get pending operations before the scene is taken for the new one.
+        flush();
+
+        Connection connection{socket, {}};
+        socket->write(connection.encoder.encode({takeScene()}));
+        connections_.push_back(std::move(connection));
+
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            connections_.erase(std::remove_if(connections_.begin(), connections_.end(),
+                                              [socket](const Connection& connection) {
+                                                  return connection.socket == socket;
+                                              }),
+                               connections_.end());
+            socket->deleteLater();
+        });
+    }
+}
+
+void SceneMirrorPublisher::publishAddedItems(const QList<QGraphicsItem*>& items) {
+    if (!hasConnections()) return;
+
+    CreateItemsOperation create;
+    create.items.reserve(items.size());
+    for (auto* item : items) {
+        if (detail::isSnapshotSupported(item)) create.items.push_back(takeMirrorItem(item));
+    }
+    if (!create.items.isEmpty()) enqueue(std::move(create));
+}
+
+void SceneMirrorPublisher::publishMovedItems(const QList<QGraphicsItem*>& items, const QPointF& delta) {
+    if (!hasConnections() || items.isEmpty()) return;
+
+    MoveItemsOperation move{{}, delta};
+    move.ids.reserve(items.size());
+    for (auto* item : items) {
+        move.ids.push_back(itemId(item));
+    }
+    std::sort(move.ids.begin(), move.ids.end());
+    enqueue(std::move(move));
+}
+
+void SceneMirrorPublisher::publishTransformedItems(const QList<QGraphicsItem*>& items) {
+    if (!hasConnections() || items.isEmpty()) return;
+
+    TransformItemsOperation transform;
+    transform.transforms.reserve(items.size());
+    for (auto* item : items) {
+        transform.transforms.push_back(MirrorItemTransform{itemId(item),
+                                                           item->pos(),
+                                                           item->transformOriginPoint(),
+                                                           item->rotation(),
+                                                           item->scale()});
+    }
+    enqueue(std::move(transform));
+}
+
+void SceneMirrorPublisher::publishDeletedItems(const QList<QGraphicsItem*>& items) {
+    if (!hasConnections()) return;
+
+    // Items without ids have never been sent to followers.
+    DeleteItemsOperation deletion;
+    for (const auto* item : items) {
+        if (quint64 id = mirrorIdOf(item); id != 0) deletion.ids.push_back(id);
+    }
+    if (!deletion.ids.isEmpty()) enqueue(std::move(deletion));
+}
+
+void SceneMirrorPublisher::publishRestackedItems(const QList<QGraphicsItem*>& items, StackingMove move) {
+    if (!hasConnections()) return;
+
+    RestackItemsOperation restack{{}, move};
+    for (const auto* item : items) {
+        if (quint64 id = mirrorIdOf(item); id != 0) restack.ids.push_back(id);
+    }
+    if (!restack.ids.isEmpty()) enqueue(std::move(restack));
+}
+
+void SceneMirrorPublisher::publishLayers() {
+    if (!hasConnections()) return;
+    enqueue(UpdateLayersOperation{takeLayers()});
+}
+
+void SceneMirrorPublisher::flush() {
+    if (pendingOperations_.isEmpty()) return;
+    for (auto& connection : connections_) {
+        connection.socket->write(connection.encoder.encode(pendingOperations_));
+    }
+    pendingOperations_.clear();
+}
+
+void SceneMirrorPublisher::enqueue(MirrorOperation operation) {
+    if (!pendingOperations_.isEmpty() && detail::mergeMirrorOperation(pendingOperations_.back(), operation)) return;
+    pendingOperations_.push_back(std::move(operation));
+    if (!flushTimer_->isActive()) flushTimer_->start();
+}
+
+bool SceneMirrorPublisher::hasConnections() const noexcept {
+    return !connections_.empty();
+}
+
+quint64 SceneMirrorPublisher::itemId(QGraphicsItem* item) {
+    quint64 id = mirrorIdOf(item);
+    if (id == 0) {
+        id = ++lastId_;
+        item->setData(constants::kMirrorIdDataKey, id);
+    }
+    return id;
+}
+
+MirrorItem SceneMirrorPublisher::takeMirrorItem(QGraphicsItem* item) {
+    auto* layer = qgraphicsitem_cast<LayerItem*>(item->parentItem());
+    return MirrorItem{itemId(item), layer != nullptr ? itemId(layer) : 0, detail::takeItemSnapshot(item)};
+}
+
+QList<MirrorLayer> SceneMirrorPublisher::takeLayers() {
+    QList<MirrorLayer> layers;
+    layers.reserve(scene_->getLayers().size());
+    for (auto* layer : scene_->getLayers()) {
+        layers.push_back(MirrorLayer{itemId(layer), layer->getName(), layer->isVisible(), layer->isLocked()});
+    }
+    return layers;
+}
+
+ResetSceneOperation SceneMirrorPublisher::takeScene() {
+    ResetSceneOperation reset{takeLayers(), {}};
+    for (auto* layer : scene_->getLayers()) {
+        for (auto* item : layer->childItems()) {
+            if (detail::isSnapshotSupported(item)) reset.items.push_back(takeMirrorItem(item));
+        }
+    }
+    return reset;
+}
+
+// ------------------------------------------------------------------------------------------------------------
+
+SceneMirrorFollower::SceneMirrorFollower(ApplicationGraphicsScene* scene, QObject* parent)
+    : QObject(parent),
+      scene_(scene),
+      socket_(new QLocalSocket{this})
+{
+    connect(socket_, &QLocalSocket::readyRead, this, &SceneMirrorFollower::readMessages);
+    connect(socket_, &QLocalSocket::disconnected, this, &SceneMirrorFollower::disconnected);
+    connect(socket_, &QLocalSocket::errorOccurred, this, &SceneMirrorFollower::disconnected);
+    connect(scene_, &ApplicationGraphicsScene::itemsAboutToBeDeleted, this, &SceneMirrorFollower::forgetItems);
+    connect(scene_, &ApplicationGraphicsScene::layersChanged, this, &SceneMirrorFollower::forgetRemovedLayers);
+}
+
+void SceneMirrorFollower::connectToPublisher(const QString& serverName) {
+    socket_->connectToServer(serverName);
+}
+
+void SceneMirrorFollower::readMessages() {
+    decoder_.append(socket_->readAll());
+    while (auto operations = decoder_.takeMessage()) {
+        for (const auto& operation : *operations) {
+            apply(operation);
+        }
+    }
+    if (!decoder_.isValid()) socket_->abort();
+}
+
+void SceneMirrorFollower::forgetItems(const QList<QGraphicsItem*>& items) {
+    for (const auto* item : items) {
+        if (quint64 id = mirrorIdOf(item); id != 0 && items_.value(id) == item) items_.remove(id);
+    }
+}
+
+void SceneMirrorFollower::forgetRemovedLayers() {
+    const auto& layers = scene_->getLayers();
+    for (auto layer = layers_.begin(); layer != layers_.end();) {
+        if (layers.contains(layer.value())) ++layer;
+        else layer = layers_.erase(layer);
+    }
+}
+
+void SceneMirrorFollower::apply(const MirrorOperation& operation) {
+    if (const auto* reset = std::get_if<ResetSceneOperation>(&operation)) {
+        resetScene(*reset);
+    } else if (const auto* update = std::get_if<UpdateLayersOperation>(&operation)) {
+        updateLayers(update->layers);
+    } else if (const auto* create = std::get_if<CreateItemsOperation>(&operation)) {
+        createItems(create->items);
+    } else if (const auto* move = std::get_if<MoveItemsOperation>(&operation)) {
+        moveItems(*move);
+    } else if (const auto* transform = std::get_if<TransformItemsOperation>(&operation)) {
+        transformItems(transform->transforms);
+    } else if (const auto* deletion = std::get_if<DeleteItemsOperation>(&operation)) {
+        deleteItems(deletion->ids);
+    } else if (const auto* restack = std::get_if<RestackItemsOperation>(&operation)) {
+        restackItems(*restack);
+    }
+}
+
+void SceneMirrorFollower::resetScene(const ResetSceneOperation& reset) {
+    // The scene always keeps at least one layer, so own layers are removed after the mirrored ones are added.
+    const QList<LayerItem*> ownLayers = scene_->getLayers();
+    scene_->clearSelection();
+    items_.clear();
+    layers_.clear();
+
+    for (const auto& layer : reset.layers) {
+        layers_.insert(layer.id, scene_->addLayer(layer.name));
+    }
+    createItems(reset.items);
+    updateLayers(reset.layers);
+
+    for (auto* layer : ownLayers) {
+        scene_->removeLayer(layer);
+    }
+}
+
+void SceneMirrorFollower::updateLayers(const QList<MirrorLayer>& layers) {
+    QSet<quint64> layerIds;
+    for (const auto& mirroredLayer : layers) {
+        layerIds.insert(mirroredLayer.id);
+        auto* layer = layers_.value(mirroredLayer.id);
+        if (layer == nullptr) {
+            layer = scene_->addLayer(mirroredLayer.name);
+            layers_.insert(mirroredLayer.id, layer);
+        }
+        scene_->setLayerName(layer, mirroredLayer.name);
+        scene_->setLayerVisible(layer, mirroredLayer.isVisible);
+        scene_->setLayerLocked(layer, mirroredLayer.isLocked);
+    }
+
+    // Removing a layer changes layers_, so the removed ones are collected first.
+    QList<LayerItem*> removedLayers;
+    for (auto layer = layers_.cbegin(); layer != layers_.cend(); ++layer) {
+        if (!layerIds.contains(layer.key())) removedLayers.push_back(layer.value());
+    }
+    for (auto* layer : removedLayers) {
+        scene_->removeLayer(layer);
+    }
+}
+
+void SceneMirrorFollower::createItems(const QList<MirrorItem>& items) {
+    // Items are inserted into each layer in one batch.
+    QHash<LayerItem*, QList<QGraphicsItem*>> layersItems;
+    for (const auto& mirroredItem : items) {
+        auto* item = detail::createItemFromSnapshot(mirroredItem.snapshot);
+        item->setData(constants::kMirrorIdDataKey, mirroredItem.id);
+        items_.insert(mirroredItem.id, item);
+        layersItems[layers_.value(mirroredItem.layerId, scene_->getActiveLayer())].push_back(item);
+    }
+
+    for (auto layerItems = layersItems.cbegin(); layerItems != layersItems.cend(); ++layerItems) {
+        scene_->addItemsToLayer(layerItems.key(), layerItems.value());
+    }
+}
+
+void SceneMirrorFollower::moveItems(const MoveItemsOperation& move) {
+    scene_->moveItems(findItems(move.ids), move.delta);
+}
+
+void SceneMirrorFollower::transformItems(const QList<MirrorItemTransform>& transforms) {
+    QList<QGraphicsItem*> items;
+    items.reserve(transforms.size());
+    for (const auto& transform : transforms) {
+        auto* item = items_.value(transform.id);
+        if (item == nullptr) continue;
+        item->setPos(transform.position);
+        item->setTransformOriginPoint(transform.transformOrigin);
+        item->setRotation(transform.rotation);
+        item->setScale(transform.scale);
+        items.push_back(item);
+    }
+    // The document model of the follower is kept up to date through the scene, like with any other change.
+    if (!items.isEmpty()) scene_->notifyItemsTransformed(items);
+}
+
+void SceneMirrorFollower::deleteItems(const QList<quint64>& ids) {
+    scene_->deleteItems(findItems(ids));
+}
+
+void SceneMirrorFollower::restackItems(const RestackItemsOperation& restack) {
+    scene_->restackItems(findItems(restack.ids), restack.move);
+}
+
+QList<QGraphicsItem*> SceneMirrorFollower::findItems(const QList<quint64>& ids) const {
+    QList<QGraphicsItem*> items;
+    items.reserve(ids.size());
+    for (auto id : ids) {
+        if (auto* item = items_.value(id)) items.push_back(item);
+    }
+    return items;
+}
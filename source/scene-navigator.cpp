@@ -0,0 +1,142 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QThreadPool>
+#include <QTimer>
+#include "../include/scene-navigator.h"
+#include "../include/graphics-scene.h"
+#include "../include/graphics-view.h"
+#include "../include/async-detail.h"
+
+namespace {
+    constexpr int kThumbnailWidth{200};
+    // Changes are collected for a while, continuous drawing and dragging is rendered a few times per second.
+    constexpr int kRenderDelayMs{100};
+
+    constexpr Qt::GlobalColor kCanvasColor{Qt::white};
+    constexpr Qt::GlobalColor kVisibleAreaColor{Qt::red};
+    constexpr Qt::GlobalColor kFrameColor{Qt::gray};
+}  // namespace
+
+SceneNavigator::SceneNavigator(ApplicationGraphicsScene* scene, const QRectF& canvas, QWidget* parent)
+    : QWidget(parent),
+      scene_(scene),
+      canvas_(canvas),
+      scale_(kThumbnailWidth / canvas.width()),
+      thumbnail_((canvas.size() * scale_).toSize(), QImage::Format_ARGB32_Premultiplied),
+      renderTimer_(new QTimer{this}),
+      isRendering_(false)
+{
+    thumbnail_.fill(kCanvasColor);
+    setFixedSize(sizeHint());
+    setCursor(Qt::PointingHandCursor);
+
+    renderTimer_->setSingleShot(true);
+    renderTimer_->setInterval(kRenderDelayMs);
+    connect(renderTimer_, &QTimer::timeout, this, &SceneNavigator::renderDirtyRegion);
+    connect(scene_, &ApplicationGraphicsScene::layerItemsRegionChanged, this, &SceneNavigator::markDirty);
+
+    markDirty({canvas_});
+}
+
+void SceneNavigator::setView(ApplicationGraphicsView* view) {
+    if (view_ != nullptr) disconnect(view_, nullptr, this, nullptr);
+    view_ = view;
+    if (view_ != nullptr) {
+        connect(view_, &ApplicationGraphicsView::visibleAreaChanged, this, qOverload<>(&QWidget::update));
+    }
+    update();
+}
+
+QSize SceneNavigator::sizeHint() const {
+    return thumbnail_.size() + QSize{2, 2};
+}
+
+void SceneNavigator::paintEvent(QPaintEvent*) {
+    QPainter painter{this};
+    painter.drawImage(QPointF{1, 1}, thumbnail_);
+    painter.setPen(kFrameColor);
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    if (view_ == nullptr) return;
+    QRectF visibleArea = view_->mapToScene(view_->viewport()->rect()).boundingRect().intersected(canvas_);
+    painter.setPen(QPen{kVisibleAreaColor, 0});
+    painter.drawRect(QRectF{(visibleArea.topLeft() - canvas_.topLeft()) * scale_, visibleArea.size() * scale_}
+                             .translated(1, 1));
+}
+
+void SceneNavigator::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) centerViewOn(event->position());
+}
+
+void SceneNavigator::mouseMoveEvent(QMouseEvent* event) {
+    if (event->buttons() & Qt::LeftButton) centerViewOn(event->position());
+}
+
+void SceneNavigator::markDirty(const QList<QRectF>& region) {
+    QRect thumbnailBounds = thumbnail_.rect();
+    for (const auto& rect : region) {
+        QRectF thumbnailRect{(rect.topLeft() - canvas_.topLeft()) * scale_, rect.size() * scale_};
+        dirtyRegion_ += thumbnailRect.toAlignedRect().intersected(thumbnailBounds);
+    }
+    if (!dirtyRegion_.isEmpty() && !isRendering_ && !renderTimer_->isActive()) renderTimer_->start();
+}
+
+void SceneNavigator::renderDirtyRegion() {
+    if (dirtyRegion_.isEmpty()) return;
+    isRendering_ = true;
+
+    QList<QRect> pixelRects{dirtyRegion_.begin(), dirtyRegion_.end()};
+    dirtyRegion_ = QRegion{};
+    QRectF dirtySceneRect;
+    for (const auto& pixelRect : pixelRects) {
+        dirtySceneRect |= QRectF{canvas_.topLeft() + QPointF{pixelRect.topLeft()} / scale_,
+                                 QSizeF{pixelRect.size()} / scale_};
+    }
+    // Snapshots are taken on the GUI thread, the worker does not touch the scene.
+    QList<ItemSnapshot> items = takeVisibleItems(dirtySceneRect);
+
+    QPointer<SceneNavigator> navigator{this};
+    QThreadPool::globalInstance()->start([navigator, pixelRects, items, canvas = canvas_, scale = scale_]() {
+        QList<Patch> patches;
+        patches.reserve(pixelRects.size());
+        for (const auto& pixelRect : pixelRects) {
+            QRectF sceneRect{canvas.topLeft() + QPointF{pixelRect.topLeft()} / scale,
+                             QSizeF{pixelRect.size()} / scale};
+            QList<ItemSnapshot> patchItems;
+            for (const auto& item : items) {
+                if (item.sceneBoundingRect().intersects(sceneRect)) patchItems.push_back(item);
+            }
+            patches.push_back(Patch{pixelRect, detail::renderItemsSnapshot(patchItems, sceneRect, scale)});
+        }
+        detail::invokeIfAlive(navigator, [patches](SceneNavigator* receiver) { receiver->applyPatches(patches); });
+    });
+}
+
+void SceneNavigator::applyPatches(const QList<Patch>& patches) {
+    QPainter painter{&thumbnail_};
+    for (const auto& patch : patches) {
+        painter.fillRect(patch.pixelRect, kCanvasColor);
+        painter.drawImage(patch.pixelRect, patch.image);
+    }
+    painter.end();
+    update();
+
+    isRendering_ = false;
+    if (!dirtyRegion_.isEmpty()) renderTimer_->start();
+}
+
+QList<ItemSnapshot> SceneNavigator::takeVisibleItems(const QRectF& sceneRect) const {
+    // Items of a cached layer are hidden while the layer paints them from its cache,
+    // so visibility of the layer is what counts.
+    QList<QGraphicsItem*> items = scene_->layerItems(sceneRect);
+    items.removeIf([](const QGraphicsItem* item) { return !item->parentItem()->isVisible(); });
+    return detail::takeItemsSnapshot(items);
+}
+
+void SceneNavigator::centerViewOn(const QPointF& widgetPosition) {
+    if (view_ == nullptr) return;
+    view_->centerOn(canvas_.topLeft() + (widgetPosition - QPointF{1, 1}) / scale_);
+}
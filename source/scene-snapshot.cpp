@@ -0,0 +1,300 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QDataStream>
+#include <QGraphicsItem>
+#include <QPainter>
+#include "../include/scene-snapshot.h"
+#include "../include/graphics-items-detail.h"
+#include "../include/style-registry.h"
+#include "../include/stroke-item.h"
+#include "../include/bezier-path-item.h"
+
+namespace {
+    // Approximate size of a QGraphicsItem subclass together with its private data.
+    constexpr qint64 kItemOverheadBytes{512};
+
+    template<typename... Visitors>
+    struct Overloaded : Visitors... {
+        using Visitors::operator()...;
+    };
+
+    template<typename... Visitors>
+    Overloaded(Visitors...) -> Overloaded<Visitors...>;
+
+    // Lines, strokes and Bézier paths are only stroked.
+    template<typename ItemType>
+    constexpr bool kHasBrush{!std::is_same_v<ItemType, QGraphicsLineItem> && !std::is_same_v<ItemType, StrokeItem> &&
+                             !std::is_same_v<ItemType, BezierPathItem>};
+
+    template<typename ItemType>
+    void copyStyle(const ItemType* item, ItemSnapshot& snapshot) {
+        snapshot.pen = item->pen();
+        if constexpr (kHasBrush<ItemType>) {
+            snapshot.brush = item->brush();
+        }
+    }
+
+    template<typename ItemType>
+    void applyStyle(ItemType* item, const ItemSnapshot& snapshot) {
+        item->setPen(StyleRegistry::instance().pen(snapshot.pen));
+        if constexpr (kHasBrush<ItemType>) {
+            item->setBrush(StyleRegistry::instance().brush(snapshot.brush));
+        }
+    }
+
+    template<typename Alternative>
+    void readGeometry(QDataStream& stream, ItemGeometry& geometry) {
+        Alternative value;
+        stream >> value;
+        geometry = std::move(value);
+    }
+}  // namespace
+
+QTransform ItemSnapshot::sceneTransform() const {
+    QTransform transform;
+    transform.translate(position.x(), position.y());
+    transform.translate(transformOrigin.x(), transformOrigin.y());
+    transform.rotate(rotation);
+    transform.scale(scale, scale);
+    transform.translate(-transformOrigin.x(), -transformOrigin.y());
+    return transform;
+}
+
+QRectF ItemSnapshot::boundingRect() const {
+    QRectF rect = std::visit(Overloaded{
+            [](const QRectF& rectangle) { return rectangle.normalized(); },
+            [](const QLineF& line) { return QRectF{line.p1(), line.p2()}.normalized(); },
+            [](const QPolygonF& polygon) { return polygon.boundingRect(); },
+            [](const QPainterPath& path) { return path.controlPointRect(); },
+            [](const QImage& image) { return QRectF{image.rect()}; }
+        }, geometry);
+
+    if (pen.style() == Qt::NoPen || std::holds_alternative<QImage>(geometry)) return rect;
+    qreal margin = pen.widthF() / 2.0;
+    return rect.adjusted(-margin, -margin, margin, margin);
+}
+
+QRectF ItemSnapshot::sceneBoundingRect() const {
+    return sceneTransform().mapRect(boundingRect());
+}
+
+QDataStream& operator<<(QDataStream& stream, const ItemSnapshot& item) {
+    detail::writeItemGeometry(stream, item);
+    stream << item.pen << item.brush;
+    detail::writeItemPlacement(stream, item);
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, ItemSnapshot& item) {
+    if (!detail::readItemGeometry(stream, item)) return stream;
+    stream >> item.pen >> item.brush;
+    detail::readItemPlacement(stream, item);
+    return stream;
+}
+
+namespace detail {
+
+    void writeItemGeometry(QDataStream& stream, const ItemSnapshot& item) {
+        stream << static_cast<qint32>(item.type) << static_cast<quint8>(item.geometry.index());
+        std::visit([&stream](const auto& geometry) { stream << geometry; }, item.geometry);
+    }
+
+    bool readItemGeometry(QDataStream& stream, ItemSnapshot& item) {
+        qint32 type = 0;
+        quint8 geometryIndex = 0;
+        stream >> type >> geometryIndex;
+        item.type = type;
+
+        switch (geometryIndex) {
+            case 0: readGeometry<QRectF>(stream, item.geometry); break;
+            case 1: readGeometry<QLineF>(stream, item.geometry); break;
+            case 2: readGeometry<QPolygonF>(stream, item.geometry); break;
+            case 3: readGeometry<QPainterPath>(stream, item.geometry); break;
+            case 4: readGeometry<QImage>(stream, item.geometry); break;
+            default:
+                stream.setStatus(QDataStream::ReadCorruptData);
+                return false;
+        }
+        return stream.status() == QDataStream::Ok;
+    }
+
+    void writeItemPlacement(QDataStream& stream, const ItemSnapshot& item) {
+        stream << item.position << item.transformOrigin << item.rotation << item.scale;
+    }
+
+    void readItemPlacement(QDataStream& stream, ItemSnapshot& item) {
+        stream >> item.position >> item.transformOrigin >> item.rotation >> item.scale;
+    }
+
+    bool isSnapshotSupported(const QGraphicsItem* item) {
+        switch (item->type()) {
+            case QGraphicsRectItem::Type:
+            case QGraphicsEllipseItem::Type:
+            case QGraphicsLineItem::Type:
+            case QGraphicsPolygonItem::Type:
+            case QGraphicsPathItem::Type:
+            case QGraphicsPixmapItem::Type:
+            case StrokeItem::Type:
+            case BezierPathItem::Type:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    ItemSnapshot takeItemSnapshot(const QGraphicsItem* item) {
+        ItemSnapshot snapshot;
+        snapshot.type = item->type();
+        snapshot.position = item->scenePos();
+        snapshot.transformOrigin = item->transformOriginPoint();
+        snapshot.rotation = item->rotation();
+        snapshot.scale = item->scale();
+
+        if (const auto* rectItem = qgraphicsitem_cast<const QGraphicsRectItem*>(item)) {
+            snapshot.geometry = rectItem->rect();
+            copyStyle(rectItem, snapshot);
+        } else if (const auto* ellipseItem = qgraphicsitem_cast<const QGraphicsEllipseItem*>(item)) {
+            snapshot.geometry = ellipseItem->rect();
+            copyStyle(ellipseItem, snapshot);
+        } else if (const auto* lineItem = qgraphicsitem_cast<const QGraphicsLineItem*>(item)) {
+            snapshot.geometry = lineItem->line();
+            copyStyle(lineItem, snapshot);
+        } else if (const auto* polygonItem = qgraphicsitem_cast<const QGraphicsPolygonItem*>(item)) {
+            snapshot.geometry = polygonItem->polygon();
+            copyStyle(polygonItem, snapshot);
+        } else if (const auto* pathItem = qgraphicsitem_cast<const QGraphicsPathItem*>(item)) {
+            snapshot.geometry = pathItem->path();
+            copyStyle(pathItem, snapshot);
+        } else if (const auto* strokeItem = qgraphicsitem_cast<const StrokeItem*>(item)) {
+            snapshot.geometry = strokeItem->points();
+            copyStyle(strokeItem, snapshot);
+        } else if (const auto* bezierItem = qgraphicsitem_cast<const BezierPathItem*>(item)) {
+            snapshot.geometry = bezierItem->path();
+            copyStyle(bezierItem, snapshot);
+        } else if (const auto* pixmapItem = qgraphicsitem_cast<const QGraphicsPixmapItem*>(item)) {
+            snapshot.geometry = pixmapItem->pixmap().toImage();
+            snapshot.pen = QPen{Qt::NoPen};
+        }
+
+        return snapshot;
+    }
+
+    QList<ItemSnapshot> takeItemsSnapshot(const QList<QGraphicsItem*>& items) {
+        QList<ItemSnapshot> snapshots;
+        snapshots.reserve(items.size());
+        for (const auto* item : items) {
+            if (isSnapshotSupported(item)) snapshots.push_back(takeItemSnapshot(item));
+        }
+        return snapshots;
+    }
+
+    QGraphicsItem* createItemFromSnapshot(const ItemSnapshot& item) {
+        QGraphicsItem* created = std::visit(Overloaded{
+                [&](const QRectF& rectangle) -> QGraphicsItem* {
+                    if (item.type == QGraphicsEllipseItem::Type) {
+                        auto* ellipseItem = new QGraphicsEllipseItem{rectangle};
+                        applyStyle(ellipseItem, item);
+                        return ellipseItem;
+                    }
+                    auto* rectItem = new QGraphicsRectItem{rectangle};
+                    applyStyle(rectItem, item);
+                    return rectItem;
+                },
+                [&](const QLineF& line) -> QGraphicsItem* {
+                    auto* lineItem = new QGraphicsLineItem{line};
+                    applyStyle(lineItem, item);
+                    return lineItem;
+                },
+                [&](const QPolygonF& polygon) -> QGraphicsItem* {
+                    if (item.type == StrokeItem::Type) {
+                        auto* strokeItem = new StrokeItem{polygon};
+                        applyStyle(strokeItem, item);
+                        return strokeItem;
+                    }
+                    auto* polygonItem = new QGraphicsPolygonItem{polygon};
+                    applyStyle(polygonItem, item);
+                    return polygonItem;
+                },
+                [&](const QPainterPath& path) -> QGraphicsItem* {
+                    if (item.type == BezierPathItem::Type) {
+                        auto* bezierItem = new BezierPathItem{BezierPathItem::controlPointsOf(path)};
+                        applyStyle(bezierItem, item);
+                        return bezierItem;
+                    }
+                    auto* pathItem = new QGraphicsPathItem{path};
+                    applyStyle(pathItem, item);
+                    return pathItem;
+                },
+                [&](const QImage& image) -> QGraphicsItem* {
+                    auto* pixmapItem = new QGraphicsPixmapItem{QPixmap::fromImage(image)};
+                    pixmapItem->setTransformationMode(Qt::SmoothTransformation);
+                    return pixmapItem;
+                }
+            }, item.geometry);
+
+        created->setPos(item.position);
+        created->setTransformOriginPoint(item.transformOrigin);
+        created->setRotation(item.rotation);
+        created->setScale(item.scale);
+        detail::makeItemSelectableAndMovable(created);
+        return created;
+    }
+
+    void paintItemSnapshot(QPainter& painter, const ItemSnapshot& item) {
+        painter.save();
+        painter.setTransform(item.sceneTransform(), true);
+        painter.setPen(item.pen);
+        painter.setBrush(item.brush);
+
+        std::visit(Overloaded{
+                [&](const QRectF& rectangle) {
+                    if (item.type == QGraphicsEllipseItem::Type) painter.drawEllipse(rectangle);
+                    else painter.drawRect(rectangle);
+                },
+                [&](const QLineF& line) { painter.drawLine(line); },
+                [&](const QPolygonF& polygon) {
+                    if (item.type == StrokeItem::Type) painter.drawPolyline(polygon);
+                    else painter.drawPolygon(polygon);
+                },
+                [&](const QPainterPath& path) { painter.drawPath(path); },
+                [&](const QImage& image) {
+                    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+                    painter.drawImage(QPointF{0, 0}, image);
+                }
+            }, item.geometry);
+
+        painter.restore();
+    }
+
+    QImage renderItemsSnapshot(const QList<ItemSnapshot>& items, const QRectF& sceneRect, qreal scale) {
+        QImage image{(sceneRect.size() * scale).toSize(), QImage::Format_ARGB32_Premultiplied};
+        if (image.isNull()) return image;
+        image.fill(Qt::transparent);
+
+        QPainter painter{&image};
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.scale(scale, scale);
+        painter.translate(-sceneRect.topLeft());
+        for (const auto& item : items) {
+            paintItemSnapshot(painter, item);
+        }
+        return image;
+    }
+
+    qint64 estimateMemoryUsage(const ItemSnapshot& item) noexcept {
+        qint64 geometryBytes = std::visit(Overloaded{
+                [&item](const QPolygonF& polygon) {
+                    if (item.type == StrokeItem::Type)
+                        return static_cast<qint64>(StrokeItem::estimateEncodedSize(polygon.size()));
+                    return static_cast<qint64>(polygon.size() * sizeof(QPointF));
+                },
+                [](const QPainterPath& path) {
+                    return static_cast<qint64>(path.elementCount() * sizeof(QPainterPath::Element));
+                },
+                [](const QImage& image) { return static_cast<qint64>(image.sizeInBytes()); },
+                [](const auto&) { return qint64{0}; }
+            }, item.geometry);
+        return kItemOverheadBytes + geometryBytes;
+    }
+
+}  // namespace detail
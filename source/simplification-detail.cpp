@@ -0,0 +1,108 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "../include/simplification-detail.h"
+#include "../include/scene-snapshot.h"
+
+namespace {
+    constexpr qsizetype kMinPolygonPointsCount{3};
+
+    qreal squaredDistanceToSegment(const QPointF& point, const QPointF& start, const QPointF& end) {
+        QPointF segment = end - start;
+        qreal squaredLength = QPointF::dotProduct(segment, segment);
+        qreal t = 0.0;
+        if (squaredLength > 0.0) t = std::clamp(QPointF::dotProduct(point - start, segment) / squaredLength, 0.0, 1.0);
+        QPointF difference = point - (start + t * segment);
+        return QPointF::dotProduct(difference, difference);
+    }
+
+    bool hasOnlyStraightSegments(const QPainterPath& path) {
+        for (int i = 0; i < path.elementCount(); ++i) {
+            if (path.elementAt(i).isCurveTo()) return false;
+        }
+        return true;
+    }
+
+    void appendSimplifiedPolyline(QPainterPath& path, const QPolygonF& polyline, qreal tolerance) {
+        if (polyline.size() < 2) return;
+        QPolygonF simplified = detail::simplifyPolyline(polyline, tolerance);
+        path.moveTo(simplified.front());
+        for (qsizetype i = 1; i < simplified.size(); ++i) {
+            path.lineTo(simplified[i]);
+        }
+    }
+}  // namespace
+
+namespace detail {
+
+    QPolygonF simplifyPolyline(const QPolygonF& polyline, qreal tolerance) {
+        if (polyline.size() <= 2) return polyline;
+
+        qreal squaredTolerance = tolerance * tolerance;
+        std::vector<bool> isKept(static_cast<std::size_t>(polyline.size()), false);
+        isKept.front() = true;
+        isKept.back() = true;
+
+        std::vector<std::pair<qsizetype, qsizetype>> ranges{{0, polyline.size() - 1}};
+        while (!ranges.empty()) {
+            auto [first, last] = ranges.back();
+            ranges.pop_back();
+
+            qreal maxSquaredDistance = 0.0;
+            qsizetype farthest = first;
+            for (qsizetype i = first + 1; i < last; ++i) {
+                qreal squaredDistance = squaredDistanceToSegment(polyline[i], polyline[first], polyline[last]);
+                if (squaredDistance > maxSquaredDistance) {
+                    maxSquaredDistance = squaredDistance;
+                    farthest = i;
+                }
+            }
+
+            if (maxSquaredDistance > squaredTolerance) {
+                isKept[static_cast<std::size_t>(farthest)] = true;
+                ranges.emplace_back(first, farthest);
+                ranges.emplace_back(farthest, last);
+            }
+        }
+
+        QPolygonF simplified;
+        for (qsizetype i = 0; i < polyline.size(); ++i) {
+            if (isKept[static_cast<std::size_t>(i)]) simplified << polyline[i];
+        }
+        return simplified;
+    }
+
+    QPainterPath simplifyPath(const QPainterPath& path, qreal tolerance, bool joinSubpaths) {
+        if (path.isEmpty() || !hasOnlyStraightSegments(path)) return path;
+
+        QPainterPath simplified;
+        simplified.setFillRule(path.fillRule());
+
+        QPolygonF polyline;
+        for (int i = 0; i < path.elementCount(); ++i) {
+            const auto& element = path.elementAt(i);
+            QPointF point{element.x, element.y};
+            if (element.isMoveTo()) {
+                if (joinSubpaths && !polyline.isEmpty() && polyline.back() == point) continue;
+                appendSimplifiedPolyline(simplified, polyline, tolerance);
+                polyline.clear();
+            }
+            polyline << point;
+        }
+        appendSimplifiedPolyline(simplified, polyline, tolerance);
+        return simplified;
+    }
+
+    void simplifyItemSnapshot(ItemSnapshot& item, qreal tolerance) {
+        if (auto* polygon = std::get_if<QPolygonF>(&item.geometry)) {
+            QPolygonF simplified = simplifyPolyline(*polygon, tolerance);
+            if (simplified.size() >= kMinPolygonPointsCount) *polygon = std::move(simplified);
+        } else if (auto* path = std::get_if<QPainterPath>(&item.geometry)) {
+            // Only stroked paths may be joined, joining changes which subpaths are closed when filling.
+            *path = simplifyPath(*path, tolerance, item.brush.style() == Qt::NoBrush);
+        }
+    }
+
+}  // namespace detail
@@ -0,0 +1,71 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QtGlobal>
+#include "../include/startup-timer.h"
+
+Q_LOGGING_CATEGORY(lcStartup, "qt_painter.startup")
+
+namespace {
+    constexpr auto kStartupBudgetVariable{"QT_PAINTER_STARTUP_BUDGET_MS"};
+    constexpr qint64 kDefaultStartupBudgetMs{1000};
+}  // namespace
+
+StartupTimer::StartupTimer()
+    : suspendedMs_(0),
+      suspendStartMs_(-1),
+      isFinished_(false) {}
+
+StartupTimer& StartupTimer::instance() {
+    static StartupTimer timer;
+    return timer;
+}
+
+void StartupTimer::start() {
+    timer_.start();
+    suspendedMs_ = 0;
+    suspendStartMs_ = -1;
+    isFinished_ = false;
+}
+
+void StartupTimer::suspend() {
+    if (!timer_.isValid() || suspendStartMs_ >= 0) return;
+    suspendStartMs_ = timer_.elapsed();
+}
+
+void StartupTimer::resume() {
+    if (suspendStartMs_ < 0) return;
+    suspendedMs_ += timer_.elapsed() - suspendStartMs_;
+    suspendStartMs_ = -1;
+}
+
+void StartupTimer::markPhase(std::string_view phase) {
+    if (!timer_.isValid() || isFinished_) return;
+    qCDebug(lcStartup, "%.*s after %lld ms", static_cast<int>(phase.size()), phase.data(), elapsedMs());
+}
+
+void StartupTimer::finish() {
+    if (!timer_.isValid() || isFinished_) return;
+    isFinished_ = true;
+
+    bool hasBudget = false;
+    qint64 budgetMs = qEnvironmentVariableIntValue(kStartupBudgetVariable, &hasBudget);
+    if (!hasBudget) budgetMs = kDefaultStartupBudgetMs;
+
+    qint64 totalMs = elapsedMs();
+    if (totalMs > budgetMs) {
+        qCWarning(lcStartup, "first paint after %lld ms, over the budget of %lld ms", totalMs, budgetMs);
+    } else {
+        qCInfo(lcStartup, "first paint after %lld ms (budget %lld ms)", totalMs, budgetMs);
+    }
+}
+
+qint64 StartupTimer::elapsedMs() const noexcept {
+    if (!timer_.isValid()) return 0;
+    qint64 suspendedMs = suspendedMs_;
+    if (suspendStartMs_ >= 0) suspendedMs += timer_.elapsed() - suspendStartMs_;
+    return timer_.elapsed() - suspendedMs;
+}
+
+bool StartupTimer::isFinished() const noexcept {
+    return isFinished_;
+}
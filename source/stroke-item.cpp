@@ -0,0 +1,186 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainter>
+#include <QPainterPathStroker>
+#include <QStyle>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+#include "../include/stroke-item.h"
+
+namespace {
+    constexpr qreal kFixedPointScale{16.0};
+    // Differences up to 4 pixels take a byte, up to 512 pixels two bytes.
+    constexpr qsizetype kEstimatedBytesPerCoordinate{2};
+
+    inline qint64 toFixedPoint(qreal coordinate) noexcept {
+        return std::llround(coordinate * kFixedPointScale);
+    }
+
+    void appendVarint(QByteArray& buffer, qint64 value) {
+        // Zigzag encoding keeps small negative differences as short as positive ones.
+        auto bits = (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+        while (bits >= 0x80) {
+            buffer.append(static_cast<char>((bits & 0x7f) | 0x80));
+            bits >>= 7;
+        }
+        buffer.append(static_cast<char>(bits));
+    }
+
+    inline qint64 readVarint(const char*& data) noexcept {
+        quint64 bits = 0;
+        int shift = 0;
+        quint8 byte = 0;
+        do {
+            byte = static_cast<quint8>(*data++);
+            bits |= static_cast<quint64>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return static_cast<qint64>(bits >> 1) ^ -static_cast<qint64>(bits & 1);
+    }
+
+    void skipClosePoints(QPolygonF& points, qreal minDistance) {
+        if (points.size() <= 2) return;
+        qreal minDistanceSquared = minDistance * minDistance;
+        qsizetype keptCount = 1;
+        for (qsizetype i = 1; i < points.size() - 1; ++i) {
+            QPointF offset = points[i] - points[keptCount - 1];
+            if (QPointF::dotProduct(offset, offset) >= minDistanceSquared) points[keptCount++] = points[i];
+        }
+        // The last point is always kept, so the stroke ends where it was drawn.
+        points[keptCount++] = points.back();
+        points.resize(keptCount);
+    }
+
+    qreal distanceToSegment(const QPointF& point, const QPointF& start, const QPointF& end) noexcept {
+        QPointF direction = end - start;
+        qreal lengthSquared = QPointF::dotProduct(direction, direction);
+        qreal t = lengthSquared > 0.0 ? QPointF::dotProduct(point - start, direction) / lengthSquared : 0.0;
+        QPointF closest = start + direction * std::clamp(t, 0.0, 1.0);
+        return std::hypot(point.x() - closest.x(), point.y() - closest.y());
+    }
+}  // namespace
+
+StrokeItem::StrokeItem(const QPolygonF& points, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      pointsCount_(points.size()),
+      pointsRect_(points.boundingRect())
+{
+    encodedPoints_.reserve(points.size() * kEstimatedBytesPerCoordinate * 2);
+    qint64 previousX = 0;
+    qint64 previousY = 0;
+    for (const auto& point : points) {
+        // Differences are taken between rounded coordinates, so rounding errors do not accumulate along the stroke.
+        qint64 x = toFixedPoint(point.x());
+        qint64 y = toFixedPoint(point.y());
+        appendVarint(encodedPoints_, x - previousX);
+        appendVarint(encodedPoints_, y - previousY);
+        previousX = x;
+        previousY = y;
+    }
+    encodedPoints_.squeeze();
+    updateBoundingRect();
+}
+
+int StrokeItem::type() const {
+    return Type;
+}
+
+QRectF StrokeItem::boundingRect() const {
+    return boundingRect_;
+}
+
+QPainterPath StrokeItem::shape() const {
+    QPainterPath path;
+    path.addPolygon(points());
+    QPainterPathStroker stroker{pen_};
+    return stroker.createStroke(path);
+}
+
+bool StrokeItem::contains(const QPointF& point) const {
+    if (!boundingRect_.contains(point) || pointsCount_ == 0) return false;
+
+    qreal radius = std::max(pen_.widthF(), 1.0) / 2.0;
+    const char* data = encodedPoints_.constData();
+    qint64 x = readVarint(data);
+    qint64 y = readVarint(data);
+    QPointF previous{x / kFixedPointScale, y / kFixedPointScale};
+    if (pointsCount_ == 1) return distanceToSegment(point, previous, previous) <= radius;
+
+    for (qsizetype i = 1; i < pointsCount_; ++i) {
+        x += readVarint(data);
+        y += readVarint(data);
+        QPointF current{x / kFixedPointScale, y / kFixedPointScale};
+        if (distanceToSegment(point, previous, current) <= radius) return true;
+        previous = current;
+    }
+    return false;
+}
+
+void StrokeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    // Decoded points of the painted stroke, the buffer keeps its capacity for the following strokes.
+    thread_local QPolygonF points;
+    decodePoints(points);
+    // Views paint draft frames without antialiasing, then points closer than a device pixel are skipped.
+    if (widget != nullptr && !(painter->renderHints() & QPainter::Antialiasing)) {
+        skipClosePoints(points, 1.0 / QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()));
+    }
+
+    painter->setPen(pen_);
+    painter->setBrush(Qt::NoBrush);
+    if (points.size() == 1) painter->drawPoint(points.front());
+    else painter->drawPolyline(points);
+
+    if (option != nullptr && (option->state & QStyle::State_Selected)) {
+        painter->setPen(QPen{option->palette.windowText(), 0, Qt::DashLine});
+        painter->drawRect(boundingRect_);
+    }
+}
+
+QPen StrokeItem::pen() const {
+    return pen_;
+}
+
+void StrokeItem::setPen(const QPen& pen) {
+    if (pen_ == pen) return;
+    prepareGeometryChange();
+    pen_ = pen;
+    updateBoundingRect();
+    update();
+}
+
+QPolygonF StrokeItem::points() const {
+    QPolygonF points;
+    decodePoints(points);
+    return points;
+}
+
+qsizetype StrokeItem::pointsCount() const noexcept {
+    return pointsCount_;
+}
+
+qsizetype StrokeItem::encodedSize() const noexcept {
+    return encodedPoints_.size();
+}
+
+qsizetype StrokeItem::estimateEncodedSize(qsizetype pointsCount) noexcept {
+    return pointsCount * kEstimatedBytesPerCoordinate * 2;
+}
+
+void StrokeItem::decodePoints(QPolygonF& points) const {
+    points.resize(pointsCount_);
+    const char* data = encodedPoints_.constData();
+    qint64 x = 0;
+    qint64 y = 0;
+    for (auto& point : points) {
+        x += readVarint(data);
+        y += readVarint(data);
+        point = QPointF{x / kFixedPointScale, y / kFixedPointScale};
+    }
+}
+
+void StrokeItem::updateBoundingRect() {
+    // Round caps and joins stick out of the points by half of the pen width.
+    qreal margin = pen_.style() == Qt::NoPen ? 0.0 : std::max(pen_.widthF(), 1.0) / 2.0;
+    boundingRect_ = pointsRect_.adjusted(-margin, -margin, margin, margin);
+}
@@ -0,0 +1,48 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include "../include/style-registry.h"
+
+namespace detail {
+
+    size_t qHash(const StyleKey& key, size_t seed) noexcept {
+        return qHashMulti(seed, key.color, key.width, key.miterLimit, key.dashOffset, key.style, key.capStyle,
+                          key.joinStyle, key.isCosmetic);
+    }
+
+    std::optional<StyleKey> penStyleKey(const QPen& pen) {
+        if (pen.style() == Qt::CustomDashLine || pen.brush().style() != Qt::SolidPattern) return std::nullopt;
+        return StyleKey{pen.color().rgba64(), pen.widthF(), pen.miterLimit(), pen.dashOffset(), pen.style(),
+                        pen.capStyle(), pen.joinStyle(), pen.isCosmetic()};
+    }
+
+    std::optional<StyleKey> brushStyleKey(const QBrush& brush) {
+        if (brush.style() != Qt::SolidPattern && brush.style() != Qt::NoBrush) return std::nullopt;
+        return StyleKey{brush.color().rgba64(), 0.0, 0.0, 0.0, brush.style(), 0, 0, false};
+    }
+
+}  // namespace detail
+
+StyleRegistry& StyleRegistry::instance() {
+    static StyleRegistry registry;
+    return registry;
+}
+
+QPen StyleRegistry::pen(const QPen& pen) {
+    auto key = detail::penStyleKey(pen);
+    if (!key) return pen;
+    auto it = pens_.find(*key);
+    if (it == pens_.end()) it = pens_.insert(*key, pen);
+    return *it;
+}
+
+QBrush StyleRegistry::brush(const QBrush& brush) {
+    auto key = detail::brushStyleKey(brush);
+    if (!key) return brush;
+    auto it = brushes_.find(*key);
+    if (it == brushes_.end()) it = brushes_.insert(*key, brush);
+    return *it;
+}
+
+qsizetype StyleRegistry::size() const noexcept {
+    return pens_.size() + brushes_.size();
+}
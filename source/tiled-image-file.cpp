@@ -0,0 +1,229 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include "../include/tiled-image-file.h"
+
+namespace {
+    using std::operator ""sv;
+
+    constexpr quint32 kTilesMagic{0x51544C53};
+    constexpr quint32 kTilesVersion{1};
+    // The header takes a whole page, so every tile starts at a page boundary.
+    constexpr qint64 kHeaderSize{4096};
+    constexpr qint64 kBytesPerPixel{4};
+    constexpr qint64 kTileBytes{TiledImageFile::kTileSize * TiledImageFile::kTileSize * kBytesPerPixel};
+    constexpr QImage::Format kTileFormat{QImage::Format_ARGB32_Premultiplied};
+    // Decoded rows of the image kept in memory at once while the tiles of the full resolution are written.
+    constexpr qint64 kDecodingBudgetBytes{64 * 1024 * 1024};
+    constexpr auto kCacheDirectory{"backgrounds"sv};
+    constexpr auto kCacheSuffix{".qtiles"sv};
+    constexpr auto kPartialSuffix{".part"sv};
+
+    struct TilesLayout {
+        std::vector<QSize> tilesCounts;
+        std::vector<qint64> levelOffsets;
+        qint64 fileSize{kHeaderSize};
+    };
+
+    int tilesFor(int pixels) noexcept {
+        return (pixels + TiledImageFile::kTileSize - 1) / TiledImageFile::kTileSize;
+    }
+
+    TilesLayout makeLayout(QSize size) {
+        TilesLayout layout;
+        QSize levelSize = size;
+        while (true) {
+            QSize tilesCount{tilesFor(levelSize.width()), tilesFor(levelSize.height())};
+            layout.tilesCounts.push_back(tilesCount);
+            layout.levelOffsets.push_back(layout.fileSize);
+            layout.fileSize += static_cast<qint64>(tilesCount.width()) * tilesCount.height() * kTileBytes;
+            if (tilesCount.width() == 1 && tilesCount.height() == 1) break;
+            levelSize = QSize{(levelSize.width() + 1) / 2, (levelSize.height() + 1) / 2};
+        }
+        return layout;
+    }
+
+    uchar* tileData(uchar* data, const TilesLayout& layout, int level, int column, int row) noexcept {
+        qint64 index = static_cast<qint64>(row) * layout.tilesCounts[level].width() + column;
+        return data + layout.levelOffsets[level] + index * kTileBytes;
+    }
+
+    void writeBand(uchar* data, const TilesLayout& layout, const QImage& band, int firstTileRow) {
+        const int bytesPerTileLine = TiledImageFile::kTileSize * kBytesPerPixel;
+        for (int y = 0; y < band.height(); ++y) {
+            int row = firstTileRow + y / TiledImageFile::kTileSize;
+            int tileY = y % TiledImageFile::kTileSize;
+            const uchar* line = band.constScanLine(y);
+            for (int column = 0; column < layout.tilesCounts[0].width(); ++column) {
+                int x = column * TiledImageFile::kTileSize;
+                int width = std::min(TiledImageFile::kTileSize, band.width() - x);
+                std::memcpy(tileData(data, layout, 0, column, row) + tileY * bytesPerTileLine,
+                            line + x * kBytesPerPixel, static_cast<std::size_t>(width * kBytesPerPixel));
+            }
+        }
+    }
+
+    // Decodes the image in bands of whole tile rows, when the format can decode a part of the image by itself.
+    bool writeFullResolution(const QString& imagePath, uchar* data, const TilesLayout& layout, QSize size) {
+        QImageReader probe{imagePath};
+        QImage image;
+        if (!probe.supportsOption(QImageIOHandler::ClipRect)) {
+            probe.setAllocationLimit(0);
+            if (!probe.read(&image)) return false;
+            image.convertTo(kTileFormat);
+        }
+
+        qint64 bandRows = kDecodingBudgetBytes / (size.width() * kBytesPerPixel) / TiledImageFile::kTileSize;
+        int bandTileRows = static_cast<int>(std::max<qint64>(bandRows, 1));
+        for (int row = 0; row < layout.tilesCounts[0].height(); row += bandTileRows) {
+            int top = row * TiledImageFile::kTileSize;
+            int height = std::min(bandTileRows * TiledImageFile::kTileSize, size.height() - top);
+            QRect bandRect{0, top, size.width(), height};
+            QImage band;
+            if (image.isNull()) {
+                QImageReader reader{imagePath};
+                reader.setAllocationLimit(0);
+                reader.setClipRect(bandRect);
+                if (!reader.read(&band)) return false;
+                band.convertTo(kTileFormat);
+            } else {
+                band = image.copy(bandRect);
+            }
+            writeBand(data, layout, band, row);
+        }
+        return true;
+    }
+
+    void writeReducedLevel(uchar* data, const TilesLayout& layout, int level) {
+        const int halfTile = TiledImageFile::kTileSize / 2;
+        const QSize sourceTiles = layout.tilesCounts[level - 1];
+        for (int row = 0; row < layout.tilesCounts[level].height(); ++row) {
+            for (int column = 0; column < layout.tilesCounts[level].width(); ++column) {
+                QImage tile{tileData(data, layout, level, column, row), TiledImageFile::kTileSize,
+                            TiledImageFile::kTileSize, TiledImageFile::kTileSize * kBytesPerPixel, kTileFormat};
+                QPainter painter{&tile};
+                painter.setRenderHint(QPainter::SmoothPixmapTransform);
+                painter.setCompositionMode(QPainter::CompositionMode_Source);
+                for (int dy = 0; dy < 2; ++dy) {
+                    for (int dx = 0; dx < 2; ++dx) {
+                        int sourceColumn = column * 2 + dx;
+                        int sourceRow = row * 2 + dy;
+                        if (sourceColumn >= sourceTiles.width() || sourceRow >= sourceTiles.height()) continue;
+                        const QImage source{tileData(data, layout, level - 1, sourceColumn, sourceRow),
+                                            TiledImageFile::kTileSize, TiledImageFile::kTileSize,
+                                            TiledImageFile::kTileSize * kBytesPerPixel, kTileFormat};
+                        painter.drawImage(QRectF(dx * halfTile, dy * halfTile, halfTile, halfTile), source);
+                    }
+                }
+            }
+        }
+    }
+}  // namespace
+
+TiledImageFile::~TiledImageFile() {
+    if (data_ != nullptr) file_.unmap(const_cast<uchar*>(data_));
+}
+
+bool TiledImageFile::build(const QString& imagePath, const QString& cachePath) {
+    if (TiledImageFile{}.open(cachePath)) return true;
+
+    QSize size = QImageReader{imagePath}.size();
+    if (size.isEmpty()) return false;
+    TilesLayout layout = makeLayout(size);
+
+    QString partialPath = cachePath + kPartialSuffix.data();
+    QFile file{partialPath};
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(layout.fileSize)) return false;
+    uchar* data = file.map(0, layout.fileSize);
+    if (data == nullptr) return false;
+
+    QByteArray header;
+    QDataStream stream{&header, QIODevice::WriteOnly};
+    stream << kTilesMagic << kTilesVersion << size.width() << size.height() << kTileSize;
+    std::memcpy(data, header.constData(), static_cast<std::size_t>(header.size()));
+
+    bool isWritten = writeFullResolution(imagePath, data, layout, size);
+    if (isWritten) {
+        for (int level = 1; level < static_cast<int>(layout.tilesCounts.size()); ++level) {
+            writeReducedLevel(data, layout, level);
+        }
+    }
+    file.unmap(data);
+    file.close();
+
+    if (!isWritten) {
+        QFile::remove(partialPath);
+        return false;
+    }
+    QFile::remove(cachePath);
+    return QFile::rename(partialPath, cachePath);
+}
+
+QString TiledImageFile::cachePathFor(const QString& imagePath) {
+    QFileInfo info{imagePath};
+    QCryptographicHash hash{QCryptographicHash::Sha1};
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+
+    QDir directory{QStandardPaths::writableLocation(QStandardPaths::CacheLocation)};
+    directory.mkpath(kCacheDirectory.data());
+    directory.cd(kCacheDirectory.data());
+    return directory.filePath(QString::fromLatin1(hash.result().toHex()) + kCacheSuffix.data());
+}
+
+bool TiledImageFile::open(const QString& cachePath) {
+    file_.setFileName(cachePath);
+    if (!file_.open(QIODevice::ReadOnly) || file_.size() < kHeaderSize) return false;
+
+    QByteArray header = file_.read(kHeaderSize);
+    QDataStream stream{header};
+    quint32 magic = 0;
+    quint32 version = 0;
+    int width = 0;
+    int height = 0;
+    int tileSize = 0;
+    stream >> magic >> version >> width >> height >> tileSize;
+    if (magic != kTilesMagic || version != kTilesVersion || tileSize != kTileSize || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    TilesLayout layout = makeLayout(QSize{width, height});
+    if (file_.size() != layout.fileSize) return false;
+    data_ = file_.map(0, layout.fileSize);
+    if (data_ == nullptr) return false;
+
+    size_ = QSize{width, height};
+    tilesCounts_ = std::move(layout.tilesCounts);
+    levelOffsets_ = std::move(layout.levelOffsets);
+    return true;
+}
+
+QSize TiledImageFile::size() const noexcept {
+    return size_;
+}
+
+int TiledImageFile::levelsCount() const noexcept {
+    return static_cast<int>(levelOffsets_.size());
+}
+
+QSize TiledImageFile::tilesCount(int level) const noexcept {
+    return tilesCounts_[level];
+}
+
+QImage TiledImageFile::tile(int level, int column, int row) const {
+    qint64 index = static_cast<qint64>(row) * tilesCounts_[level].width() + column;
+    // A read-only image over the mapped memory, which is paged in when the image is painted.
+    return QImage{data_ + levelOffsets_[level] + index * kTileBytes, kTileSize, kTileSize,
+                  kTileSize * kBytesPerPixel, kTileFormat};
+}
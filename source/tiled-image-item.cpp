@@ -0,0 +1,67 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <algorithm>
+#include <cmath>
+#include "../include/tiled-image-item.h"
+
+TiledImageItem::TiledImageItem(std::unique_ptr<TiledImageFile> file, QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      file_(std::move(file))
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setFlag(QGraphicsItem::ItemIsSelectable, false);
+    setFlag(QGraphicsItem::ItemIsMovable, false);
+}
+
+int TiledImageItem::type() const {
+    return Type;
+}
+
+QRectF TiledImageItem::boundingRect() const {
+    return QRectF{QPointF{0, 0}, file_->size()};
+}
+
+QPainterPath TiledImageItem::shape() const {
+    return {};
+}
+
+bool TiledImageItem::contains(const QPointF&) const {
+    return false;
+}
+
+void TiledImageItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*) {
+    QRectF exposedRect = option->exposedRect.intersected(boundingRect());
+    if (exposedRect.isEmpty()) return;
+
+    const int level = levelFor(painter->worldTransform());
+    const qreal tileSceneSize = std::ldexp(static_cast<qreal>(TiledImageFile::kTileSize), level);
+    const QSize tilesCount = file_->tilesCount(level);
+    int firstColumn = static_cast<int>(exposedRect.left() / tileSceneSize);
+    int lastColumn = std::min(static_cast<int>(exposedRect.right() / tileSceneSize), tilesCount.width() - 1);
+    int firstRow = static_cast<int>(exposedRect.top() / tileSceneSize);
+    int lastRow = std::min(static_cast<int>(exposedRect.bottom() / tileSceneSize), tilesCount.height() - 1);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            QRectF target{column * tileSceneSize, row * tileSceneSize, tileSceneSize, tileSceneSize};
+            painter->drawImage(target, file_->tile(level, column, row));
+        }
+    }
+}
+
+void TiledImageItem::fitInto(const QRectF& canvasRect) {
+    QSizeF imageSize = file_->size();
+    if (imageSize.isEmpty()) return;
+    qreal fitScale = std::min({canvasRect.width() / imageSize.width(), canvasRect.height() / imageSize.height(), 1.0});
+    setScale(fitScale);
+    setPos(canvasRect.topLeft());
+}
+
+int TiledImageItem::levelFor(const QTransform& worldTransform) const {
+    // Every level halves the resolution, the level is picked by how many image pixels fall on a device pixel.
+    qreal levelOfDetail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(worldTransform);
+    int level = levelOfDetail > 0.0 ? static_cast<int>(std::floor(std::log2(1.0 / levelOfDetail))) : 0;
+    return std::clamp(level, 0, file_->levelsCount() - 1);
+}
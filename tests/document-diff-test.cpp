@@ -0,0 +1,124 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsRectItem>
+#include <QtTest>
+#include "../include/document-diff.h"
+
+namespace {
+    // Far enough to leave the neighbouring cells of the proximity search.
+    constexpr qreal kFarDistance{5000.0};
+
+    ItemSnapshot makeRectangle(const QPointF& position, const QColor& color = Qt::black) {
+        ItemSnapshot item;
+        item.type = QGraphicsRectItem::Type;
+        item.geometry = QRectF{0, 0, 40, 20};
+        item.pen = QPen{color, 2.0};
+        item.position = position;
+        return item;
+    }
+
+    DocumentSnapshot makeDocument(const QList<QList<ItemSnapshot>>& layersItems) {
+        DocumentSnapshot document;
+        for (const auto& items : layersItems) {
+            LayerSnapshot layer;
+            layer.items = items;
+            document.layers.push_back(layer);
+        }
+        return document;
+    }
+}  // namespace
+
+class DocumentDiffTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void equalDocumentsHaveNoDifference();
+    void itemsChangedLayerAreUnchanged();
+    void movedItemKeepsPreviousBounds();
+    void movedItemMatchesNearestEqualItem();
+    void farMovedItemIsMatched();
+    void restyledItemIsFound();
+    void unmatchedItemsAreAddedOrRemoved();
+};
+
+void DocumentDiffTest::equalDocumentsHaveNoDifference() {
+    DocumentSnapshot document = makeDocument({{makeRectangle({0, 0}), makeRectangle({100, 0})},
+                                              {makeRectangle({0, 100})}});
+
+    DocumentDifference difference = detail::diffDocuments(document, document);
+    QVERIFY(difference.items.isEmpty());
+    QCOMPARE(difference.unchangedCount, qsizetype{3});
+}
+
+void DocumentDiffTest::itemsChangedLayerAreUnchanged() {
+    DocumentSnapshot before = makeDocument({{makeRectangle({0, 0})}, {}});
+    DocumentSnapshot after = makeDocument({{}, {makeRectangle({0, 0})}});
+
+    DocumentDifference difference = detail::diffDocuments(before, after);
+    QVERIFY(difference.items.isEmpty());
+    QCOMPARE(difference.unchangedCount, qsizetype{1});
+}
+
+void DocumentDiffTest::movedItemKeepsPreviousBounds() {
+    ItemSnapshot item = makeRectangle({0, 0});
+    ItemSnapshot movedItem = makeRectangle({30, 10});
+
+    DocumentDifference difference = detail::diffDocuments(makeDocument({{item}}), makeDocument({{movedItem}}));
+    QCOMPARE(difference.items.size(), qsizetype{1});
+    const ItemDifference& moved = difference.items.front();
+    QVERIFY(moved.change == ItemChange::kMoved);
+    QCOMPARE(moved.sceneBounds, movedItem.sceneBoundingRect());
+    QCOMPARE(moved.previousSceneBounds, item.sceneBoundingRect());
+}
+
+void DocumentDiffTest::movedItemMatchesNearestEqualItem() {
+    ItemSnapshot nearItem = makeRectangle({0, 0});
+    ItemSnapshot farItem = makeRectangle({200, 0});
+    DocumentSnapshot before = makeDocument({{farItem, nearItem}});
+    DocumentSnapshot after = makeDocument({{makeRectangle({10, 0})}});
+
+    DocumentDifference difference = detail::diffDocuments(before, after);
+    QCOMPARE(difference.count(ItemChange::kMoved), qsizetype{1});
+    QCOMPARE(difference.count(ItemChange::kRemoved), qsizetype{1});
+    for (const auto& item : difference.items) {
+        if (item.change == ItemChange::kMoved) {
+            QCOMPARE(item.previousSceneBounds, nearItem.sceneBoundingRect());
+        } else {
+            QCOMPARE(item.sceneBounds, farItem.sceneBoundingRect());
+        }
+    }
+}
+
+void DocumentDiffTest::farMovedItemIsMatched() {
+    DocumentSnapshot before = makeDocument({{makeRectangle({0, 0})}});
+    DocumentSnapshot after = makeDocument({{makeRectangle({kFarDistance, kFarDistance})}});
+
+    DocumentDifference difference = detail::diffDocuments(before, after);
+    QCOMPARE(difference.items.size(), qsizetype{1});
+    QVERIFY(difference.items.front().change == ItemChange::kMoved);
+}
+
+void DocumentDiffTest::restyledItemIsFound() {
+    DocumentSnapshot before = makeDocument({{makeRectangle({0, 0}, Qt::black)}});
+    DocumentSnapshot after = makeDocument({{makeRectangle({0, 0}, Qt::red)}});
+
+    DocumentDifference difference = detail::diffDocuments(before, after);
+    QCOMPARE(difference.items.size(), qsizetype{1});
+    QVERIFY(difference.items.front().change == ItemChange::kRestyled);
+    QCOMPARE(difference.items.front().item.pen.color(), QColor{Qt::red});
+}
+
+void DocumentDiffTest::unmatchedItemsAreAddedOrRemoved() {
+    ItemSnapshot removedItem = makeRectangle({0, 0});
+    ItemSnapshot addedItem = makeRectangle({0, 0});
+    addedItem.geometry = QLineF{0, 0, 40, 20};
+    addedItem.type = QGraphicsLineItem::Type;
+
+    DocumentDifference difference = detail::diffDocuments(makeDocument({{removedItem}}), makeDocument({{addedItem}}));
+    QCOMPARE(difference.count(ItemChange::kRemoved), qsizetype{1});
+    QCOMPARE(difference.count(ItemChange::kAdded), qsizetype{1});
+    QCOMPARE(difference.unchangedCount, qsizetype{0});
+}
+
+QTEST_MAIN(DocumentDiffTest)
+#include "document-diff-test.moc"
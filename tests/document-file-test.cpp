@@ -0,0 +1,93 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QGraphicsRectItem>
+#include <QtTest>
+#include "../include/document-file.h"
+
+namespace {
+    // The magic number every document starts with.
+    constexpr quint32 kDocumentMagic{0x51504e54};
+    constexpr quint16 kInlineStylesVersion{1};
+    constexpr quint16 kDocumentVersion{2};
+
+    DocumentSnapshot makeDocument() {
+        ItemSnapshot item;
+        item.type = QGraphicsRectItem::Type;
+        item.geometry = QRectF{0, 0, 40, 20};
+        item.pen = QPen{Qt::blue, 3.0};
+        item.position = QPointF{10, 20};
+
+        DocumentSnapshot document;
+        document.canvasRect = QRectF{0, 0, 800, 600};
+        document.layers.push_back(LayerSnapshot{});
+        document.layers.front().name = QStringLiteral("Layer");
+        document.layers.front().items = {item};
+        return document;
+    }
+
+    // A document whose header says `version`, followed by the body of a version 1 document without layers.
+    QByteArray makeDocumentOfVersion(quint16 version) {
+        QByteArray data;
+        QDataStream stream{&data, QIODevice::WriteOnly};
+        stream.setVersion(QDataStream::Qt_6_5);
+        stream << kDocumentMagic << version << QRectF{0, 0, 800, 600} << quint32{0};
+        return data;
+    }
+}  // namespace
+
+class DocumentFileTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void documentSurvivesWriting();
+    void knownVersionIsRead();
+    void unknownVersionIsRejected_data();
+    void unknownVersionIsRejected();
+};
+
+void DocumentFileTest::documentSurvivesWriting() {
+    DocumentSnapshot document = makeDocument();
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QVERIFY(detail::writeDocument(&buffer, document));
+    buffer.seek(0);
+
+    auto loadedDocument = detail::readDocument(&buffer);
+    QVERIFY(loadedDocument.has_value());
+    QCOMPARE(loadedDocument->canvasRect, document.canvasRect);
+    QCOMPARE(loadedDocument->layers.size(), qsizetype{1});
+    QCOMPARE(loadedDocument->layers.front().name, document.layers.front().name);
+    const auto& items = loadedDocument->layers.front().items;
+    QCOMPARE(items.size(), qsizetype{1});
+    QCOMPARE(items.front().pen, document.layers.front().items.front().pen);
+    QCOMPARE(items.front().position, document.layers.front().items.front().position);
+}
+
+void DocumentFileTest::knownVersionIsRead() {
+    QByteArray data = makeDocumentOfVersion(kInlineStylesVersion);
+    QBuffer buffer{&data};
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QVERIFY(detail::readDocument(&buffer).has_value());
+}
+
+void DocumentFileTest::unknownVersionIsRejected_data() {
+    QTest::addColumn<int>("version");
+
+    QTest::newRow("zero") << 0;
+    QTest::newRow("newer") << kDocumentVersion + 1;
+    QTest::newRow("garbage") << 0xffff;
+}
+
+void DocumentFileTest::unknownVersionIsRejected() {
+    QFETCH(int, version);
+
+    QByteArray data = makeDocumentOfVersion(static_cast<quint16>(version));
+    QBuffer buffer{&data};
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QVERIFY(!detail::readDocument(&buffer).has_value());
+}
+
+QTEST_MAIN(DocumentFileTest)
+#include "document-file-test.moc"
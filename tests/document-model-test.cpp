@@ -0,0 +1,42 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsRectItem>
+#include <QtTest>
+#include "../include/document-model.h"
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+
+namespace {
+    const QRectF kCanvasRect{0, 0, 800, 600};
+    // Layers are usually at the origin, an offset one tells scene coordinates from the ones of the layer.
+    const QPointF kLayerOffset{100, 50};
+}  // namespace
+
+class DocumentModelTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void placementIsKeptInSceneCoordinates();
+};
+
+void DocumentModelTest::placementIsKeptInSceneCoordinates() {
+    ApplicationGraphicsScene scene;
+    auto* layer = scene.addLayer(QStringLiteral("Layer"));
+    layer->setPos(kLayerOffset);
+    auto* item = new QGraphicsRectItem{0, 0, 40, 20};
+    scene.addItemsToLayer(layer, {item});
+    DocumentModel model{&scene};
+
+    scene.moveItems({item}, QPointF{10, 0});
+    ItemSnapshot movedItem = model.snapshot(kCanvasRect).layers.front().items.front();
+    QCOMPARE(movedItem.position, detail::takeItemSnapshot(item).position);
+
+    item->setRotation(30.0);
+    scene.notifyItemsTransformed({item});
+    ItemSnapshot transformedItem = model.snapshot(kCanvasRect).layers.front().items.front();
+    QCOMPARE(transformedItem.position, detail::takeItemSnapshot(item).position);
+    QCOMPARE(transformedItem.rotation, 30.0);
+}
+
+QTEST_MAIN(DocumentModelTest)
+#include "document-model-test.moc"
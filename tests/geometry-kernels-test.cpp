@@ -0,0 +1,117 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsItem>
+#include <QtTest>
+#include <memory>
+#include "../include/rectangles-detail.h"
+#include "../include/item-transformations-detail.h"
+#include "../include/item-copy-detail.h"
+
+class GeometryKernelsTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void makeRectangleIsNormalized_data();
+    void makeRectangleIsNormalized();
+    void makeSquareTakesShorterSide_data();
+    void makeSquareTakesShorterSide();
+    void rotationAngleIsInFullTurn_data();
+    void rotationAngleIsInFullTurn();
+    void polygonCenterIsMeanOfPoints();
+    void copiedRectKeepsSceneGeometry();
+    void copiedPolygonKeepsSceneGeometry();
+};
+
+void GeometryKernelsTest::makeRectangleIsNormalized_data() {
+    QTest::addColumn<QPointF>("start");
+    QTest::addColumn<QPointF>("current");
+    QTest::addColumn<QRectF>("expected");
+
+    QTest::newRow("down right") << QPointF{10, 20} << QPointF{40, 60} << QRectF{10, 20, 30, 40};
+    QTest::newRow("up left") << QPointF{40, 60} << QPointF{10, 20} << QRectF{10, 20, 30, 40};
+    QTest::newRow("up right") << QPointF{10, 60} << QPointF{40, 20} << QRectF{10, 20, 30, 40};
+    QTest::newRow("empty") << QPointF{10, 20} << QPointF{10, 20} << QRectF{10, 20, 0, 0};
+}
+
+void GeometryKernelsTest::makeRectangleIsNormalized() {
+    QFETCH(QPointF, start);
+    QFETCH(QPointF, current);
+    QFETCH(QRectF, expected);
+
+    QCOMPARE(detail::makeRectangle(start, current), expected);
+}
+
+void GeometryKernelsTest::makeSquareTakesShorterSide_data() {
+    QTest::addColumn<QPointF>("current");
+    QTest::addColumn<QRectF>("expected");
+
+    QTest::newRow("wide down right") << QPointF{140, 120} << QRectF{100, 100, 20, 20};
+    QTest::newRow("tall down right") << QPointF{120, 140} << QRectF{100, 100, 20, 20};
+    QTest::newRow("wide up left") << QPointF{60, 80} << QRectF{80, 80, 20, 20};
+    QTest::newRow("tall down left") << QPointF{80, 140} << QRectF{80, 100, 20, 20};
+    QTest::newRow("wide up right") << QPointF{140, 80} << QRectF{100, 80, 20, 20};
+}
+
+void GeometryKernelsTest::makeSquareTakesShorterSide() {
+    QFETCH(QPointF, current);
+    QFETCH(QRectF, expected);
+
+    QCOMPARE(detail::makeSquare(QPointF{100, 100}, current), expected);
+}
+
+void GeometryKernelsTest::rotationAngleIsInFullTurn_data() {
+    QTest::addColumn<QPointF>("current");
+    QTest::addColumn<qreal>("expected");
+
+    QTest::newRow("none") << QPointF{10, 0} << 0.0;
+    QTest::newRow("quarter") << QPointF{0, 10} << 90.0;
+    QTest::newRow("half") << QPointF{-10, 0} << 180.0;
+    QTest::newRow("three quarters") << QPointF{0, -10} << 270.0;
+}
+
+void GeometryKernelsTest::rotationAngleIsInFullTurn() {
+    QFETCH(QPointF, current);
+    QFETCH(qreal, expected);
+
+    QCOMPARE(detail::calculateRotationAngle(QPointF{0, 0}, QPointF{10, 0}, current), expected);
+}
+
+void GeometryKernelsTest::polygonCenterIsMeanOfPoints() {
+    QGraphicsPolygonItem item{QPolygonF{{QPointF{0, 0}, QPointF{40, 0}, QPointF{40, 20}, QPointF{0, 20}}}};
+    item.setPos(100, 50);
+
+    QCOMPARE(detail::getPolygonCenterRelativeTo<detail::CoordsType::kItemCoords>(&item), QPointF(20, 10));
+    QCOMPARE(detail::getPolygonCenterRelativeTo<detail::CoordsType::kSceneCoords>(&item), QPointF(120, 60));
+}
+
+void GeometryKernelsTest::copiedRectKeepsSceneGeometry() {
+    QGraphicsRectItem item{QRectF{0, 0, 30, 40}};
+    item.setPen(Qt::NoPen);
+    item.setBrush(Qt::red);
+    item.setPos(10, 20);
+    item.setRotation(30);
+
+    std::unique_ptr<QGraphicsRectItem> copy{detail::copyGraphicsItem(&item)};
+
+    QVERIFY(copy != nullptr);
+    QCOMPARE(copy->rect(), QRectF(10, 20, 30, 40));
+    QCOMPARE(copy->rotation(), 30.0);
+    QCOMPARE(item.rotation(), 30.0);
+    QCOMPARE(copy->pen(), item.pen());
+    QCOMPARE(copy->brush(), item.brush());
+}
+
+void GeometryKernelsTest::copiedPolygonKeepsSceneGeometry() {
+    QPolygonF polygon{{QPointF{0, 0}, QPointF{40, 0}, QPointF{20, 30}}};
+    QGraphicsPolygonItem item{polygon};
+    item.setPos(5, 5);
+
+    std::unique_ptr<QGraphicsPolygonItem> copy{detail::copyGraphicsItem(&item)};
+
+    QVERIFY(copy != nullptr);
+    QCOMPARE(copy->polygon(), polygon.translated(5, 5));
+    QCOMPARE(copy->rotation(), 0.0);
+}
+
+QTEST_MAIN(GeometryKernelsTest)
+#include "geometry-kernels-test.moc"
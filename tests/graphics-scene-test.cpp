@@ -0,0 +1,88 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsRectItem>
+#include <QtTest>
+#include "../include/graphics-scene.h"
+#include "../include/layer-item.h"
+
+namespace {
+    constexpr qsizetype kLayerItemsCount{5};
+    // Enough moves between the same neighbours to exhaust the precision of the keys between them.
+    constexpr int kRepeatedMovesCount{200};
+
+    QList<QGraphicsItem*> addItems(ApplicationGraphicsScene& scene, LayerItem* layer, qsizetype count) {
+        QList<QGraphicsItem*> items;
+        for (qsizetype i = 0; i < count; ++i) {
+            items.push_back(new QGraphicsRectItem{0, 0, 10, 10});
+        }
+        scene.addItemsToLayer(layer, items);
+        return items;
+    }
+}  // namespace
+
+class GraphicsSceneTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void restackKeepsRelativeOrder_data();
+    void restackKeepsRelativeOrder();
+    void repeatedRestackRenumbersLayer();
+};
+
+void GraphicsSceneTest::restackKeepsRelativeOrder_data() {
+    QTest::addColumn<QList<int>>("restacked");
+    QTest::addColumn<int>("move");
+    QTest::addColumn<QList<int>>("expected");
+
+    auto toFront = static_cast<int>(StackingMove::kToFront);
+    auto toBack = static_cast<int>(StackingMove::kToBack);
+    auto forward = static_cast<int>(StackingMove::kForward);
+    auto backward = static_cast<int>(StackingMove::kBackward);
+    QTest::newRow("to front") << QList<int>{1, 3} << toFront << QList<int>{0, 2, 4, 1, 3};
+    QTest::newRow("to back") << QList<int>{1, 3} << toBack << QList<int>{1, 3, 0, 2, 4};
+    QTest::newRow("forward") << QList<int>{1} << forward << QList<int>{0, 2, 1, 3, 4};
+    QTest::newRow("forward run") << QList<int>{1, 2} << forward << QList<int>{0, 3, 1, 2, 4};
+    QTest::newRow("forward separate") << QList<int>{1, 3} << forward << QList<int>{0, 2, 1, 4, 3};
+    QTest::newRow("forward topmost") << QList<int>{4} << forward << QList<int>{0, 1, 2, 3, 4};
+    QTest::newRow("backward") << QList<int>{3} << backward << QList<int>{0, 1, 3, 2, 4};
+    QTest::newRow("backward run") << QList<int>{2, 3} << backward << QList<int>{0, 2, 3, 1, 4};
+    QTest::newRow("backward bottommost") << QList<int>{0} << backward << QList<int>{0, 1, 2, 3, 4};
+}
+
+void GraphicsSceneTest::restackKeepsRelativeOrder() {
+    QFETCH(QList<int>, restacked);
+    QFETCH(int, move);
+    QFETCH(QList<int>, expected);
+
+    ApplicationGraphicsScene scene;
+    auto* layer = scene.addLayer(QStringLiteral("Layer"));
+    QList<QGraphicsItem*> items = addItems(scene, layer, kLayerItemsCount);
+
+    QList<QGraphicsItem*> restackedItems;
+    for (int index : restacked) {
+        restackedItems.push_back(items[index]);
+    }
+    scene.restackItems(restackedItems, static_cast<StackingMove>(move));
+
+    QList<QGraphicsItem*> expectedItems;
+    for (int index : expected) {
+        expectedItems.push_back(items[index]);
+    }
+    QVERIFY(layer->childItems() == expectedItems);
+}
+
+void GraphicsSceneTest::repeatedRestackRenumbersLayer() {
+    ApplicationGraphicsScene scene;
+    auto* layer = scene.addLayer(QStringLiteral("Layer"));
+    QList<QGraphicsItem*> expectedItems = addItems(scene, layer, 3);
+
+    // Moving the bottom item forward puts it halfway between the other two, closer to the top one every time.
+    for (int i = 0; i < kRepeatedMovesCount; ++i) {
+        scene.restackItems({expectedItems.front()}, StackingMove::kForward);
+        expectedItems.swapItemsAt(0, 1);
+        QVERIFY2(layer->childItems() == expectedItems, qPrintable(QStringLiteral("move %1").arg(i)));
+    }
+}
+
+QTEST_MAIN(GraphicsSceneTest)
+#include "graphics-scene-test.moc"
@@ -0,0 +1,76 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QGraphicsRectItem>
+#include <QtTest>
+#include "../include/item-grid.h"
+
+namespace {
+    constexpr qreal kCellSize{100.0};
+
+    QList<QGraphicsItem*> findItems(const ItemGrid& grid, const QRectF& rect) {
+        QList<QGraphicsItem*> items;
+        grid.forEachItem(rect, [&items](QGraphicsItem* item) { items.push_back(item); });
+        return items;
+    }
+}  // namespace
+
+class ItemGridTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void findsItemsOverRect();
+    void visitsItemSpanningCellsOnce();
+    void updateReturnsPreviousBounds();
+    void removedItemIsNotFound();
+};
+
+void ItemGridTest::findsItemsOverRect() {
+    ItemGrid grid{kCellSize};
+    QGraphicsRectItem nearItem{0, 0, 10, 10};
+    QGraphicsRectItem farItem{1000, 1000, 10, 10};
+    QGraphicsRectItem negativeItem{-50, -50, 10, 10};
+    grid.update(&nearItem);
+    grid.update(&farItem);
+    grid.update(&negativeItem);
+
+    QVERIFY(findItems(grid, QRectF{0, 0, 50, 50}) == QList<QGraphicsItem*>{&nearItem});
+    QVERIFY(findItems(grid, QRectF{-60, -60, 20, 20}) == QList<QGraphicsItem*>{&negativeItem});
+    // The item is in the cell of the rect, but does not intersect it.
+    QVERIFY(findItems(grid, QRectF{20, 20, 10, 10}).isEmpty());
+}
+
+void ItemGridTest::visitsItemSpanningCellsOnce() {
+    ItemGrid grid{kCellSize};
+    QGraphicsRectItem wideItem{0, 0, 450, 250};
+    grid.update(&wideItem);
+
+    QVERIFY(findItems(grid, QRectF{-10, -10, 500, 500}) == QList<QGraphicsItem*>{&wideItem});
+    QVERIFY(findItems(grid, QRectF{420, 220, 10, 10}) == QList<QGraphicsItem*>{&wideItem});
+}
+
+void ItemGridTest::updateReturnsPreviousBounds() {
+    ItemGrid grid{kCellSize};
+    QGraphicsRectItem item{0, 0, 10, 10};
+    QVERIFY(grid.update(&item).isEmpty());
+
+    QRectF previousBounds = item.sceneBoundingRect();
+    item.moveBy(500, 0);
+    QCOMPARE(grid.update(&item), previousBounds);
+    QCOMPARE(grid.bounds(&item), item.sceneBoundingRect());
+    QVERIFY(findItems(grid, previousBounds).isEmpty());
+    QVERIFY(findItems(grid, item.sceneBoundingRect()) == QList<QGraphicsItem*>{&item});
+}
+
+void ItemGridTest::removedItemIsNotFound() {
+    ItemGrid grid{kCellSize};
+    QGraphicsRectItem item{0, 0, 10, 10};
+    grid.update(&item);
+
+    QCOMPARE(grid.remove(&item), item.sceneBoundingRect());
+    QVERIFY(!grid.contains(&item));
+    QVERIFY(findItems(grid, item.sceneBoundingRect()).isEmpty());
+    QVERIFY(grid.remove(&item).isEmpty());
+}
+
+QTEST_MAIN(ItemGridTest)
+#include "item-grid-test.moc"
@@ -0,0 +1,94 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QtTest>
+#include <vector>
+#include "../include/lasso-detail.h"
+
+namespace {
+    // Offsets of the grid points from integer coordinates, no grid point lies on an edge of the test polygons.
+    constexpr float kGridOffsetX{0.3F};
+    constexpr float kGridOffsetY{0.7F};
+    constexpr int kGridSize{100};
+}  // namespace
+
+class LassoDetailTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void pointsInPolygonAreEvenOdd_data();
+    void pointsInPolygonAreEvenOdd();
+    void degeneratePolygonEnclosesNothing();
+    void gridMatchesPolygonContainment();
+};
+
+void LassoDetailTest::pointsInPolygonAreEvenOdd_data() {
+    QTest::addColumn<QPolygonF>("polygon");
+    QTest::addColumn<QPointF>("point");
+    QTest::addColumn<bool>("isInside");
+
+    QPolygonF square{QPointF{0, 0}, QPointF{10, 0}, QPointF{10, 10}, QPointF{0, 10}};
+    QTest::newRow("square center") << square << QPointF{5, 5} << true;
+    QTest::newRow("square right") << square << QPointF{15, 5} << false;
+    QTest::newRow("square left") << square << QPointF{-1, 5} << false;
+    QTest::newRow("square below") << square << QPointF{5, 11} << false;
+
+    // A U-shaped polygon with a notch between its arms.
+    QPolygonF concave{QPointF{0, 0}, QPointF{30, 0}, QPointF{30, 30}, QPointF{20, 30},
+                      QPointF{20, 10}, QPointF{10, 10}, QPointF{10, 30}, QPointF{0, 30}};
+    QTest::newRow("concave left arm") << concave << QPointF{5, 20} << true;
+    QTest::newRow("concave notch") << concave << QPointF{15, 20} << false;
+    QTest::newRow("concave right arm") << concave << QPointF{25, 20} << true;
+    QTest::newRow("concave base") << concave << QPointF{15, 5} << true;
+
+    // A self-intersecting lasso encloses its loops only.
+    QPolygonF bowtie{QPointF{0, 0}, QPointF{20, 20}, QPointF{20, 0}, QPointF{0, 20}};
+    QTest::newRow("bowtie left") << bowtie << QPointF{3, 10} << true;
+    QTest::newRow("bowtie top") << bowtie << QPointF{10, 3} << false;
+}
+
+void LassoDetailTest::pointsInPolygonAreEvenOdd() {
+    QFETCH(QPolygonF, polygon);
+    QFETCH(QPointF, point);
+    QFETCH(bool, isInside);
+
+    auto x = static_cast<float>(point.x());
+    auto y = static_cast<float>(point.y());
+    std::uint8_t result = 2;
+    detail::testPointsInPolygon(&x, &y, 1, polygon, &result);
+    QCOMPARE(int{result}, isInside ? 1 : 0);
+}
+
+void LassoDetailTest::degeneratePolygonEnclosesNothing() {
+    std::vector<float> xs{0.0F, 5.0F, 10.0F};
+    std::vector<float> ys{0.0F, 5.0F, 10.0F};
+    std::vector<std::uint8_t> isInside(xs.size(), 1);
+    QPolygonF segment{QPointF{0, 0}, QPointF{10, 10}};
+    detail::testPointsInPolygon(xs.data(), ys.data(), xs.size(), segment, isInside.data());
+    QVERIFY(isInside == (std::vector<std::uint8_t>{0, 0, 0}));
+}
+
+void LassoDetailTest::gridMatchesPolygonContainment() {
+    // Enough points for the vectorized loop and its remainder, checked against the scalar containment of Qt.
+    QPolygonF polygon{QPointF{10, 10}, QPointF{90, 20}, QPointF{50, 50}, QPointF{80, 90}, QPointF{20, 80}};
+    std::vector<float> xs;
+    std::vector<float> ys;
+    for (int y = 0; y < kGridSize; ++y) {
+        for (int x = 0; x < kGridSize; ++x) {
+            xs.push_back(static_cast<float>(x) + kGridOffsetX);
+            ys.push_back(static_cast<float>(y) + kGridOffsetY);
+        }
+    }
+    xs.push_back(kGridOffsetX);
+    ys.push_back(kGridOffsetY);
+
+    std::vector<std::uint8_t> isInside(xs.size());
+    detail::testPointsInPolygon(xs.data(), ys.data(), xs.size(), polygon, isInside.data());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        bool isExpectedInside = polygon.containsPoint(QPointF{xs[i], ys[i]}, Qt::OddEvenFill);
+        QVERIFY2((isInside[i] != 0) == isExpectedInside,
+                 qPrintable(QStringLiteral("point %1, %2").arg(xs[i]).arg(ys[i])));
+    }
+}
+
+QTEST_MAIN(LassoDetailTest)
+#include "lasso-detail-test.moc"
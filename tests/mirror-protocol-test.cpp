@@ -0,0 +1,185 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QDataStream>
+#include <QtEndian>
+#include <QtTest>
+#include <algorithm>
+#include <limits>
+#include "../include/mirror-protocol.h"
+#include "../include/graphics-scene.h"
+
+namespace {
+    // The length prefix of a message and the code of its only operation.
+    constexpr qsizetype kMessageOverhead{sizeof(quint32) + sizeof(quint8)};
+
+    std::optional<QList<MirrorOperation>> roundTrip(MirrorEncoder& encoder, MirrorDecoder& decoder,
+                                                    const QList<MirrorOperation>& operations) {
+        decoder.append(encoder.encode(operations));
+        return decoder.takeMessage();
+    }
+}  // namespace
+
+class MirrorProtocolTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void idsSurviveVarUIntCoding_data();
+    void idsSurviveVarUIntCoding();
+    void smallGapsTakeOneByte();
+    void repeatedMoveOmitsIds();
+    void emptyMoveIsNotRepeatedMove();
+    void messageIsDecodedOnceComplete();
+    void restackSurvivesCoding();
+    void unknownStackingMoveInvalidatesDecoder();
+    void unknownOperationInvalidatesDecoder();
+    void truncatedVarUIntInvalidatesDecoder();
+};
+
+void MirrorProtocolTest::idsSurviveVarUIntCoding_data() {
+    QTest::addColumn<QList<quint64>>("ids");
+
+    constexpr quint64 kMaxId{std::numeric_limits<quint64>::max()};
+    QTest::newRow("zero") << QList<quint64>{0};
+    QTest::newRow("one byte limit") << QList<quint64>{127};
+    QTest::newRow("two bytes") << QList<quint64>{128, 16383};
+    QTest::newRow("three bytes") << QList<quint64>{16384};
+    QTest::newRow("wide gaps") << QList<quint64>{1, quint64{1} << 35, quint64{1} << 56};
+    QTest::newRow("largest") << QList<quint64>{kMaxId - 1, kMaxId};
+    QTest::newRow("unsorted") << QList<quint64>{300, 5, 70000};
+}
+
+void MirrorProtocolTest::idsSurviveVarUIntCoding() {
+    QFETCH(QList<quint64>, ids);
+
+    MirrorEncoder encoder;
+    MirrorDecoder decoder;
+    auto operations = roundTrip(encoder, decoder, {DeleteItemsOperation{ids}});
+    QVERIFY(operations.has_value());
+    QCOMPARE(operations->size(), qsizetype{1});
+    const auto* deletion = std::get_if<DeleteItemsOperation>(&operations->front());
+    QVERIFY(deletion != nullptr);
+
+    // Ids are sent sorted.
+    std::sort(ids.begin(), ids.end());
+    QCOMPARE(deletion->ids, ids);
+    QVERIFY(decoder.isValid());
+}
+
+void MirrorProtocolTest::smallGapsTakeOneByte() {
+    QList<quint64> ids;
+    for (quint64 id = 1000; id < 1100; ++id) {
+        ids.push_back(id);
+    }
+
+    MirrorEncoder encoder;
+    QByteArray message = encoder.encode({DeleteItemsOperation{ids}});
+    // The count and every gap but the first one take a byte each, the first gap of 1000 takes two.
+    QCOMPARE(message.size(), kMessageOverhead + 1 + 2 + (ids.size() - 1));
+}
+
+void MirrorProtocolTest::repeatedMoveOmitsIds() {
+    QList<quint64> ids{3, 7, 11, 4000};
+    MirrorEncoder encoder;
+    MirrorDecoder decoder;
+
+    QByteArray firstMessage = encoder.encode({MoveItemsOperation{ids, QPointF{1, 2}}});
+    QByteArray secondMessage = encoder.encode({MoveItemsOperation{ids, QPointF{3, 4}}});
+    QVERIFY(secondMessage.size() < firstMessage.size());
+
+    decoder.append(firstMessage);
+    decoder.append(secondMessage);
+    for (const auto& delta : {QPointF{1, 2}, QPointF{3, 4}}) {
+        auto operations = decoder.takeMessage();
+        QVERIFY(operations.has_value());
+        const auto* move = std::get_if<MoveItemsOperation>(&operations->front());
+        QVERIFY(move != nullptr);
+        QCOMPARE(move->ids, ids);
+        QCOMPARE(move->delta, delta);
+    }
+}
+
+void MirrorProtocolTest::emptyMoveIsNotRepeatedMove() {
+    MirrorEncoder encoder;
+    MirrorDecoder decoder;
+    QList<quint64> ids{3, 7};
+
+    auto operations = roundTrip(encoder, decoder, {MoveItemsOperation{ids, QPointF{1, 2}},
+                                                   MoveItemsOperation{{}, QPointF{3, 4}},
+                                                   MoveItemsOperation{ids, QPointF{5, 6}}});
+    QVERIFY(operations.has_value());
+    QCOMPARE(operations->size(), qsizetype{3});
+    const QList<QList<quint64>> expectedIds{ids, {}, ids};
+    for (qsizetype i = 0; i < operations->size(); ++i) {
+        const auto* move = std::get_if<MoveItemsOperation>(&operations->at(i));
+        QVERIFY(move != nullptr);
+        QCOMPARE(move->ids, expectedIds[i]);
+    }
+}
+
+void MirrorProtocolTest::messageIsDecodedOnceComplete() {
+    MirrorEncoder encoder;
+    MirrorDecoder decoder;
+    QByteArray message = encoder.encode({DeleteItemsOperation{{1, 2, 3}}, DeleteItemsOperation{{200}}});
+
+    for (qsizetype i = 0; i + 1 < message.size(); ++i) {
+        decoder.append(message.mid(i, 1));
+        QVERIFY(!decoder.takeMessage().has_value());
+        QVERIFY(decoder.isValid());
+    }
+    decoder.append(message.right(1));
+    auto operations = decoder.takeMessage();
+    QVERIFY(operations.has_value());
+    QCOMPARE(operations->size(), qsizetype{2});
+    QVERIFY(!decoder.takeMessage().has_value());
+}
+
+void MirrorProtocolTest::restackSurvivesCoding() {
+    MirrorEncoder encoder;
+    MirrorDecoder decoder;
+    QList<quint64> ids{2, 9, 130};
+    auto operations = roundTrip(encoder, decoder, {RestackItemsOperation{ids, StackingMove::kBackward}});
+    QVERIFY(operations.has_value());
+    const auto* restack = std::get_if<RestackItemsOperation>(&operations->front());
+    QVERIFY(restack != nullptr);
+    QCOMPARE(restack->ids, ids);
+    QVERIFY(restack->move == StackingMove::kBackward);
+}
+
+void MirrorProtocolTest::unknownStackingMoveInvalidatesDecoder() {
+    MirrorEncoder encoder;
+    QByteArray message = encoder.encode({RestackItemsOperation{{1}, StackingMove::kToFront}});
+    // The move is the last byte of the message.
+    message.back() = static_cast<char>(0x7f);
+
+    MirrorDecoder decoder;
+    decoder.append(message);
+    QVERIFY(!decoder.takeMessage().has_value());
+    QVERIFY(!decoder.isValid());
+}
+
+void MirrorProtocolTest::unknownOperationInvalidatesDecoder() {
+    QByteArray message;
+    QDataStream stream{&message, QIODevice::WriteOnly};
+    stream << quint32{1} << quint8{0xff};
+
+    MirrorDecoder decoder;
+    decoder.append(message);
+    QVERIFY(!decoder.takeMessage().has_value());
+    QVERIFY(!decoder.isValid());
+}
+
+void MirrorProtocolTest::truncatedVarUIntInvalidatesDecoder() {
+    MirrorEncoder encoder;
+    QByteArray message = encoder.encode({DeleteItemsOperation{{quint64{1} << 40}}});
+    // Drop the last byte of the id, keeping the length prefix consistent with the payload.
+    message.chop(1);
+    qToBigEndian(static_cast<quint32>(message.size() - sizeof(quint32)), message.data());
+
+    MirrorDecoder decoder;
+    decoder.append(message);
+    QVERIFY(!decoder.takeMessage().has_value());
+    QVERIFY(!decoder.isValid());
+}
+
+QTEST_MAIN(MirrorProtocolTest)
+#include "mirror-protocol-test.moc"
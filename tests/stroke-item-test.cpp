@@ -0,0 +1,84 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QPainterPath>
+#include <QtTest>
+#include <cmath>
+#include "../include/stroke-item.h"
+
+namespace {
+    // Half of the 1/16 pixel step of the fixed point coordinates.
+    constexpr qreal kMaxRoundingError{1.0 / 32.0};
+    constexpr qsizetype kStrokePointsCount{1000};
+    // Mouse samples of a quick stroke.
+    constexpr qreal kSampleDistance{3.0};
+    constexpr qsizetype kMaxBytesPerPoint{4};
+
+    QPolygonF makeStroke() {
+        QPolygonF points;
+        QPointF point{-200.3, 150.7};
+        for (qsizetype i = 0; i < kStrokePointsCount; ++i) {
+            points.push_back(point);
+            auto angle = static_cast<qreal>(i) * 0.37;
+            point += QPointF{std::cos(angle), std::sin(angle * 0.5)} * kSampleDistance;
+        }
+        return points;
+    }
+
+    // The path the brush built for a stroke before StrokeItem, a move and a line per segment.
+    QPainterPath makeSegmentsPath(const QPolygonF& points) {
+        QPainterPath path;
+        path.moveTo(points.front());
+        for (qsizetype i = 1; i < points.size(); ++i) {
+            path.moveTo(points[i - 1]);
+            path.lineTo(points[i]);
+        }
+        return path;
+    }
+}  // namespace
+
+class StrokeItemTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void pointsSurviveEncoding_data();
+    void pointsSurviveEncoding();
+    void encodingIsSmallerThanPath();
+};
+
+void StrokeItemTest::pointsSurviveEncoding_data() {
+    QTest::addColumn<QPolygonF>("points");
+
+    QTest::newRow("empty") << QPolygonF{};
+    QTest::newRow("single point") << QPolygonF{QPointF{12.5, -7.25}};
+    QTest::newRow("far jumps") << QPolygonF{QPointF{0, 0}, QPointF{100000, -100000}, QPointF{-3.1, 2.9}};
+    QTest::newRow("quick stroke") << makeStroke();
+}
+
+void StrokeItemTest::pointsSurviveEncoding() {
+    QFETCH(QPolygonF, points);
+
+    StrokeItem item{points};
+    QCOMPARE(item.pointsCount(), points.size());
+    QPolygonF decoded = item.points();
+    QCOMPARE(decoded.size(), points.size());
+    for (qsizetype i = 0; i < points.size(); ++i) {
+        QVERIFY(std::abs(decoded[i].x() - points[i].x()) <= kMaxRoundingError);
+        QVERIFY(std::abs(decoded[i].y() - points[i].y()) <= kMaxRoundingError);
+    }
+}
+
+void StrokeItemTest::encodingIsSmallerThanPath() {
+    QPolygonF points = makeStroke();
+    StrokeItem item{points};
+    QPainterPath path = makeSegmentsPath(points);
+
+    auto pathSize = static_cast<qsizetype>(path.elementCount() * sizeof(QPainterPath::Element));
+    QVERIFY(item.encodedSize() <= points.size() * kMaxBytesPerPoint);
+    QVERIFY(item.encodedSize() <= StrokeItem::estimateEncodedSize(points.size()));
+    // At least 12 times smaller than the path, which takes 48 bytes per segment.
+    QVERIFY2(item.encodedSize() * 12 <= pathSize,
+             qPrintable(QStringLiteral("%1 bytes encoded, %2 bytes of path").arg(item.encodedSize()).arg(pathSize)));
+}
+
+QTEST_MAIN(StrokeItemTest)
+#include "stroke-item-test.moc"
@@ -0,0 +1,84 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QBuffer>
+#include <QGraphicsRectItem>
+#include <QtTest>
+#include "../include/document-file.h"
+#include "../include/style-registry.h"
+
+namespace {
+    QPen makePen() {
+        return QPen{Qt::blue, 3.0, Qt::DashLine, Qt::FlatCap, Qt::MiterJoin};
+    }
+
+    // QPen::operator== ignores the dash offset of the predefined dash styles, which still changes their painting.
+    bool isSamePen(const QPen& first, const QPen& second) {
+        return first == second && first.dashOffset() == second.dashOffset();
+    }
+
+    ItemSnapshot makeItem(const QPen& pen) {
+        ItemSnapshot item;
+        item.type = QGraphicsRectItem::Type;
+        item.geometry = QRectF{0, 0, 40, 20};
+        item.pen = pen;
+        return item;
+    }
+}  // namespace
+
+class StyleRegistryTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void distinctPensAreKept_data();
+    void distinctPensAreKept();
+    void equalPensAreShared();
+};
+
+void StyleRegistryTest::distinctPensAreKept_data() {
+    QTest::addColumn<QPen>("pen");
+
+    QPen cosmeticPen = makePen();
+    cosmeticPen.setCosmetic(true);
+    QPen miterLimitPen = makePen();
+    miterLimitPen.setMiterLimit(8.0);
+    QPen dashOffsetPen = makePen();
+    dashOffsetPen.setDashOffset(2.5);
+    QTest::newRow("cosmetic") << cosmeticPen;
+    QTest::newRow("miter limit") << miterLimitPen;
+    QTest::newRow("dash offset") << dashOffsetPen;
+}
+
+void StyleRegistryTest::distinctPensAreKept() {
+    QFETCH(QPen, pen);
+    QVERIFY(!isSamePen(pen, makePen()));
+
+    QPen basePen = StyleRegistry::instance().pen(makePen());
+    QVERIFY(isSamePen(StyleRegistry::instance().pen(pen), pen));
+    QVERIFY(isSamePen(StyleRegistry::instance().pen(makePen()), basePen));
+
+    // The style table of a document must not merge the pens either.
+    DocumentSnapshot document;
+    document.layers.push_back(LayerSnapshot{});
+    document.layers.front().items = {makeItem(makePen()), makeItem(pen)};
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QVERIFY(detail::writeDocument(&buffer, document));
+    buffer.seek(0);
+    auto loadedDocument = detail::readDocument(&buffer);
+    QVERIFY(loadedDocument.has_value());
+    const auto& items = loadedDocument->layers.front().items;
+    QCOMPARE(items.size(), qsizetype{2});
+    QVERIFY(isSamePen(items[0].pen, makePen()));
+    QVERIFY(isSamePen(items[1].pen, pen));
+}
+
+void StyleRegistryTest::equalPensAreShared() {
+    QPen firstPen = StyleRegistry::instance().pen(makePen());
+    QPen secondPen = StyleRegistry::instance().pen(makePen());
+    QCOMPARE(firstPen, secondPen);
+    // Both are references to the pen kept by the registry.
+    QVERIFY(!firstPen.isDetached());
+}
+
+QTEST_MAIN(StyleRegistryTest)
+#include "style-registry-test.moc"
@@ -0,0 +1,85 @@
+// @copyright Copyright (c) 2023 by Konstantin Belousov
+
+#include <QImage>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <memory>
+#include "../include/tiled-image-item.h"
+
+namespace {
+    // Halved three times until it fits a tile, so the file has the levels 0 to 3.
+    constexpr QSize kImageSize{8 * TiledImageFile::kTileSize, 4 * TiledImageFile::kTileSize};
+    constexpr int kLevelsCount{4};
+    const QRectF kCanvasRect{0, 0, 512, 512};
+}  // namespace
+
+class TiledImageItemTest : public QObject {
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void fittedImageCoversCanvas();
+    void zoomedOutPaintUsesReducedLevel_data();
+    void zoomedOutPaintUsesReducedLevel();
+
+ private:
+    std::unique_ptr<TiledImageItem> makeItem() const;
+
+    QTemporaryDir directory_;
+    QString cachePath_;
+};
+
+void TiledImageItemTest::initTestCase() {
+    QVERIFY(directory_.isValid());
+    QImage image{kImageSize, QImage::Format_ARGB32};
+    image.fill(Qt::darkGreen);
+    QString imagePath = directory_.filePath(QStringLiteral("scan.png"));
+    QVERIFY(image.save(imagePath));
+    cachePath_ = directory_.filePath(QStringLiteral("scan.tiles"));
+    QVERIFY(TiledImageFile::build(imagePath, cachePath_));
+}
+
+std::unique_ptr<TiledImageItem> TiledImageItemTest::makeItem() const {
+    auto file = std::make_unique<TiledImageFile>();
+    if (!file->open(cachePath_)) return nullptr;
+    return std::make_unique<TiledImageItem>(std::move(file));
+}
+
+void TiledImageItemTest::fittedImageCoversCanvas() {
+    auto item = makeItem();
+    QVERIFY(item != nullptr);
+    item->fitInto(kCanvasRect);
+
+    QRectF sceneBounds = item->sceneBoundingRect();
+    QCOMPARE(sceneBounds.width(), kCanvasRect.width());
+    QVERIFY(kCanvasRect.contains(sceneBounds));
+}
+
+void TiledImageItemTest::zoomedOutPaintUsesReducedLevel_data() {
+    QTest::addColumn<bool>("isFitted");
+    QTest::addColumn<qreal>("viewScale");
+    QTest::addColumn<int>("level");
+
+    // The fitted item is scaled by 1/4.
+    QTest::newRow("not fitted") << false << 1.0 << 0;
+    QTest::newRow("fitted") << true << 1.0 << 2;
+    QTest::newRow("fitted, zoomed in") << true << 4.0 << 0;
+    QTest::newRow("fitted, zoomed out") << true << 0.25 << kLevelsCount - 1;
+}
+
+void TiledImageItemTest::zoomedOutPaintUsesReducedLevel() {
+    QFETCH(bool, isFitted);
+    QFETCH(qreal, viewScale);
+    QFETCH(int, level);
+
+    auto item = makeItem();
+    QVERIFY(item != nullptr);
+    if (isFitted) item->fitInto(kCanvasRect);
+
+    // The world transform of the painter while a view paints the item.
+    QTransform worldTransform = item->sceneTransform() * QTransform::fromScale(viewScale, viewScale);
+    QCOMPARE(item->levelFor(worldTransform), level);
+}
+
+QTEST_MAIN(TiledImageItemTest)
+#include "tiled-image-item-test.moc"